@@ -0,0 +1,193 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PUBLIC_TEXTRA_FLAT_LAYOUT_RESULT_H_
+#define PUBLIC_TEXTRA_FLAT_LAYOUT_RESULT_H_
+
+#include <textra/i_canvas_helper.h>
+#include <textra/macro.h>
+#include <textra/painter.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+class LayoutDrawerListener;
+class LayoutRegion;
+/**
+ * @brief Compact, immutable snapshot of what a LayoutRegion draws.
+ *
+ * The result is a handful of flat arrays: one record per line, a list of
+ * canvas operations using the CanvasOp opcodes, the glyph ids and positions of
+ * every glyph run, a deduplicated paint table and a string pool. It keeps no
+ * pointer to the paragraphs, runs or lines it was made from, so the paragraph
+ * can be released once the result is created.
+ *
+ * All methods are const, a result can be drawn from several threads at the
+ * same time. Serialize() turns it into a versioned little-endian byte buffer
+ * that can be stored or placed in shared memory and read back in another
+ * process with Deserialize().
+ *
+ * It is also the display list recorded by RecordingCanvasHelper, such a
+ * recording has ops but no line records unless it comes from Create().
+ *
+ * Glyph runs refer to their typeface by ITypefaceHelper::GetUniqueId(). A
+ * result created in process keeps the typefaces alive and resolves the ids
+ * itself, a deserialized one needs a TypefaceResolver.
+ */
+class L_EXPORT FlatLayoutResult {
+ public:
+  static constexpr uint32_t kNoPaint = 0xFFFFFFFF;
+  struct Line {
+    float top_;
+    float height_;
+    float baseline_;
+    float left_;
+    float right_;
+    uint32_t start_char_;
+    uint32_t end_char_;
+    // ops drawing this line are [op_start_, op_end_)
+    uint32_t op_start_;
+    uint32_t op_end_;
+  };
+  struct Shadow {
+    uint32_t color_;
+    float offset_x_;
+    float offset_y_;
+    float blur_radius_;
+  };
+  struct Paint {
+    uint32_t color_;
+    float stroke_width_;
+    float stroke_miter_;
+    float text_size_;
+    // font family is string_pool_[font_family_start_, +font_family_length_)
+    uint32_t font_family_start_;
+    uint32_t font_family_length_;
+    // shadows are shadows_[shadow_start_, +shadow_count_)
+    uint32_t shadow_start_;
+    uint32_t shadow_count_;
+    FillStyle fill_style_;
+    Cap cap_;
+    Join join_;
+    bool bold_;
+    bool italic_;
+    bool under_line_;
+  };
+  /**
+   * @brief One canvas call. The meaning of the fields depends on op_:
+   * - kTranslate, kScale, kSkew: values_[0, 2)
+   * - kRotate: values_[0] degrees
+   * - kClipRect: values_ ltrb, flags_ anti alias
+   * - kFillRect: values_ ltrb, flags_ color, no paint
+   * - kDrawLine: values_ x1 y1 x2 y2
+   * - kDrawRect, kDrawOval: values_ ltrb
+   * - kDrawCircle: values_ x y radius
+   * - kDrawRoundRect: values_ ltrb radius
+   * - kDrawGlyphs: values_ origin, typeface_id_, glyphs and positions in
+   *   [data_start_, +data_count_), flags_ the text_bytes argument
+   * - kDrawText: values_ x y, typeface_id_, text in the string pool
+   * - kDrawImage: values_ ltrb, src in the string pool
+   */
+  struct Op {
+    CanvasOp op_;
+    uint32_t paint_idx_;
+    float values_[5];
+    uint32_t typeface_id_;
+    uint32_t data_start_;
+    uint32_t data_count_;
+    uint32_t flags_;
+  };
+  using TypefaceResolver =
+      std::function<const ITypefaceHelper*(uint32_t typeface_id)>;
+
+ public:
+  FlatLayoutResult();
+  ~FlatLayoutResult();
+
+ public:
+  /**
+   * @brief Captures the drawing of every line of a region through
+   * LayoutDrawer. Lines of a virtualized region are materialized one by one.
+   * @param listener resolves theme colors, LayoutDrawer's default if nullptr
+   */
+  static std::unique_ptr<FlatLayoutResult> Create(
+      LayoutRegion* region, LayoutDrawerListener* listener = nullptr);
+  /**
+   * @return nullptr if data is not a buffer produced by Serialize()
+   */
+  static std::unique_ptr<FlatLayoutResult> Deserialize(const uint8_t* data,
+                                                       size_t size);
+  std::string Serialize() const;
+
+ public:
+  /**
+   * @brief Replays all the recorded ops onto canvas.
+   * @param resolver maps typeface ids, the typefaces kept by Create() are used
+   * if it is empty
+   */
+  void Draw(ICanvasHelper* canvas,
+            const TypefaceResolver& resolver = nullptr) const;
+  /**
+   * @brief Replays the lines [start_line, end_line).
+   */
+  void DrawLines(ICanvasHelper* canvas, uint32_t start_line, uint32_t end_line,
+                 const TypefaceResolver& resolver = nullptr) const;
+
+ public:
+  float GetWidth() const { return width_; }
+  float GetHeight() const { return height_; }
+  uint32_t GetLineCount() const { return static_cast<uint32_t>(lines_.size()); }
+  const Line& GetLine(uint32_t idx) const { return lines_[idx]; }
+  const std::vector<Op>& GetOps() const { return ops_; }
+  const std::vector<Paint>& GetPaints() const { return paints_; }
+  const std::vector<uint16_t>& GetGlyphs() const { return glyphs_; }
+  const std::vector<float>& GetPositionsX() const { return pos_x_; }
+  const std::vector<float>& GetPositionsY() const { return pos_y_; }
+  const std::string& GetStringPool() const { return string_pool_; }
+  std::string GetString(uint32_t start, uint32_t length) const {
+    return string_pool_.substr(start, length);
+  }
+  /**
+   * @brief Typeface of a glyph run, only known for results made by Create().
+   */
+  const ITypefaceHelper* GetTypeface(uint32_t typeface_id) const;
+  /**
+   * @brief Number of ops the recorder could not store, the result does not
+   * draw like the recorded canvas calls when it is not 0. Not serialized.
+   */
+  uint32_t GetDroppedOpCount() const { return dropped_op_count_; }
+
+ private:
+  friend class RecordingCanvasHelper;
+  bool IsValid() const;
+  // painters of a replay, created on first use per paint index
+  using PainterList = std::vector<std::unique_ptr<Painter>>;
+  void ApplyPaint(uint32_t paint_idx, Painter* painter) const;
+  void DrawOp(ICanvasHelper* canvas, const Op& op,
+              const TypefaceResolver& resolver, PainterList* painters) const;
+
+ private:
+  float width_ = 0;
+  float height_ = 0;
+  std::vector<Line> lines_;
+  std::vector<Op> ops_;
+  std::vector<Paint> paints_;
+  std::vector<Shadow> shadows_;
+  std::vector<uint16_t> glyphs_;
+  std::vector<float> pos_x_;
+  std::vector<float> pos_y_;
+  std::string string_pool_;
+  std::unordered_map<uint32_t, std::shared_ptr<const ITypefaceHelper>>
+      typefaces_;
+  uint32_t dropped_op_count_ = 0;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // PUBLIC_TEXTRA_FLAT_LAYOUT_RESULT_H_
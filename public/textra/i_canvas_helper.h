@@ -54,6 +54,32 @@ enum class CanvasOp : uint8_t {
   kDrawRoundRect,
 };
 
+/**
+ * @brief Arguments of one ICanvasHelper::DrawGlyphs() call, used to pass all
+ * the glyph runs of a line at once to ICanvasHelper::DrawGlyphRuns().
+ */
+struct GlyphRun {
+  const ITypefaceHelper* font_;
+  const uint16_t* glyphs_;
+  uint32_t glyph_count_;
+  // text_bytes argument of DrawGlyphs(), LayoutDrawer passes 1 for rtl runs
+  uint32_t text_bytes_;
+  float origin_x_;
+  float origin_y_;
+  float* x_;
+  float* y_;
+  Painter* painter_;
+};
+
+/**
+ * @brief Backend objects built for a list of glyph runs, e.g. text blobs. See
+ * ICanvasHelper::PrepareGlyphRuns().
+ */
+class PreparedGlyphRuns {
+ public:
+  virtual ~PreparedGlyphRuns() = default;
+};
+
 /**
  * @brief An abstract canvas interface that defines the methods required to
  * render text and graphics.
@@ -113,6 +139,37 @@ class ICanvasHelper {
                           const char* text, uint32_t text_bytes, float origin_x,
                           float origin_y, float* x, float* y,
                           Painter* painter) = 0;
+  /**
+   * @brief Draws the glyph runs of a line in one call. Runs sharing a painter
+   * object paint the same, so consecutive ones can be drawn as a single text
+   * blob. The default implementation calls DrawGlyphs() for every run.
+   */
+  virtual void DrawGlyphRuns(const GlyphRun* runs, uint32_t run_count) {
+    for (auto k = 0u; k < run_count; k++) {
+      const auto& run = runs[k];
+      DrawGlyphs(run.font_, run.glyph_count_, run.glyphs_, nullptr,
+                 run.text_bytes_, run.origin_x_, run.origin_y_, run.x_, run.y_,
+                 run.painter_);
+    }
+  }
+  /**
+   * @brief Builds the backend objects DrawGlyphRuns() would create for runs,
+   * so a caller drawing the same runs again can pass them back to
+   * DrawPreparedGlyphRuns() instead. Only the colors of the painters may
+   * change in between. Returns nullptr if the backend has nothing to keep.
+   */
+  virtual std::unique_ptr<PreparedGlyphRuns> PrepareGlyphRuns(
+      const GlyphRun* runs, uint32_t run_count) {
+    return nullptr;
+  }
+  /**
+   * @brief Draws runs with the objects PrepareGlyphRuns() returned for them,
+   * prepared may be nullptr. The default implementation calls DrawGlyphRuns().
+   */
+  virtual void DrawPreparedGlyphRuns(const PreparedGlyphRuns* prepared,
+                                     const GlyphRun* runs, uint32_t run_count) {
+    DrawGlyphRuns(runs, run_count);
+  }
   virtual void DrawRunDelegate(const RunDelegate* delegate, float left,
                                float top, float right, float bottom,
                                tttext::Painter* painter) = 0;
@@ -0,0 +1,40 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PUBLIC_TEXTRA_I_HYPHENATOR_H_
+#define PUBLIC_TEXTRA_I_HYPHENATOR_H_
+
+#include <cstdint>
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief Provides hyphenation opportunities inside words for one locale.
+ *
+ * A hyphenator is attached to a paragraph through
+ * ParagraphStyle::SetHyphenator(). While formatting, the paragraph hands each
+ * word to the hyphenator and records the returned positions as extra break
+ * opportunities. When a line ends at such a position, a hyphen is drawn at the
+ * end of the line.
+ */
+class IHyphenator {
+ public:
+  virtual ~IHyphenator() = default;
+
+ public:
+  /**
+   * @brief Computes the hyphenation points of a single word.
+   *
+   * @param word UTF-32 code points of the word, without surrounding spaces
+   * @param length number of code points in word
+   * @param breaks output array of length entries, set breaks[k] to true when
+   * the word may be broken before word[k]. All entries are false on input.
+   */
+  virtual void Hyphenate(const char32_t* word, uint32_t length,
+                         bool* breaks) const = 0;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+
+#endif  // PUBLIC_TEXTRA_I_HYPHENATOR_H_
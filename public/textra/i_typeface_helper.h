@@ -7,16 +7,28 @@
 
 #include <textra/font_info.h>
 
+#include <atomic>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace ttoffice {
 namespace tttext {
 using GlyphID = uint16_t;
 using Unichar = uint32_t;
 
+/**
+ * @brief Advance and ink bounds of a glyph at one font size.
+ */
+struct GlyphMetrics {
+  float advance_ = 0;
+  // ink bounds relative to the glyph origin, [left, top, right, bottom]
+  float bounds_[4] = {0, 0, 0, 0};
+};
+
 // An abstraction for platform fonts, allowing Minikin to be used with
 // multiple actual implementations of fonts.
 class ITypefaceHelper : public std::enable_shared_from_this<ITypefaceHelper> {
@@ -43,21 +55,79 @@ class ITypefaceHelper : public std::enable_shared_from_this<ITypefaceHelper> {
   // Returns index within OpenType collection
   virtual int GetFontIndex() const = 0;
 
+  // Override if font tables can be read while the font is not in memory as a
+  // whole. Copies up to length bytes of the table from offset into data and
+  // returns the number of bytes copied, or the size of the table if data is
+  // nullptr. Returns 0 if the table does not exist.
+  virtual size_t GetTableData(uint32_t tag, size_t offset, size_t length,
+                              void* data) const {
+    return 0;
+  }
+
   virtual uint16_t UnicharToGlyph(Unichar codepoint,
                                   uint32_t variationSelector = 0) const = 0;
 
   virtual void UnicharsToGlyphs(const Unichar* unichars, uint32_t count,
                                 GlyphID* glyphs) const = 0;
 
+  /**
+   * @brief Metrics of the typeface at font_size, created once per size.
+   *
+   * The first kFontInfoSlotCount sizes are kept in a fixed table whose slots
+   * are filled under font_info_cache_lock_ and published with a release
+   * store, so looking up a cached size takes no lock. Later sizes fall back to
+   * font_info_cache_ under the lock. The returned reference stays valid for
+   * the lifetime of the typeface.
+   */
   const FontInfo& GetFontInfo(float font_size) {
-    std::lock_guard<std::mutex> guard(font_info_cache_lock_);
-    auto iter = font_info_cache_.find(font_size);
-    if (iter != font_info_cache_.end()) {
-      return iter->second;
+    const auto key = FontSizeKey(font_size);
+    for (auto k = 0u; k < kFontInfoSlotCount; k++) {
+      const auto& slot = font_info_slots_[FontInfoSlotIndex(key, k)];
+      const auto slot_key = slot.key_.load(std::memory_order_acquire);
+      if (slot_key == kEmptyFontSizeKey) break;
+      if (slot_key == key) return slot.info_;
+    }
+    return CreateFontInfo(font_size, key);
+  }
+
+  /**
+   * @brief Fills the metrics of glyphs at font_size.
+   *
+   * Metrics are cached per font size and glyph id and shared by layout and
+   * drawing, for the kGlyphMetricsSizeCount most recently used sizes. The
+   * advances of the glyphs not cached yet are fetched in one
+   * GetHorizontalAdvances() call, their ink bounds with GetWidthBound().
+   */
+  void GetGlyphMetrics(const GlyphID* glyphs, uint32_t count, float font_size,
+                       GlyphMetrics* metrics) const {
+    std::lock_guard<std::mutex> guard(glyph_metrics_cache_lock_);
+    auto& cache = GetGlyphMetricsTable(font_size);
+    missing_glyphs_.clear();
+    for (auto k = 0u; k < count; k++) {
+      if (cache.find(glyphs[k]) == cache.end()) {
+        missing_glyphs_.push_back(glyphs[k]);
+      }
+    }
+    if (!missing_glyphs_.empty()) {
+      const auto missing_count = static_cast<uint32_t>(missing_glyphs_.size());
+      missing_advances_.resize(missing_count);
+      GetHorizontalAdvances(missing_glyphs_.data(), missing_count,
+                            missing_advances_.data(), font_size);
+      for (auto k = 0u; k < missing_count; k++) {
+        GlyphMetrics glyph_metrics;
+        glyph_metrics.advance_ = missing_advances_[k];
+        float rect_ltwh[4] = {0, 0, 0, 0};
+        GetWidthBound(rect_ltwh, missing_glyphs_[k], font_size);
+        glyph_metrics.bounds_[0] = rect_ltwh[0];
+        glyph_metrics.bounds_[1] = rect_ltwh[1];
+        glyph_metrics.bounds_[2] = rect_ltwh[0] + rect_ltwh[2];
+        glyph_metrics.bounds_[3] = rect_ltwh[1] + rect_ltwh[3];
+        cache.emplace(missing_glyphs_[k], glyph_metrics);
+      }
+    }
+    for (auto k = 0u; k < count; k++) {
+      metrics[k] = cache.find(glyphs[k])->second;
     }
-    auto& info = font_info_cache_[font_size];
-    OnCreateFontInfo(&info, font_size);
-    return info;
   }
 
   virtual uint32_t GetUnitsPerEm() const = 0;
@@ -74,6 +144,89 @@ class ITypefaceHelper : public std::enable_shared_from_this<ITypefaceHelper> {
   std::unordered_map<float, FontInfo> font_info_cache_;
   std::string font_name_;
   std::mutex font_info_cache_lock_;
+
+ private:
+  static constexpr uint32_t kFontInfoSlotBits = 5;
+  static constexpr uint32_t kFontInfoSlotCount = 1u << kFontInfoSlotBits;
+  static constexpr uint32_t kEmptyFontSizeKey = 0xFFFFFFFF;
+  struct FontInfoSlot {
+    // bits of the font size, kEmptyFontSizeKey until info_ is written
+    std::atomic<uint32_t> key_{kEmptyFontSizeKey};
+    FontInfo info_;
+  };
+  static uint32_t FontSizeKey(float font_size) {
+    // -0 and 0 share a key, as they do in font_info_cache_
+    if (font_size == 0) return 0;
+    uint32_t key;
+    std::memcpy(&key, &font_size, sizeof(key));
+    return key;
+  }
+  static uint32_t FontInfoSlotIndex(uint32_t key, uint32_t probe) {
+    // the low mantissa bits of common sizes are zero, hash into the high bits
+    const auto hash = (key * 2654435761u) >> (32 - kFontInfoSlotBits);
+    return (hash + probe) & (kFontInfoSlotCount - 1);
+  }
+  // sizes whose glyph metrics are kept, animated sizes would grow the cache
+  // without a bound otherwise
+  static constexpr uint32_t kGlyphMetricsSizeCount = 8;
+  struct GlyphMetricsTable {
+    float font_size_;
+    uint64_t last_use_;
+    std::unordered_map<GlyphID, GlyphMetrics> metrics_;
+  };
+  // called under glyph_metrics_cache_lock_, the least recently used table is
+  // reused for a new size once all are taken
+  std::unordered_map<GlyphID, GlyphMetrics>& GetGlyphMetricsTable(
+      float font_size) const {
+    GlyphMetricsTable* least_used = nullptr;
+    for (auto& table : glyph_metrics_cache_) {
+      if (table.font_size_ == font_size) {
+        table.last_use_ = ++glyph_metrics_use_count_;
+        return table.metrics_;
+      }
+      if (least_used == nullptr || table.last_use_ < least_used->last_use_) {
+        least_used = &table;
+      }
+    }
+    if (glyph_metrics_cache_.size() < kGlyphMetricsSizeCount) {
+      glyph_metrics_cache_.push_back({font_size, ++glyph_metrics_use_count_});
+      return glyph_metrics_cache_.back().metrics_;
+    }
+    least_used->font_size_ = font_size;
+    least_used->last_use_ = ++glyph_metrics_use_count_;
+    least_used->metrics_.clear();
+    return least_used->metrics_;
+  }
+  const FontInfo& CreateFontInfo(float font_size, uint32_t key) {
+    std::lock_guard<std::mutex> guard(font_info_cache_lock_);
+    if (key != kEmptyFontSizeKey) {
+      for (auto k = 0u; k < kFontInfoSlotCount; k++) {
+        auto& slot = font_info_slots_[FontInfoSlotIndex(key, k)];
+        const auto slot_key = slot.key_.load(std::memory_order_relaxed);
+        if (slot_key == key) return slot.info_;
+        if (slot_key == kEmptyFontSizeKey) {
+          OnCreateFontInfo(&slot.info_, font_size);
+          slot.key_.store(key, std::memory_order_release);
+          return slot.info_;
+        }
+      }
+    }
+    auto iter = font_info_cache_.find(font_size);
+    if (iter != font_info_cache_.end()) {
+      return iter->second;
+    }
+    auto& info = font_info_cache_[font_size];
+    OnCreateFontInfo(&info, font_size);
+    return info;
+  }
+
+  FontInfoSlot font_info_slots_[kFontInfoSlotCount];
+  mutable std::vector<GlyphMetricsTable> glyph_metrics_cache_;
+  mutable uint64_t glyph_metrics_use_count_ = 0;
+  // glyphs of the current GetGlyphMetrics() call missing in the cache
+  mutable std::vector<GlyphID> missing_glyphs_;
+  mutable std::vector<float> missing_advances_;
+  mutable std::mutex glyph_metrics_cache_lock_;
 };
 }  // namespace tttext
 }  // namespace ttoffice
@@ -120,6 +120,7 @@ enum class WordBreakType : uint8_t {
   kKeepAll,
 };
 enum class OverflowWrap : uint8_t { kNormal, kAnywhere, kBreakWord };
+enum class LineBreakMode : uint8_t { kGreedy, kOptimal };
 enum class RunType : uint8_t {
   kTextRun = 0,
   kGhostRun = 1,
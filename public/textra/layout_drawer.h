@@ -5,6 +5,7 @@
 #ifndef PUBLIC_TEXTRA_LAYOUT_DRAWER_H_
 #define PUBLIC_TEXTRA_LAYOUT_DRAWER_H_
 
+#include <textra/i_canvas_helper.h>
 #include <textra/i_typeface_helper.h>
 #include <textra/layout_drawer_listener.h>
 #include <textra/layout_page_listener.h>
@@ -14,6 +15,8 @@
 #include <textra/tt_color.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace ttoffice {
 namespace tttext {
@@ -27,6 +30,8 @@ class Border;
 class TextAttachment;
 class BaseRun;
 class PointF;
+class FlatLayoutResult;
+struct LineGlyphCache;
 using DrawerPiece = RunRange;
 enum class RadiusDirection : uint8_t;
 enum class ParagraphVerticalAlignment : uint8_t;
@@ -66,6 +71,31 @@ class L_EXPORT LayoutDrawer {
    */
   void DrawLayoutPage(LayoutRegion* layout_page);
 
+  /**
+   * @brief Renders the lines of a LayoutRegion crossing [top, bottom).
+   *
+   * Only the visible lines of a virtualized region are laid out again.
+   *
+   * @param layout_page The layout region to render.
+   * @param top Top of the visible range in region coordinates.
+   * @param bottom Bottom of the visible range in region coordinates.
+   */
+  void DrawLayoutPage(LayoutRegion* layout_page, float top, float bottom);
+
+  /**
+   * @brief Renders the part of a LayoutRegion inside a clip rectangle.
+   *
+   * The first visible line is found by a binary search on the line positions
+   * and the lines below the clip are not visited. In a visible line only the
+   * drawer pieces crossing the clip are drawn, together with the backgrounds
+   * and decorations of their chars. Cursor blinks, selection changes and
+   * scrolling only pay for the damaged area.
+   *
+   * @param layout_page The layout region to render.
+   * @param clip_rect_ltrb The damaged area in region coordinates.
+   */
+  void DrawLayoutPage(LayoutRegion* layout_page, const float clip_rect_ltrb[4]);
+
   /**
    * @brief Renders a specific character range within a text line to the backing
    * canvas.
@@ -79,7 +109,43 @@ class L_EXPORT LayoutDrawer {
 
   void SetListener(LayoutDrawerListener* listener);
 
+  /**
+   * @brief Controls whether DrawLayoutPage() replays a display list cached on
+   * the region.
+   *
+   * Value: When true, the first DrawLayoutPage() of a region records its
+   * lines with a RecordingCanvasHelper and stores the display list on the
+   * region, the following draws replay it without looking up styles again.
+   * The display list is recorded again when a drawer with another listener
+   * draws the region. Virtualized regions, regions with run delegates and
+   * regions whose drawing the recorder can't store are always drawn directly.
+   * Default is false.
+   */
+  void SetUseDisplayList(bool use_display_list) {
+    use_display_list_ = use_display_list;
+  }
+
+  /**
+   * @brief Controls whether the glyph runs of a line are kept on the line
+   * between frames.
+   *
+   * Value: When true, DrawTextLine() of a whole line stores the glyph runs it
+   * drew together with the backend objects ICanvasHelper::PrepareGlyphRuns()
+   * made for them, and the next draw of the line by the same drawer hands them
+   * back through ICanvasHelper::DrawPreparedGlyphRuns() without walking the
+   * runs again. Foreground colors are looked up on every draw, other style
+   * changes need a relayout. Lines drawn with a foreground painter or an
+   * inline object are not cached. A line must not be drawn by two drawers at
+   * the same time while this is on. Default is false.
+   */
+  void SetCacheGlyphRuns(bool cache_glyph_runs) {
+    cache_glyph_runs_ = cache_glyph_runs;
+  }
+
  private:
+  bool GetCharRangeInClip(TextLine* i_line, float left, float right,
+                          uint32_t* char_start_in_line,
+                          uint32_t* char_end_in_line) const;
   void DrawLineBackground(TextLine* i_line, uint32_t char_start_in_para,
                           uint32_t char_end_in_para);
   void DrawLineDecoration(TextLine* i_line, uint32_t char_start_in_para,
@@ -90,10 +156,27 @@ class L_EXPORT LayoutDrawer {
   float DrawTextRun(const BaseRun* run, uint32_t start_char_in_run,
                     uint32_t end_char_in_run, float x, float y, float* pos_x,
                     float* pos_y, float* background_rect) const;
+  static uint32_t GlyphOffsetInRange(const BaseRun* run, uint32_t range_start,
+                                     uint32_t range_end, uint32_t sub_start,
+                                     uint32_t sub_end);
   void DrawGlyphsOrText(const BaseRun* run, uint16_t* glyphs,
                         uint32_t glyph_count, uint32_t glyph_start_index,
                         const ITypefaceHelper* font, float ox, float oy,
-                        float* pos_x, float* pos_y, Painter* p) const;
+                        float* pos_x, float* pos_y, Painter* p,
+                        bool batch) const;
+  void AddGlyphRun(const ITypefaceHelper* font, const uint16_t* glyphs,
+                   uint32_t glyph_count, uint32_t text_bytes, float ox,
+                   float oy, const float* pos_x, const float* pos_y,
+                   float last_advance, const Painter& painter) const;
+  void FlushGlyphRuns() const;
+  void ClearGlyphRuns() const;
+  void CacheGlyphRuns(TextLine* i_line) const;
+  bool DrawCachedGlyphRuns(TextLine* i_line) const;
+  void DrawGlyphCache(const LineGlyphCache& cache) const;
+  const FlatLayoutResult* EnsureDisplayList(LayoutRegion* layout_page);
+  class PooledPainter;
+  Painter* AcquirePainter() const;
+  void ReleasePainter() const;
   uint32_t TTColorToPlainColor(ThemeCategory theme, const TTColor& tt_color) {
     return listener_->FetchThemeColor(theme, tt_color);
   }
@@ -101,6 +184,46 @@ class L_EXPORT LayoutDrawer {
  private:
   ICanvasHelper* canvas_;
   LayoutDrawerListener* listener_;
+  // identifies the glyph caches this drawer made, the canvas is fixed for the
+  // lifetime of the drawer
+  const uint64_t drawer_id_;
+  bool use_display_list_ = false;
+  bool cache_glyph_runs_ = false;
+  // Scratch buffers and painters reused across pieces, lines and frames, they
+  // only grow so a steady redraw does not allocate.
+  mutable std::vector<float> pos_x_buffer_;
+  mutable std::vector<float> pos_y_buffer_;
+  mutable std::vector<uint16_t> glyph_buffer_;
+  mutable std::vector<const ITypefaceHelper*> font_buffer_;
+  mutable std::vector<std::unique_ptr<Painter>> painter_pool_;
+  mutable uint32_t painter_pool_used_ = 0;
+  // Glyph runs of the current line waiting for FlushGlyphRuns(), glyphs and
+  // positions are offsets into the batch buffers.
+  struct PendingGlyphRun {
+    const ITypefaceHelper* font_;
+    uint32_t glyph_start_;
+    uint32_t glyph_count_;
+    uint32_t text_bytes_;
+    float origin_x_;
+    float origin_y_;
+    uint32_t painter_idx_;
+    // where the glyph following the run would be drawn
+    float end_x_;
+  };
+  mutable std::vector<PendingGlyphRun> pending_runs_;
+  mutable std::vector<uint16_t> batch_glyphs_;
+  mutable std::vector<float> batch_pos_x_;
+  mutable std::vector<float> batch_pos_y_;
+  mutable std::vector<std::unique_ptr<Painter>> batch_painters_;
+  mutable uint32_t batch_painter_count_ = 0;
+  mutable std::vector<GlyphRun> glyph_runs_;
+  // The line being drawn goes to its glyph cache, cleared by any flush before
+  // the end of the line. Pending painters are colored by the foreground color
+  // of the chars in pending_color_sources_, {painter index, char position}.
+  mutable bool caching_line_ = false;
+  mutable uint32_t color_source_char_ = 0;
+  mutable std::vector<std::pair<uint32_t, uint32_t>> pending_color_sources_;
+  mutable std::vector<uint8_t> color_updated_;
 };
 }  // namespace tttext
 }  // namespace ttoffice
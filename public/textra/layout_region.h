@@ -10,21 +10,30 @@
 #include <textra/text_line.h>
 #include <textra/tttext_context.h>
 
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
+#include <set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace ttoffice {
 namespace tttext {
+class FlatLayoutResult;
 class FontInfo;
 class LineRange;
 class ParagraphImpl;
 class TextLine;
 class LayoutDrawer;
+class LayoutDrawerListener;
 class TextLayout;
 // class BlockRegion;
 class AttributesRangeList;
 class LayoutRegionDistribute;
+class ExclusionSpace;
 enum class ParagraphHorizontalAlignment : uint8_t;
 enum class LayoutMode : uint8_t;
 
@@ -56,13 +65,63 @@ class L_EXPORT LayoutRegion {
   virtual ~LayoutRegion();
 
  public:
+  /**
+   * @brief Returns the x ranges available for a line occupying the band
+   * [*top, *top + range_height), split around the excluded rectangles.
+   * @param top in: top of the band, out: the next y where the ranges can get
+   * wider, a blocked line can be moved there directly
+   */
   virtual std::vector<std::array<float, 2>> GetRangeList(float* top,
                                                          float range_height,
                                                          float start_indent,
                                                          float end_indent);
+  /**
+   * @brief Whether growing a line band [top, top + height) to new_height may
+   * change the ranges returned by GetRangeList(). Layout skips querying the
+   * ranges again when it returns false, so a region overriding GetRangeList()
+   * should override it as well.
+   */
+  virtual bool RangeListMayChange(float top, float height,
+                                  float new_height) const;
+  /**
+   * @brief Places a floating object at the given position and excludes its
+   * rectangle from the text flow of the following lines. Called by layout
+   * when it reaches a float run.
+   * @return whether the float was placed, false if it already was, e.g. when
+   * its line is laid out again
+   */
   virtual std::pair<LayoutResult, bool> ProcessFloatObject(
       const TTTextContext& context, const BaseRun& run, int char_x,
       float line_y);
+  /**
+   * @brief Excludes a rectangle from the text flow. Lines crossing it are
+   * split around it, and a line which does not fit next to it is moved below
+   * it. The rectangle is kept by Reset().
+   */
+  void AddExclusionRect(float left, float top, float width, float height);
+  /**
+   * @brief Drops the layout result so that the region can be laid out again:
+   * the lines, including the ones returned by GetLine(), the display list and
+   * the floats placed by layout. Rectangles added by AddExclusionRect() are
+   * kept.
+   */
+  void Reset();
+  /**
+   * @brief Controls whether the region keeps its lines virtualized.
+   *
+   * Value: Max number of TextLine objects kept alive. When non-zero, the
+   * region only keeps a compact record per line after layout, and lines are
+   * laid out again on demand by VisitLines() and LayoutDrawer, the least
+   * recently used ones are released beyond the limit. Walk a virtualized
+   * region with VisitLines(), see GetLine() for how long the lines it returns
+   * live. Must be set before layout. Default is 0, all lines are kept.
+   */
+  void SetMaxMaterializedLines(uint32_t max_lines) {
+    TTASSERT(GetLineCount() == 0);
+    max_materialized_lines_ = max_lines;
+  }
+  uint32_t GetMaxMaterializedLines() const { return max_materialized_lines_; }
+  bool IsVirtualized() const { return max_materialized_lines_ > 0; }
 
  public:
   LayoutMode GetWidthMode() const { return width_mode_; }
@@ -76,14 +135,31 @@ class L_EXPORT LayoutRegion {
   float GetLayoutedHeight() const { return layouted_bottom_; }
 
   uint32_t GetLineCount() const {
-    return static_cast<uint32_t>(line_lst_.size());
+    return static_cast<uint32_t>(IsVirtualized() ? line_records_.size()
+                                                 : line_lst_.size());
   }
   void SetLinePitch(float pitch) { line_pitch_ = pitch; }
   float GetLinePitch() const { return line_pitch_; }
-  TextLine* GetLine(uint32_t idx) const {
-    if (idx >= line_lst_.size()) return nullptr;
-    return line_lst_[idx].get();
-  }
+  /**
+   * @brief The line at idx, valid until the region is reset or destroyed. A
+   * line of a virtualized region is laid out again if needed and goes to the
+   * cache of materialized lines, it stays valid until
+   * GetMaxMaterializedLines() other lines have been accessed since.
+   */
+  TextLine* GetLine(uint32_t idx) const;
+  using LineVisitor = std::function<bool(uint32_t idx, TextLine* line)>;
+  /**
+   * @brief Calls visit on the lines in [start, end) in order until it returns
+   * false. The line is only valid during its visit: a line of a virtualized
+   * region is laid out again if needed, kept alive while visit runs whatever
+   * lines it accesses, and may be released once visit returns.
+   */
+  void VisitLines(uint32_t start, uint32_t end, const LineVisitor& visit) const;
+  /**
+   * @brief Index of the first line whose bottom is below y, GetLineCount() if
+   * there is none. Virtualized lines are not laid out again.
+   */
+  uint32_t FindLineIndexByY(float y) const;
   void SetFullFilled(bool full) { full_filled_ = full; }
   bool IsFullFilled() const { return full_filled_; }
   bool IsEmpty() const { return GetLineCount() == 0; }
@@ -92,6 +168,47 @@ class L_EXPORT LayoutRegion {
     exceeded_max_lines_ = exceeded_max_lines;
   }
   bool DidExceedMaxLines() const { return exceeded_max_lines_; }
+  /**
+   * @brief Display list recorded by a LayoutDrawer with display list caching
+   * enabled, nullptr until the region is drawn that way. Adding a line drops
+   * it, call InvalidateDisplayList() after changing a line returned by
+   * GetLine() or the theme colors of the drawer's listener.
+   */
+  std::shared_ptr<const FlatLayoutResult> GetDisplayList() const {
+    return display_list_;
+  }
+  void InvalidateDisplayList() {
+    display_list_ = nullptr;
+    display_list_listener_ = nullptr;
+    display_list_unrecordable_ = false;
+  }
+
+ private:
+  void AddExclusion(float left, float top, float width, float height);
+  /**
+   * @brief Everything needed to lay out a virtualized line again.
+   */
+  struct LineRecord {
+    uint32_t paragraph_idx_;
+    uint32_t run_idx_;
+    uint32_t char_idx_;
+    float top_;
+    float height_;
+    float baseline_;
+  };
+  using MaterializedLineList =
+      std::list<std::pair<uint32_t, std::unique_ptr<TextLine>>>;
+  std::unique_ptr<TextLine> MaterializeLine(uint32_t idx) const;
+  // moves the line out of the cache, laying it out again if it is not there
+  std::unique_ptr<TextLine> TakeMaterializedLine(uint32_t idx) const;
+  void CacheMaterializedLine(uint32_t idx,
+                             std::unique_ptr<TextLine> line) const;
+  // Index of the line being laid out, differs from GetLineCount() while a
+  // virtualized line is laid out again.
+  uint32_t GetLayoutLineIndex() const {
+    return materializing_line_idx_ < GetLineCount() ? materializing_line_idx_
+                                                    : GetLineCount();
+  }
 
  protected:
   std::vector<Paragraph*> paragraph_list_;
@@ -110,6 +227,32 @@ class L_EXPORT LayoutRegion {
   float layouted_width_;
   float layouted_bottom_;
   LayoutPageListener* listener_;
+  std::unique_ptr<ExclusionSpace> exclusion_space_;
+  // left, top, width and height of the rects added by AddExclusionRect()
+  std::vector<std::array<float, 4>> exclusion_rects_;
+  // paragraph and char position of the float runs placed so far
+  std::set<std::pair<const Paragraph*, uint32_t>> placed_floats_;
+  // virtualized lines
+  uint32_t max_materialized_lines_ = 0;
+  std::vector<LineRecord> line_records_;
+  // line index and line, most recently used first
+  mutable MaterializedLineList materialized_lines_;
+  mutable std::unordered_map<uint32_t, MaterializedLineList::iterator>
+      materialized_line_map_;
+  mutable uint32_t materializing_line_idx_ = UINT32_MAX;
+  // lines being visited by VisitLines(), out of the cache, innermost last
+  mutable std::vector<std::pair<uint32_t, TextLine*>> visiting_lines_;
+  // configurations of the layout context, replayed by MaterializeLine()
+  TTTextContext line_context_;
+  // the last line was stripped by ellipsis when the region got full
+  bool last_line_stripped_ = false;
+  std::shared_ptr<const FlatLayoutResult> display_list_;
+  // resolved the theme colors of display_list_, or found the region
+  // unrecordable
+  const LayoutDrawerListener* display_list_listener_ = nullptr;
+  // the region has run delegates or ops the recorder can't capture, it is
+  // drawn directly until the display list is invalidated
+  bool display_list_unrecordable_ = false;
 };
 }  // namespace tttext
 }  // namespace ttoffice
@@ -0,0 +1,103 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PUBLIC_TEXTRA_LAYOUT_REGION_DISTRIBUTE_H_
+#define PUBLIC_TEXTRA_LAYOUT_REGION_DISTRIBUTE_H_
+
+#include <textra/layout_region.h>
+#include <textra/macro.h>
+#include <textra/paginator.h>
+#include <textra/tttext_context.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+class Paragraph;
+class TextLayout;
+/**
+ * @brief A chain of regions, e.g. the columns of a page or linked text boxes,
+ * the paragraphs flow from one region into the next one.
+ *
+ * The start of every region is kept as a PageCheckpoint, so resizing a region
+ * only lays out that region and the ones after it. The regions are recreated
+ * by every layout, pointers returned by GetRegion() are valid until the next
+ * layout.
+ */
+class L_EXPORT LayoutRegionDistribute {
+ public:
+  LayoutRegionDistribute(const TextLayout* layout,
+                         std::vector<Paragraph*> paragraphs);
+  ~LayoutRegionDistribute();
+
+ public:
+  /**
+   * @brief Appends a region to the chain, it is laid out by the next Layout().
+   */
+  void AddRegion(float width, float height);
+  /**
+   * @brief Lays out the paragraphs into the chain.
+   * @return true if all the paragraphs fit into the regions
+   */
+  bool Layout();
+  /**
+   * @brief Changes the size of a region, and lays out again the content from
+   * this region on. The regions before it are kept.
+   * @return true if all the paragraphs fit into the regions
+   */
+  bool ResizeRegion(uint32_t region_idx, float width, float height);
+  /**
+   * @brief Gives all the regions the smallest common height which still lets
+   * the content fit, then lays them out.
+   *
+   * The line heights are measured once at the width of the first region, and
+   * the height is found by a binary search over them, so the content is laid
+   * out only for the final height. All the regions are expected to have the
+   * width of the first one.
+   * @param max_height upper bound of the region height
+   * @return the balanced region height
+   */
+  float BalanceColumns(float max_height);
+
+ public:
+  uint32_t GetRegionCount() const {
+    return static_cast<uint32_t>(region_sizes_.size());
+  }
+  LayoutRegion* GetRegion(uint32_t region_idx) const {
+    return region_idx < regions_.size() ? regions_[region_idx].get() : nullptr;
+  }
+  /**
+   * @brief Whether some content did not fit into the last region.
+   */
+  bool HasOverflow() const { return paginator_.HasNextPage(); }
+  /**
+   * @brief Layout configurations applied to every region.
+   */
+  TTTextContext& GetContext() { return paginator_.GetContext(); }
+
+ private:
+  bool LayoutFrom(uint32_t region_idx);
+  const std::vector<float>& GetLineAdvances(float width);
+  uint32_t CountColumns(float height, float* used_height) const;
+
+ private:
+  const TextLayout* layout_;
+  std::vector<Paragraph*> paragraphs_;
+  Paginator paginator_;
+  std::vector<std::pair<float, float>> region_sizes_;
+  std::vector<std::unique_ptr<LayoutRegion>> regions_;
+  // vertical space taken by each line in a single column, measured at
+  // line_advances_width_ with the context configurations and the layout
+  // revisions of the paragraphs below
+  std::vector<float> line_advances_;
+  float line_advances_width_ = -1;
+  bool line_advances_can_overflow_ = false;
+  bool line_advances_skip_spacing_ = false;
+  std::vector<uint32_t> line_advances_revisions_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // PUBLIC_TEXTRA_LAYOUT_REGION_DISTRIBUTE_H_
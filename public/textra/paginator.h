@@ -0,0 +1,123 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PUBLIC_TEXTRA_PAGINATOR_H_
+#define PUBLIC_TEXTRA_PAGINATOR_H_
+
+#include <textra/layout_region.h>
+#include <textra/macro.h>
+#include <textra/tttext_context.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+class Paragraph;
+class TextLayout;
+/**
+ * @brief Where the layout of a page starts: the paragraph, the position in the
+ * paragraph and the spacing state carried by TTTextContext.
+ *
+ * A checkpoint is a few bytes and can be serialized, so a reader app can store
+ * one per page and lay out any page later without the pages before it.
+ */
+struct L_EXPORT PageCheckpoint {
+  uint32_t paragraph_idx_ = 0;
+  uint32_t run_idx_ = 0;
+  uint32_t char_idx_ = 0;
+  float paragraph_space_ = 0;
+  float line_space_ = 0;
+
+  bool operator==(const PageCheckpoint& other) const;
+  bool operator!=(const PageCheckpoint& other) const {
+    return !(*this == other);
+  }
+  /**
+   * @brief Encodes the checkpoint into a versioned little-endian byte string.
+   */
+  std::string Serialize() const;
+  /**
+   * @return false if data is not a checkpoint produced by Serialize()
+   */
+  static bool Deserialize(const std::string& data, PageCheckpoint* checkpoint);
+};
+
+/**
+ * @brief Lays out a list of paragraphs one page at a time.
+ *
+ * Every call to NextPage() returns a new LayoutRegion owned by the caller, the
+ * paginator itself only keeps the TTTextContext and one checkpoint per page
+ * laid out so far. Dropping the returned pages keeps the memory bounded no
+ * matter how long the document is. The paragraphs are not owned and must
+ * outlive the paginator and the pages.
+ */
+class L_EXPORT Paginator {
+ public:
+  Paginator(const TextLayout* layout, std::vector<Paragraph*> paragraphs,
+            float page_width, float page_height);
+  ~Paginator();
+
+ public:
+  bool HasNextPage() const;
+  /**
+   * @brief Lays out the page at the current checkpoint and moves past it.
+   * @return nullptr at the end of the document
+   */
+  std::unique_ptr<LayoutRegion> NextPage();
+  /**
+   * @brief Random access to a page. Resumes from the checkpoint of page_idx
+   * if it is known, otherwise lays out forward from the last known page.
+   * @return nullptr if the document has less pages
+   */
+  std::unique_ptr<LayoutRegion> LayoutPage(uint32_t page_idx);
+  /**
+   * @brief Continues from a checkpoint stored earlier, the next page gets
+   * page_idx. Checkpoints after page_idx are forgotten.
+   */
+  void SeekTo(const PageCheckpoint& checkpoint, uint32_t page_idx);
+  /**
+   * @brief Size of the pages laid out by the following calls of NextPage().
+   */
+  void SetPageSize(float page_width, float page_height) {
+    page_width_ = page_width;
+    page_height_ = page_height;
+  }
+  /**
+   * @brief Checkpoint where the next page starts.
+   */
+  const PageCheckpoint& GetCheckpoint() const { return checkpoint_; }
+  /**
+   * @brief Index of the page returned by the next call of NextPage().
+   */
+  uint32_t GetPageIndex() const { return page_idx_; }
+  /**
+   * @brief Checkpoints of the pages laid out so far, indexed by page.
+   */
+  const std::vector<PageCheckpoint>& GetPageCheckpoints() const {
+    return page_checkpoints_;
+  }
+  /**
+   * @brief Layout configurations applied to every page.
+   */
+  TTTextContext& GetContext() { return context_; }
+
+ private:
+  void RestoreContext();
+
+ private:
+  const TextLayout* layout_;
+  std::vector<Paragraph*> paragraphs_;
+  float page_width_;
+  float page_height_;
+  TTTextContext context_;
+  PageCheckpoint checkpoint_;
+  uint32_t page_idx_ = 0;
+  std::vector<PageCheckpoint> page_checkpoints_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // PUBLIC_TEXTRA_PAGINATOR_H_
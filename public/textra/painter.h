@@ -67,6 +67,27 @@ class Painter {
   virtual ~Painter() = default;
 
  public:
+  /**
+   * @brief Restores the default attributes, keeping the allocated storage so
+   * a painter can be reused without allocation.
+   */
+  void Reset() {
+    fill_style_ = FillStyle::kFill;
+    stroke_width_ = 0;
+    stroke_miter_ = 0;
+    alpha_ = 0xFF;
+    red_ = 0;
+    green_ = 0;
+    blue_ = 0;
+    font_family_ = "pingfang";
+    text_size_ = 14;
+    bold_ = false;
+    italic_ = false;
+    under_line_ = false;
+    cap_ = Cap::kDefault_Cap;
+    join_ = Join::kDefault_Join;
+    shadow_list_.clear();
+  }
   FillStyle GetFillStyle() const { return fill_style_; }
   void SetFillStyle(FillStyle style) { fill_style_ = style; }
   float GetStrokeWidth() const { return stroke_width_; }
@@ -110,6 +131,31 @@ class Painter {
     uint32_t b = blue_;
     return a | r | g | b;
   }
+  /**
+   * @brief Whether other paints exactly like this painter, platform specific
+   * state of subclasses is not compared.
+   */
+  bool HasSameAttributes(const Painter& other) const {
+    if (fill_style_ != other.fill_style_ ||
+        stroke_width_ != other.stroke_width_ ||
+        stroke_miter_ != other.stroke_miter_ ||
+        GetColor() != other.GetColor() || text_size_ != other.text_size_ ||
+        bold_ != other.bold_ || italic_ != other.italic_ ||
+        under_line_ != other.under_line_ || cap_ != other.cap_ ||
+        join_ != other.join_ || font_family_ != other.font_family_ ||
+        shadow_list_.size() != other.shadow_list_.size()) {
+      return false;
+    }
+    for (size_t k = 0; k < shadow_list_.size(); k++) {
+      const auto& a = shadow_list_[k];
+      const auto& b = other.shadow_list_[k];
+      if (a.color_ != b.color_ || a.offset_[0] != b.offset_[0] ||
+          a.offset_[1] != b.offset_[1] || a.blur_radius_ != b.blur_radius_) {
+        return false;
+      }
+    }
+    return true;
+  }
   void SetShadowList(const std::vector<TextShadow>& list) {
     shadow_list_ = list;
   }
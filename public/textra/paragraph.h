@@ -34,6 +34,16 @@ namespace tttext {
  * and Style (for character-level formatting).
  */
 class L_EXPORT Paragraph {
+ public:
+  /**
+   * @brief A text run in the buffer passed to AddTextRuns().
+   */
+  struct TextSpan {
+    uint32_t offset_;     // in bytes
+    uint32_t length_;     // in bytes
+    uint32_t style_idx_;  // index in the style table
+  };
+
  protected:
   Paragraph() = default;
 
@@ -51,6 +61,24 @@ class L_EXPORT Paragraph {
   virtual void SetParagraphStyle(const ParagraphStyle* style) = 0;
   virtual void AddTextRun(const Style* style, const char* content,
                           uint32_t length) = 0;
+  /**
+   * @brief Adds many text runs at once, e.g. from language bindings.
+   *
+   * Equivalent to one AddTextRun() per span, but the buffer is validated and
+   * appended to the content once and the style ranges are appended without
+   * searching them.
+   *
+   * @param content UTF-8 buffer holding the text of all the spans
+   * @param length length of content in bytes
+   * @param spans sorted by offset and not overlapping, bytes outside of the
+   * spans are skipped. A span which does not start and end on a character
+   * boundary or refers to a missing style is skipped.
+   * @param styles style table, nullptr entries use the default style
+   */
+  virtual void AddTextRuns(const char* content, uint32_t length,
+                           const TextSpan* spans, uint32_t span_count,
+                           const Style* const* styles,
+                           uint32_t style_count) = 0;
   virtual void AddShapeRun(const Style* style,
                            std::shared_ptr<RunDelegate> shape,
                            bool is_float) = 0;
@@ -12,10 +12,13 @@
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <string>
+#include <utility>
 
 namespace ttoffice {
 namespace tttext {
 class RunDelegate;
+class IHyphenator;
 struct Indent;
 struct Spacing;
 /**
@@ -545,6 +548,36 @@ class L_EXPORT ParagraphStyle {
     overflow_wrap_ = overflow_wrap;
   }
 
+  /**
+   * @brief Controls how line break positions are chosen.
+   *
+   * Value: LineBreakMode enum.
+   * - kGreedy fills each line with as much content as fits before breaking
+   * - kOptimal chooses the breaks of the whole paragraph together so that the
+   * free space is spread evenly over the lines (Knuth-Plass)
+   * Default is LineBreakMode::kGreedy.
+   *
+   * kOptimal only applies to lines that have a single available range, lines
+   * split by floating objects still break greedily.
+   */
+  LineBreakMode GetLineBreakMode() const { return line_break_mode_; }
+  void SetLineBreakMode(LineBreakMode mode) { line_break_mode_ = mode; }
+
+  /**
+   * @brief Enables automatic hyphenation of words.
+   *
+   * Value: IHyphenator for the language of the paragraph, usually created once
+   * per locale and shared between paragraphs. When set, words may be broken at
+   * the positions returned by the hyphenator and a hyphen is appended to the
+   * broken line. Default is nullptr (no hyphenation).
+   */
+  const std::shared_ptr<IHyphenator>& GetHyphenator() const {
+    return hyphenator_;
+  }
+  void SetHyphenator(std::shared_ptr<IHyphenator> hyphenator) {
+    hyphenator_ = std::move(hyphenator);
+  }
+
   /**
    * @brief Controls whether line breaks are allowed around punctuation marks.
    *
@@ -571,6 +604,8 @@ class L_EXPORT ParagraphStyle {
   bool enable_text_bounds_;
   OverflowWrap overflow_wrap_;
   LineBreakStrategy line_break_strategy_;
+  LineBreakMode line_break_mode_;
+  std::shared_ptr<IHyphenator> hyphenator_;
 
   friend class ParagraphImpl;
 };
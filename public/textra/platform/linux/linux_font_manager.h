@@ -0,0 +1,170 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PUBLIC_TEXTRA_PLATFORM_LINUX_LINUX_FONT_MANAGER_H_
+#define PUBLIC_TEXTRA_PLATFORM_LINUX_LINUX_FONT_MANAGER_H_
+
+#include <textra/font_info.h>
+#include <textra/i_font_manager.h>
+#include <textra/macro.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+struct FontFileRecord;
+/**
+ * @brief A read-only memory mapping of a font file. The faces of a collection
+ * share the mapping of their file.
+ */
+class L_EXPORT FontFileMapping {
+ public:
+  /**
+   * @return nullptr if the file can't be opened or is empty
+   */
+  static std::shared_ptr<FontFileMapping> Map(const std::string& path);
+  ~FontFileMapping();
+  FontFileMapping(const FontFileMapping&) = delete;
+  FontFileMapping& operator=(const FontFileMapping&) = delete;
+
+ public:
+  const uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+
+ private:
+  FontFileMapping(const uint8_t* data, size_t size)
+      : data_(data), size_(size) {}
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+};
+
+/**
+ * @brief IFontManager for Linux and headless servers, answering matches from
+ * an index of font directories instead of a system font service.
+ *
+ * The family names, style and cmap coverage of every face of the ttf, otf,
+ * ttc and otc files found under the font directories are read once and kept
+ * in an index file, files whose size and modification time did not change
+ * are not opened again on the next start. Matching a family, a style or a
+ * fallback character only looks at the index, font files are opened when a
+ * typeface is created for a matched face.
+ *
+ * The manager does not rasterize, typefaces are created by a TypefaceFactory,
+ * usually the makeFromFile() of the renderer's font manager. A factory can
+ * also build the typeface on the shared mapping of MapFontFile().
+ *
+ * All the methods can be called from several threads.
+ */
+class L_EXPORT LinuxFontManager : public IFontManager {
+ public:
+  using TypefaceFactory =
+      std::function<TypefaceRef(const std::string& path, int ttc_index)>;
+
+ public:
+  /**
+   * @param font_dirs directories searched recursively for font files
+   * @param factory creates the typeface of a matched face
+   * @param index_path file keeping the index between runs, the index is
+   * rebuilt on every start if empty
+   */
+  LinuxFontManager(std::vector<std::string> font_dirs, TypefaceFactory factory,
+                   std::string index_path = "");
+  /**
+   * @brief Creates the typefaces with backend->makeFromFile().
+   */
+  LinuxFontManager(std::vector<std::string> font_dirs,
+                   std::shared_ptr<IFontManager> backend,
+                   std::string index_path = "");
+  ~LinuxFontManager() override;
+
+ public:
+  int countFamilies() const override;
+  /**
+   * @param familyName nullptr, "sans-serif", "serif" and "monospace" are
+   * resolved with the generic families
+   */
+  TypefaceRef matchFamilyStyle(const char familyName[],
+                               const FontStyle& style) override;
+  /**
+   * @brief Looks for the character in familyName first, then in the generic
+   * sans-serif families, then in every face of the index. bcp47 is not used,
+   * the index has no language information.
+   */
+  TypefaceRef matchFamilyStyleCharacter(const char familyName[],
+                                        const FontStyle& style,
+                                        const char* bcp47[], int bcp47Count,
+                                        uint32_t character) override;
+  TypefaceRef makeFromFile(const char path[], int ttcIndex) override;
+  TypefaceRef legacyMakeTypeface(const char familyName[],
+                                 FontStyle style) const override;
+
+ public:
+  /**
+   * @brief Replaces the families a generic family name resolves to, the first
+   * family found in the index is used.
+   * @param generic "sans-serif", "serif" or "monospace"
+   */
+  void SetGenericFamilies(const std::string& generic,
+                          std::vector<std::string> families);
+  /**
+   * @brief Scans the font directories again, only the new and changed files
+   * are parsed. Typefaces created before stay valid.
+   */
+  void Rescan();
+  /**
+   * @brief The mapping of a font file, shared while any user keeps it.
+   */
+  std::shared_ptr<FontFileMapping> MapFontFile(const std::string& path);
+  uint32_t GetFaceCount() const;
+
+ private:
+  struct Face {
+    uint32_t file_idx_;
+    uint32_t record_idx_;
+  };
+  void Scan();
+  void BuildLookup();
+  bool LoadIndex(std::vector<FontFileRecord>* files) const;
+  void StoreIndex(const std::vector<FontFileRecord>& files) const;
+  int32_t MatchFamilyLocked(const std::string& family,
+                            const FontStyle& style) const;
+  int32_t MatchGenericLocked(const std::string& generic,
+                             const FontStyle& style) const;
+  int32_t MatchCharacterLocked(const std::vector<uint32_t>& faces,
+                               const FontStyle& style,
+                               uint32_t character) const;
+  int32_t MatchFallbackLocked(const FontStyle& style,
+                              uint32_t character) const;
+  TypefaceRef GetTypefaceLocked(int32_t face_idx) const;
+
+ private:
+  std::vector<std::string> font_dirs_;
+  TypefaceFactory factory_;
+  std::string index_path_;
+  mutable std::mutex lock_;
+  std::vector<FontFileRecord> files_;
+  std::vector<Face> faces_;
+  // lower case family name to faces, in index order
+  std::unordered_map<std::string, std::vector<uint32_t>> family_faces_;
+  std::unordered_map<std::string, std::vector<std::string>> generic_families_;
+  // (character << 32 | style) to the fallback face, -1 if none
+  mutable std::unordered_map<uint64_t, int32_t> fallback_cache_;
+  // keyed by path and ttc index, so that a rescan keeps the typefaces
+  mutable std::unordered_map<std::string, TypefaceRef> typefaces_;
+  // apart from lock_, a factory called under lock_ may map its file
+  std::mutex mapping_lock_;
+  std::unordered_map<std::string, std::weak_ptr<FontFileMapping>> mappings_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // PUBLIC_TEXTRA_PLATFORM_LINUX_LINUX_FONT_MANAGER_H_
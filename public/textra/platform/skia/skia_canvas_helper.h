@@ -12,6 +12,7 @@
 #include <textra/platform/skia/skia_typeface_helper.h>
 
 #include <memory>
+#include <vector>
 
 #include "include/core/SkBlurTypes.h"
 #include "include/core/SkFont.h"
@@ -22,6 +23,11 @@
 
 class SkCanvas;
 class SkPath;
+// one text blob per glyph run
+class SkiaPreparedGlyphRuns : public tttext::PreparedGlyphRuns {
+ public:
+  std::vector<sk_sp<SkTextBlob>> text_blobs_;
+};
 /**
  * @brief A canvas helper implementation backed by the Skia library.
  *
@@ -179,16 +185,52 @@ class L_EXPORT SkiaCanvasHelper : public tttext::ICanvasHelper {
     if (glyph_count == 0) {
       return;
     }
-    auto typeface = reinterpret_cast<const tttext::SkiaTypefaceHelper*>(font);
-    SkFont sk_font(typeface->GetSkTypeface(), painter->GetTextSize(), 1,
-                   painter->IsItalic() ? -0.25 : 0);
+    const tttext::GlyphRun run{font,     glyphs,   glyph_count, text_bytes,
+                               origin_x, origin_y, x,           y,
+                               painter};
+    DrawTextBlob(MakeTextBlob(run), origin_x, origin_y, painter);
+  }
+  std::unique_ptr<tttext::PreparedGlyphRuns> PrepareGlyphRuns(
+      const tttext::GlyphRun* runs, uint32_t run_count) override {
+    auto prepared = std::make_unique<SkiaPreparedGlyphRuns>();
+    for (uint32_t k = 0; k < run_count; k++) {
+      prepared->text_blobs_.push_back(
+          runs[k].glyph_count_ > 0 ? MakeTextBlob(runs[k]) : nullptr);
+    }
+    return prepared;
+  }
+  void DrawPreparedGlyphRuns(const tttext::PreparedGlyphRuns* prepared,
+                             const tttext::GlyphRun* runs,
+                             uint32_t run_count) override {
+    if (prepared == nullptr) {
+      DrawGlyphRuns(runs, run_count);
+      return;
+    }
+    const auto& text_blobs =
+        static_cast<const SkiaPreparedGlyphRuns*>(prepared)->text_blobs_;
+    TTASSERT(text_blobs.size() == run_count);
+    for (uint32_t k = 0; k < run_count; k++) {
+      if (text_blobs[k] == nullptr) continue;
+      DrawTextBlob(text_blobs[k], runs[k].origin_x_, runs[k].origin_y_,
+                   runs[k].painter_);
+    }
+  }
+  static sk_sp<SkTextBlob> MakeTextBlob(const tttext::GlyphRun& run) {
+    auto typeface =
+        reinterpret_cast<const tttext::SkiaTypefaceHelper*>(run.font_);
+    SkFont sk_font(typeface->GetSkTypeface(), run.painter_->GetTextSize(), 1,
+                   run.painter_->IsItalic() ? -0.25 : 0);
     SkTextBlobBuilder builder;
-    auto run_buffer = builder.allocRunPosH(sk_font, glyph_count, 0, nullptr);
-    for (uint32_t k = 0; k < glyph_count; k++) {
-      run_buffer.glyphs[k] = tttext::GlyphID(glyphs[k]);
-      run_buffer.pos[k] = x[k];
+    auto run_buffer =
+        builder.allocRunPosH(sk_font, run.glyph_count_, 0, nullptr);
+    for (uint32_t k = 0; k < run.glyph_count_; k++) {
+      run_buffer.glyphs[k] = tttext::GlyphID(run.glyphs_[k]);
+      run_buffer.pos[k] = run.x_[k];
     }
-    auto blob = builder.make();
+    return builder.make();
+  }
+  void DrawTextBlob(const sk_sp<SkTextBlob>& blob, float origin_x,
+                    float origin_y, tttext::Painter* painter) {
     const auto& shadow_list = painter->GetShadowList();
     if (!shadow_list.empty()) {
       for (auto& shadow : shadow_list) {
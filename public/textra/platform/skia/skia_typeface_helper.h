@@ -65,7 +65,11 @@ class SkiaTypefaceHelper : public ITypefaceHelper {
   size_t GetFontDataSize() const override {
     return asset_ == nullptr ? 0 : asset_->getLength();
   }
-  int GetFontIndex() const override { return 0; }
+  int GetFontIndex() const override { return ttc_index_; }
+  size_t GetTableData(uint32_t tag, size_t offset, size_t length,
+                      void* data) const override {
+    return sk_typeface_->getTableData(tag, offset, length, data);
+  }
   uint16_t UnicharToGlyph(Unichar codepoint,
                           uint32_t variationSelector = 0) const override {
     return sk_typeface_->unicharToGlyph(codepoint);
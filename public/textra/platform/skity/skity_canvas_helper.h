@@ -7,15 +7,22 @@
 
 #include <textra/i_canvas_helper.h>
 #include <textra/painter.h>
+#include <textra/platform/skity/skity_shadow_cache.h>
 #include <textra/platform/skity/skity_typeface_helper.h>
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <skity/effect/mask_filter.hpp>
+#include <skity/graphic/bitmap.hpp>
+#include <skity/graphic/image.hpp>
 #include <skity/graphic/paint.hpp>
 #include <skity/render/canvas.hpp>
 #include <skity/text/font.hpp>
 #include <skity/text/text_blob.hpp>
 #include <skity/text/text_run.hpp>
+#include <string>
+#include <utility>
 #include <vector>
 namespace ttoffice {
 namespace tttext {
@@ -23,12 +30,39 @@ class SkityPainter : public tttext::Painter {
  public:
   std::unique_ptr<skity::Paint> platform_painter_;
 };
+// one text blob per group of consecutive runs sharing a painter
+class SkityPreparedGlyphRuns : public PreparedGlyphRuns {
+ public:
+  std::vector<std::shared_ptr<skity::TextBlob>> text_blobs_;
+};
 /**
  * @brief A canvas helper implementation backed by the Skity library.
+ *
+ * Blurred text shadows are rendered into images once and kept in a
+ * SkityShadowCache. Each helper has its own cache, helpers created per frame
+ * should share one with SetShadowCache().
  */
 class SkityCanvasHelper : public ICanvasHelper {
  public:
-  explicit SkityCanvasHelper(skity::Canvas* canvas) : canvas_(canvas) {}
+  explicit SkityCanvasHelper(skity::Canvas* canvas)
+      : canvas_(canvas), shadow_cache_(std::make_shared<SkityShadowCache>()) {}
+
+ public:
+  /**
+   * @brief Sets the cache of blurred shadows, nullptr blurs every shadow on
+   * every draw.
+   */
+  void SetShadowCache(std::shared_ptr<SkityShadowCache> shadow_cache) {
+    shadow_cache_ = std::move(shadow_cache);
+  }
+  const std::shared_ptr<SkityShadowCache>& GetShadowCache() const {
+    return shadow_cache_;
+  }
+  /**
+   * @brief Pixels per canvas unit of the target, shadow images are rendered at
+   * this resolution. Default is 1.
+   */
+  void SetDeviceScale(float device_scale) { device_scale_ = device_scale; }
 
  public:
   std::unique_ptr<Painter> CreatePainter() override {
@@ -81,42 +115,47 @@ class SkityCanvasHelper : public ICanvasHelper {
                   const uint16_t* glyphs, const char* text, uint32_t text_bytes,
                   float ox, float oy, float* pos_x, float* pos_y,
                   tttext::Painter* painter) override {
-    const auto* typeface =
-        reinterpret_cast<const skity::textlayout::SkityTypefaceHelper*>(font);
-    skity::Paint* paint = ToSkityPaint(painter);
-
-    std::vector<skity::GlyphID> glyph_vector;
-    std::vector<float> p_x;
-    std::vector<float> p_y;
-    for (uint32_t index = 0; index < glyph_count; index++) {
-      glyph_vector.push_back(glyphs[index]);
-      p_x.push_back(pos_x[index]);
-      p_y.push_back(-pos_y[index]);
+    const GlyphRun run{font, glyphs, glyph_count, text_bytes, ox,
+                       oy,   pos_x,  pos_y,       painter};
+    DrawGlyphRuns(&run, 1);
+  }
+  // consecutive runs sharing a painter are drawn as one text blob
+  void DrawGlyphRuns(const GlyphRun* runs, uint32_t run_count) override {
+    uint32_t start = 0;
+    while (start < run_count) {
+      auto end = NextPainterGroup(runs, start, run_count);
+      DrawTextBlob(MakeTextBlob(runs + start, end - start), runs + start,
+                   end - start);
+      start = end;
     }
-    std::vector<skity::TextRun> runs;
-    skity::Font skity_font(typeface->GetTypeface(), paint->GetTextSize());
-    skity_font.SetEmbolden(painter->IsBold());
-    skity_font.SetSkewX(painter->IsItalic() ? -0.25f : 0);
-    runs.emplace_back(skity_font, glyph_vector, p_x, p_y);
-
-    std::shared_ptr<skity::TextBlob> text_blob =
-        std::make_shared<skity::TextBlob>(runs);
-
-    const auto& shadow_list = painter->GetShadowList();
-    if (!shadow_list.empty()) {
-      for (auto& shadow : shadow_list) {
-        paint->SetColor(shadow.color_.GetPlainColor());
-        if (shadow.blur_radius_ != 0) {
-          std::shared_ptr<skity::MaskFilter> filter =
-              skity::MaskFilter::MakeBlur(skity::BlurStyle::kNormal,
-                                          shadow.blur_radius_);
-          paint->SetMaskFilter(filter);
-        }
-        canvas_->DrawTextBlob(text_blob, ox, oy, *paint);
-      }
+  }
+  std::unique_ptr<PreparedGlyphRuns> PrepareGlyphRuns(
+      const GlyphRun* runs, uint32_t run_count) override {
+    auto prepared = std::make_unique<SkityPreparedGlyphRuns>();
+    uint32_t start = 0;
+    while (start < run_count) {
+      auto end = NextPainterGroup(runs, start, run_count);
+      prepared->text_blobs_.push_back(MakeTextBlob(runs + start, end - start));
+      start = end;
+    }
+    return prepared;
+  }
+  void DrawPreparedGlyphRuns(const PreparedGlyphRuns* prepared,
+                             const GlyphRun* runs,
+                             uint32_t run_count) override {
+    if (prepared == nullptr) {
+      DrawGlyphRuns(runs, run_count);
+      return;
+    }
+    const auto& text_blobs =
+        static_cast<const SkityPreparedGlyphRuns*>(prepared)->text_blobs_;
+    uint32_t start = 0;
+    for (const auto& text_blob : text_blobs) {
+      TTASSERT(start < run_count);
+      auto end = NextPainterGroup(runs, start, run_count);
+      DrawTextBlob(text_blob, runs + start, end - start);
+      start = end;
     }
-
-    canvas_->DrawTextBlob(text_blob, ox, oy, *paint);
   }
   void DrawRunDelegate(const RunDelegate* delegate, float left, float top,
                        float right, float bottom,
@@ -129,6 +168,181 @@ class SkityCanvasHelper : public ICanvasHelper {
                      float src_right, float src_bottom, float dst_left,
                      float dst_top, float dst_right, float dst_bottom,
                      tttext::Painter* painter, bool srcRectPercent) override {}
+  static uint32_t NextPainterGroup(const GlyphRun* runs, uint32_t start,
+                                   uint32_t run_count) {
+    auto end = start + 1;
+    while (end < run_count && runs[end].painter_ == runs[start].painter_) end++;
+    return end;
+  }
+  // glyphs are placed relative to the origin of the first run
+  static std::shared_ptr<skity::TextBlob> MakeTextBlob(const GlyphRun* runs,
+                                                       uint32_t run_count) {
+    auto* painter = runs[0].painter_;
+    const float ox = runs[0].origin_x_;
+    const float oy = runs[0].origin_y_;
+
+    std::vector<skity::TextRun> text_runs;
+    text_runs.reserve(run_count);
+    for (uint32_t k = 0; k < run_count; k++) {
+      const auto& run = runs[k];
+      const auto* typeface =
+          reinterpret_cast<const skity::textlayout::SkityTypefaceHelper*>(
+              run.font_);
+      std::vector<skity::GlyphID> glyph_vector(run.glyphs_,
+                                               run.glyphs_ + run.glyph_count_);
+      std::vector<float> p_x(run.glyph_count_);
+      std::vector<float> p_y(run.glyph_count_);
+      for (uint32_t index = 0; index < run.glyph_count_; index++) {
+        p_x[index] = run.x_[index] + run.origin_x_ - ox;
+        p_y[index] = run.origin_y_ - oy - run.y_[index];
+      }
+      skity::Font skity_font(typeface->GetTypeface(), painter->GetTextSize());
+      skity_font.SetEmbolden(painter->IsBold());
+      skity_font.SetSkewX(painter->IsItalic() ? -0.25f : 0);
+      text_runs.emplace_back(skity_font, glyph_vector, p_x, p_y);
+    }
+    return std::make_shared<skity::TextBlob>(text_runs);
+  }
+  void DrawTextBlob(const std::shared_ptr<skity::TextBlob>& text_blob,
+                    const GlyphRun* runs, uint32_t run_count) {
+    auto* painter = runs[0].painter_;
+    skity::Paint* paint = ToSkityPaint(painter);
+    for (const auto& shadow : painter->GetShadowList()) {
+      DrawShadow(text_blob, runs, run_count, shadow, *paint);
+    }
+    canvas_->DrawTextBlob(text_blob, runs[0].origin_x_, runs[0].origin_y_,
+                          *paint);
+  }
+  // shadows are drawn with a copy of the text paint, so the text itself keeps
+  // its color and has no mask filter
+  void DrawShadow(const std::shared_ptr<skity::TextBlob>& text_blob,
+                  const GlyphRun* runs, uint32_t run_count,
+                  const TextShadow& shadow, const skity::Paint& text_paint) {
+    skity::Paint paint = text_paint;
+    paint.SetColor(shadow.color_.GetPlainColor());
+    const float x = runs[0].origin_x_ + shadow.offset_[0];
+    const float y = runs[0].origin_y_ + shadow.offset_[1];
+    const auto blur_radius = static_cast<float>(shadow.blur_radius_);
+    const SkityShadowCache::Entry* entry = nullptr;
+    if (blur_radius != 0 && shadow_cache_ != nullptr) {
+      auto key = MakeShadowKey(runs, run_count, blur_radius, paint);
+      entry = shadow_cache_->Find(key);
+      if (entry == nullptr) {
+        entry = RenderShadow(key, text_blob, runs, run_count, blur_radius,
+                             paint);
+      }
+    }
+    if (entry != nullptr) {
+      const auto& bounds = entry->bounds_;
+      canvas_->DrawImage(entry->image_,
+                         skity::Rect::MakeLTRB(x + bounds.Left(),
+                                               y + bounds.Top(),
+                                               x + bounds.Right(),
+                                               y + bounds.Bottom()));
+      return;
+    }
+    if (blur_radius != 0) {
+      paint.SetMaskFilter(
+          skity::MaskFilter::MakeBlur(skity::BlurStyle::kNormal, blur_radius));
+    }
+    canvas_->DrawTextBlob(text_blob, x, y, paint);
+  }
+  template <typename T>
+  static void AppendKey(std::string* key, T value) {
+    key->append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  // everything the pixels of a blurred shadow depend on
+  std::string MakeShadowKey(const GlyphRun* runs, uint32_t run_count,
+                            float blur_radius, const skity::Paint& paint) const {
+    const auto* painter = runs[0].painter_;
+    std::string key;
+    AppendKey(&key, device_scale_);
+    AppendKey(&key, blur_radius);
+    AppendKey(&key, paint.GetColor());
+    AppendKey(&key, paint.GetStyle());
+    AppendKey(&key, paint.GetStrokeWidth());
+    AppendKey(&key, painter->GetTextSize());
+    AppendKey(&key, painter->IsBold());
+    AppendKey(&key, painter->IsItalic());
+    for (uint32_t k = 0; k < run_count; k++) {
+      const auto& run = runs[k];
+      AppendKey(&key, run.font_->GetUniqueId());
+      AppendKey(&key, run.glyph_count_);
+      key.append(reinterpret_cast<const char*>(run.glyphs_),
+                 run.glyph_count_ * sizeof(uint16_t));
+      for (uint32_t index = 0; index < run.glyph_count_; index++) {
+        AppendKey(&key, run.x_[index] + run.origin_x_ - runs[0].origin_x_);
+        AppendKey(&key, run.origin_y_ - runs[0].origin_y_ - run.y_[index]);
+      }
+    }
+    return key;
+  }
+  // glyph bounds of the blob relative to its origin, from the glyph metrics
+  // cached on the typefaces
+  static skity::Rect GetTextBlobBounds(const GlyphRun* runs,
+                                       uint32_t run_count) {
+    auto* painter = runs[0].painter_;
+    float left = 0, top = 0, right = 0, bottom = 0;
+    bool empty = true;
+    std::vector<GlyphMetrics> glyph_metrics;
+    for (uint32_t k = 0; k < run_count; k++) {
+      const auto& run = runs[k];
+      glyph_metrics.resize(run.glyph_count_);
+      run.font_->GetGlyphMetrics(run.glyphs_, run.glyph_count_,
+                                 painter->GetTextSize(), glyph_metrics.data());
+      for (uint32_t index = 0; index < run.glyph_count_; index++) {
+        const auto& bounds = glyph_metrics[index].bounds_;
+        if (bounds[2] <= bounds[0] || bounds[3] <= bounds[1]) continue;
+        const float x = run.x_[index] + run.origin_x_ - runs[0].origin_x_;
+        const float y = run.origin_y_ - runs[0].origin_y_ - run.y_[index];
+        left = empty ? x + bounds[0] : std::min(left, x + bounds[0]);
+        top = empty ? y + bounds[1] : std::min(top, y + bounds[1]);
+        right = empty ? x + bounds[2] : std::max(right, x + bounds[2]);
+        bottom = empty ? y + bounds[3] : std::max(bottom, y + bounds[3]);
+        empty = false;
+      }
+    }
+    return skity::Rect::MakeLTRB(left, top, right, bottom);
+  }
+  // renders the blurred shadow once into an image kept in the shadow cache
+  const SkityShadowCache::Entry* RenderShadow(
+      const std::string& key, const std::shared_ptr<skity::TextBlob>& text_blob,
+      const GlyphRun* runs, uint32_t run_count, float blur_radius,
+      const skity::Paint& paint) {
+    auto bounds = GetTextBlobBounds(runs, run_count);
+    if (bounds.IsEmpty()) return nullptr;
+    // the blur spreads over about three radii, fake bold and skew are not part
+    // of the glyph bounds
+    const float outset =
+        3 * blur_radius + runs[0].painter_->GetTextSize() * 0.25f;
+    bounds = skity::Rect::MakeLTRB(
+        bounds.Left() - outset, bounds.Top() - outset, bounds.Right() + outset,
+        bounds.Bottom() + outset);
+    const auto width =
+        static_cast<uint32_t>(std::ceil(bounds.Width() * device_scale_));
+    const auto height =
+        static_cast<uint32_t>(std::ceil(bounds.Height() * device_scale_));
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    if (width == 0 || height == 0 || bytes > shadow_cache_->GetBudgetBytes()) {
+      return nullptr;
+    }
+    skity::Bitmap bitmap(width, height, skity::AlphaType::kPremul_AlphaType,
+                         skity::ColorType::kRGBA);
+    auto canvas = skity::Canvas::MakeSoftwareCanvas(&bitmap);
+    canvas->Scale(device_scale_, device_scale_);
+    canvas->Translate(-bounds.Left(), -bounds.Top());
+    skity::Paint blur_paint = paint;
+    blur_paint.SetMaskFilter(
+        skity::MaskFilter::MakeBlur(skity::BlurStyle::kNormal, blur_radius));
+    canvas->DrawTextBlob(text_blob, 0, 0, blur_paint);
+    canvas->Flush();
+    SkityShadowCache::Entry entry;
+    entry.image_ = skity::Image::MakeImage(bitmap.GetPixmap());
+    entry.bounds_ = bounds;
+    entry.bytes_ = bytes;
+    if (entry.image_ == nullptr) return nullptr;
+    return shadow_cache_->Insert(key, std::move(entry));
+  }
   skity::Paint* ToSkityPaint(tttext::Painter* painter) {
     auto* p = reinterpret_cast<SkityPainter*>(painter);
     if (p && p->platform_painter_) {
@@ -158,6 +372,8 @@ class SkityCanvasHelper : public ICanvasHelper {
  private:
   skity::Canvas* canvas_;
   skity::Paint paint_{};
+  std::shared_ptr<SkityShadowCache> shadow_cache_;
+  float device_scale_ = 1.f;
 };
 }  // namespace tttext
 }  // namespace ttoffice
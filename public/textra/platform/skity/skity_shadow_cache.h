@@ -0,0 +1,101 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PUBLIC_TEXTRA_PLATFORM_SKITY_SKITY_SHADOW_CACHE_H_
+#define PUBLIC_TEXTRA_PLATFORM_SKITY_SKITY_SHADOW_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <skity/geometry/rect.hpp>
+#include <skity/graphic/image.hpp>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief Blurred text shadows rendered once into images and drawn again on the
+ * following frames.
+ *
+ * An entry is keyed by the content of the shadowed text blob, the shadow
+ * color, the blur radius and the device scale it was rendered at. The least
+ * recently used entries are evicted when the pixels of all the entries exceed
+ * the memory budget. A cache can be shared by the canvas helpers of several
+ * frames, it is not thread safe.
+ */
+class SkityShadowCache {
+ public:
+  static constexpr size_t kDefaultBudgetBytes = 4 * 1024 * 1024;
+  struct Entry {
+    std::shared_ptr<skity::Image> image_;
+    // bounds of the image relative to the origin of the blob, in unscaled
+    // canvas units
+    skity::Rect bounds_;
+    size_t bytes_ = 0;
+  };
+
+ public:
+  explicit SkityShadowCache(size_t budget_bytes = kDefaultBudgetBytes)
+      : budget_bytes_(budget_bytes) {}
+
+ public:
+  /**
+   * @return nullptr if the key is not cached, the entry becomes the most
+   * recently used one otherwise
+   */
+  const Entry* Find(const std::string& key) {
+    auto iter = index_.find(key);
+    if (iter == index_.end()) return nullptr;
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return &iter->second->second;
+  }
+  const Entry* Insert(const std::string& key, Entry entry) {
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+      used_bytes_ -= iter->second->second.bytes_;
+      entries_.erase(iter->second);
+      index_.erase(iter);
+    }
+    used_bytes_ += entry.bytes_;
+    entries_.emplace_front(key, std::move(entry));
+    index_[key] = entries_.begin();
+    Evict();
+    return index_.count(key) > 0 ? &entries_.front().second : nullptr;
+  }
+  void Clear() {
+    entries_.clear();
+    index_.clear();
+    used_bytes_ = 0;
+  }
+  void SetBudgetBytes(size_t budget_bytes) {
+    budget_bytes_ = budget_bytes;
+    Evict();
+  }
+  size_t GetBudgetBytes() const { return budget_bytes_; }
+  size_t GetUsedBytes() const { return used_bytes_; }
+  size_t GetEntryCount() const { return entries_.size(); }
+
+ private:
+  void Evict() {
+    while (used_bytes_ > budget_bytes_ && !entries_.empty()) {
+      used_bytes_ -= entries_.back().second.bytes_;
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+  }
+
+ private:
+  using EntryList = std::list<std::pair<std::string, Entry>>;
+  size_t budget_bytes_;
+  size_t used_bytes_ = 0;
+  // most recently used first
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // PUBLIC_TEXTRA_PLATFORM_SKITY_SKITY_SHADOW_CACHE_H_
@@ -0,0 +1,115 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PUBLIC_TEXTRA_RECORDING_CANVAS_HELPER_H_
+#define PUBLIC_TEXTRA_RECORDING_CANVAS_HELPER_H_
+
+#include <textra/flat_layout_result.h>
+#include <textra/i_canvas_helper.h>
+#include <textra/macro.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief A backend independent canvas recording a display list.
+ *
+ * Every call is appended to a FlatLayoutResult as one op, glyph ids and
+ * positions go to a shared glyph buffer and painters are deduplicated into a
+ * paint table, so a display list only stores each distinct paint once. The
+ * recording can be replayed onto any ICanvasHelper with
+ * FlatLayoutResult::Draw().
+ *
+ * Operations which cannot be stored without pointers to the caller's objects
+ * (run delegates, paths, arcs, image rects, clears) are dropped with a
+ * warning and counted by FlatLayoutResult::GetDroppedOpCount().
+ */
+class L_EXPORT RecordingCanvasHelper : public ICanvasHelper {
+ public:
+  RecordingCanvasHelper();
+  ~RecordingCanvasHelper() override;
+
+ public:
+  /**
+   * @brief Hands the recorded display list over and starts a new empty one.
+   */
+  std::unique_ptr<FlatLayoutResult> FinishRecording();
+  uint32_t GetOpCount() const {
+    return static_cast<uint32_t>(result_->ops_.size());
+  }
+
+ public:
+  std::unique_ptr<Painter> CreatePainter() override {
+    return std::make_unique<Painter>();
+  }
+  void StartPaint() override {}
+  void EndPaint() override {}
+  void Save() override;
+  void Restore() override;
+  void Translate(float dx, float dy) override;
+  void Scale(float sx, float sy) override;
+  void Rotate(float degrees) override;
+  void Skew(float sx, float sy) override;
+  void ClipRect(float left, float top, float right, float bottom,
+                bool doAntiAlias) override;
+  void Clear() override;
+  void ClearRect(float left, float top, float right, float bottom) override;
+  void FillRect(float left, float top, float right, float bottom,
+                uint32_t color) override;
+  void DrawColor(uint32_t color) override;
+  void DrawLine(float x1, float y1, float x2, float y2,
+                Painter* painter) override;
+  void DrawRect(float left, float top, float right, float bottom,
+                Painter* painter) override;
+  void DrawOval(float left, float top, float right, float bottom,
+                Painter* painter) override;
+  void DrawCircle(float x, float y, float radius, Painter* painter) override;
+  void DrawArc(float left, float top, float right, float bottom,
+               float startAngle, float sweepAngle, bool useCenter,
+               Painter* painter) override;
+  void DrawPath(Path* path, Painter* painter) override;
+  void DrawArcTo(float start_x, float start_y, float mid_x, float mid_y,
+                 float end_x, float end_y, float radius,
+                 Painter* painter) override;
+  void DrawText(const ITypefaceHelper* font, const char* text,
+                uint32_t text_bytes, float x, float y,
+                Painter* painter) override;
+  void DrawGlyphs(const ITypefaceHelper* font, uint32_t glyph_count,
+                  const uint16_t* glyphs, const char* text,
+                  uint32_t text_bytes, float origin_x, float origin_y,
+                  float* x, float* y, Painter* painter) override;
+  void DrawRunDelegate(const RunDelegate* delegate, float left, float top,
+                       float right, float bottom, Painter* painter) override;
+  void DrawBackgroundDelegate(const RunDelegate* delegate,
+                              Painter* painter) override;
+  void DrawImage(const char* src, float left, float top, float right,
+                 float bottom, Painter* painter) override;
+  void DrawImageRect(const char* src, float src_left, float src_top,
+                     float src_right, float src_bottom, float dst_left,
+                     float dst_top, float dst_right, float dst_bottom,
+                     Painter* painter, bool srcRectPercent) override;
+  void DrawRoundRect(float left, float top, float right, float bottom,
+                     float radius, Painter* painter) override;
+
+ private:
+  FlatLayoutResult::Op& AddOp(CanvasOp type, const Painter* painter,
+                              std::initializer_list<float> values);
+  void Drop(CanvasOp type);
+  uint32_t AddString(const char* str, uint32_t length);
+  uint32_t AddTypeface(const ITypefaceHelper* font);
+  uint32_t AddPaint(const Painter* painter);
+
+ private:
+  std::unique_ptr<FlatLayoutResult> result_;
+  // encoded painter state to index in the paint table
+  std::unordered_map<std::string, uint32_t> paint_index_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // PUBLIC_TEXTRA_RECORDING_CANVAS_HELPER_H_
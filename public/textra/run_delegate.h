@@ -71,6 +71,7 @@ class RunDelegate {
   float x_offset_{std::numeric_limits<float>::lowest()};
   float y_offset_{std::numeric_limits<float>::lowest()};
   friend class TextLineImpl;
+  friend class LayoutRegion;
 };
 }  // namespace tttext
 }  // namespace ttoffice
@@ -9,6 +9,7 @@
 #include <textra/macro.h>
 
 #include <memory>
+#include <utility>
 
 namespace ttoffice {
 namespace tttext {
@@ -64,6 +65,16 @@ class L_EXPORT TextLayout {
   LayoutResult LayoutEx(Paragraph* para, LayoutRegion* page,
                         TTTextContext& context) const;
 
+  /**
+   * Measures the paragraph laid out at the given width without building the
+   * drawing data. Results are memoized on the paragraph by width and max
+   * lines, until it is formatted again or its paragraph style is replaced.
+   * @param para [in] paragraph to be measured
+   * @param width [in] available width
+   * @return layouted {width, height}
+   */
+  std::pair<float, float> MeasureForWidth(Paragraph* para, float width) const;
+
  private:
   std::unique_ptr<TTShaper> shaper_;
 };
@@ -89,6 +89,14 @@ class L_EXPORT TextLine {
   virtual void GetBoundingRectByCharRange(float bounding_rect[4],
                                           CharPos start_char_pos,
                                           CharPos end_char_pos) const = 0;
+  /**
+   * Get the ink extent of the glyphs drawn in this line, it may overflow the
+   * line box for tall, descending or overhanging glyphs. Hosts use it as the
+   * repaint region of the line. Fake bold and italic are not included.
+   * @param bounding_rect return value, [left, top, width, height], empty at
+   * the line top left if nothing is drawn
+   */
+  virtual void GetInkBoundingRect(float bounding_rect[4]) const = 0;
   /**
    * Get CharPos based on x coordinate, character offset relative to
    * LineStartPos, first character ID at line start is 0
@@ -15,6 +15,7 @@ namespace ttoffice {
 namespace tttext {
 class LayoutRegion;
 class LayoutPosition;
+class Paginator;
 class TextLayoutImpl;
 /**
  * @brief A class manages the text layout configurations and intermediate layout
@@ -58,12 +59,42 @@ class L_EXPORT TTTextContext {
     skip_spacing_before_first_line_ = skipSpacingBeforeFirstLine;
   }
 
+  /**
+   * @brief Controls whether layout only measures the text.
+   *
+   * Value: Boolean. When enabled, layout computes line boundaries, line
+   * metrics and the layouted size of the region, but does not build the
+   * drawer pieces of the lines. They are built the first time a line is
+   * drawn or hit-tested. Use it for measure passes that only read line count,
+   * width or height. Default is false.
+   */
+  bool IsMeasureOnly() const { return measure_only_; }
+  void SetMeasureOnly(bool measure_only) { measure_only_ = measure_only; }
+
   // Layout state getters/setters
  public:
   void Reset();
   void ResetLayoutPosition(const LayoutPosition& position);
 
+  // Layout statistics, accumulated by every layout using this context
+ public:
+  /**
+   * @brief Number of times a line was cleared and laid out again from its
+   * start, because a taller run changed the ranges available to the line.
+   */
+  uint32_t GetLineRelayoutCount() const { return line_relayout_count_; }
+  /**
+   * @brief Number of times the available ranges of a line were queried from
+   * the region.
+   */
+  uint32_t GetRangeListQueryCount() const { return range_list_query_count_; }
+  void ResetLayoutStatistics() {
+    line_relayout_count_ = 0;
+    range_list_query_count_ = 0;
+  }
+
  private:
+  friend class Paginator;
   friend class TextLayoutImpl;
   friend class TextLayoutTest;
   friend class TTTextContextTest;
@@ -90,6 +121,7 @@ class L_EXPORT TTTextContext {
   // Layout Configurations
   bool last_line_can_overflow_{true};
   bool skip_spacing_before_first_line_{false};
+  bool measure_only_{false};
   // Layout States
   std::unique_ptr<LayoutPosition> position_;
   float layout_bottom_{0};
@@ -97,6 +129,9 @@ class L_EXPORT TTTextContext {
   float line_space_{0};
   float bottom_margin_{0};
   float min_bottom_height_{0};
+  // Layout Statistics
+  uint32_t line_relayout_count_{0};
+  uint32_t range_list_query_count_{0};
 };
 }  // namespace tttext
 }  // namespace ttoffice
@@ -0,0 +1,484 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/ports/platform/linux/font_index.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/textlayout/utils/little_endian.h"
+
+namespace ttoffice {
+namespace tttext {
+namespace {
+constexpr uint32_t kIndexMagic = 0x49465454;  // "TTFI"
+constexpr uint32_t kIndexVersion = 1;
+
+constexpr uint32_t MakeTag(char a, char b, char c, char d) {
+  return (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(b) << 16) |
+         (static_cast<uint32_t>(c) << 8) | static_cast<uint32_t>(d);
+}
+constexpr uint32_t kTagTtcf = MakeTag('t', 't', 'c', 'f');
+constexpr uint32_t kTagOtto = MakeTag('O', 'T', 'T', 'O');
+constexpr uint32_t kTagTrue = MakeTag('t', 'r', 'u', 'e');
+constexpr uint32_t kTagName = MakeTag('n', 'a', 'm', 'e');
+constexpr uint32_t kTagOs2 = MakeTag('O', 'S', '/', '2');
+constexpr uint32_t kTagHead = MakeTag('h', 'e', 'a', 'd');
+constexpr uint32_t kTagCmap = MakeTag('c', 'm', 'a', 'p');
+
+/**
+ * @brief Bounds checked big-endian reads, out of range reads return 0 and
+ * clear ok_.
+ */
+class SfntReader {
+ public:
+  SfntReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+ public:
+  bool Has(size_t offset, size_t length) const {
+    return offset <= size_ && length <= size_ - offset;
+  }
+  uint8_t U8(size_t offset) {
+    if (!Has(offset, 1)) return Fail();
+    return data_[offset];
+  }
+  uint16_t U16(size_t offset) {
+    if (!Has(offset, 2)) return Fail();
+    return static_cast<uint16_t>((data_[offset] << 8) | data_[offset + 1]);
+  }
+  uint32_t U32(size_t offset) {
+    if (!Has(offset, 4)) return Fail();
+    return (static_cast<uint32_t>(data_[offset]) << 24) |
+           (static_cast<uint32_t>(data_[offset + 1]) << 16) |
+           (static_cast<uint32_t>(data_[offset + 2]) << 8) |
+           static_cast<uint32_t>(data_[offset + 3]);
+  }
+  const uint8_t* Data() const { return data_; }
+  bool IsOk() const { return ok_; }
+
+ private:
+  uint8_t Fail() {
+    ok_ = false;
+    return 0;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  bool ok_ = true;
+};
+
+struct TableRange {
+  uint32_t offset_ = 0;
+  uint32_t length_ = 0;
+};
+
+bool FindTable(SfntReader* reader, uint32_t face_offset, uint32_t tag,
+               TableRange* table) {
+  const auto num_tables = reader->U16(face_offset + 4);
+  for (auto k = 0u; k < num_tables; k++) {
+    const size_t record = face_offset + 12 + k * 16;
+    if (reader->U32(record) != tag) continue;
+    table->offset_ = reader->U32(record + 8);
+    table->length_ = reader->U32(record + 12);
+    return reader->IsOk() && reader->Has(table->offset_, table->length_);
+  }
+  return false;
+}
+
+void AppendUtf8(std::string* str, uint32_t code_point) {
+  if (code_point < 0x80) {
+    str->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    str->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    str->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    str->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    str->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    str->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    str->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    str->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    str->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    str->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+void ReadFamilies(SfntReader* reader, const TableRange& name,
+                  std::vector<std::string>* families) {
+  const auto count = reader->U16(name.offset_ + 2);
+  const size_t string_base = name.offset_ + reader->U16(name.offset_ + 4);
+  for (auto k = 0u; k < count; k++) {
+    const size_t record = name.offset_ + 6 + k * 12;
+    const auto platform_id = reader->U16(record);
+    const auto encoding_id = reader->U16(record + 2);
+    const auto name_id = reader->U16(record + 6);
+    const auto length = reader->U16(record + 8);
+    const size_t offset = string_base + reader->U16(record + 10);
+    // 1: family, 16: typographic family
+    if (!reader->IsOk() || (name_id != 1 && name_id != 16) ||
+        !reader->Has(offset, length)) {
+      continue;
+    }
+    std::string family;
+    if (platform_id == 0 || platform_id == 3) {
+      // utf-16 big-endian
+      for (size_t i = 0; i + 1 < length; i += 2) {
+        uint32_t unit = reader->U16(offset + i);
+        if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < length) {
+          const uint32_t low = reader->U16(offset + i + 2);
+          unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+          i += 2;
+        }
+        AppendUtf8(&family, unit);
+      }
+    } else if (platform_id == 1 && encoding_id == 0) {
+      // mac roman, only the ascii part is kept
+      for (size_t i = 0; i < length; i++) {
+        const auto c = reader->U8(offset + i);
+        if (c < 0x80) family.push_back(static_cast<char>(c));
+      }
+    } else {
+      continue;
+    }
+    family = FontIndex::ToLowerAscii(family.c_str());
+    if (family.empty() || std::find(families->begin(), families->end(),
+                                    family) != families->end()) {
+      continue;
+    }
+    // the typographic family groups all the weights, it goes first
+    families->insert(name_id == 16 ? families->begin() : families->end(),
+                     std::move(family));
+  }
+}
+
+FontStyle ReadStyle(SfntReader* reader, uint32_t face_offset) {
+  uint32_t weight = FontStyle::kNormal_Weight;
+  uint32_t width = FontStyle::kNormal_Width;
+  auto slant = FontStyle::kUpright_Slant;
+  TableRange table;
+  if (FindTable(reader, face_offset, kTagOs2, &table) && table.length_ >= 64) {
+    weight = reader->U16(table.offset_ + 4);
+    width = reader->U16(table.offset_ + 6);
+    const auto fs_selection = reader->U16(table.offset_ + 62);
+    if (fs_selection & (1u << 9)) {
+      slant = FontStyle::kOblique_Slant;
+    } else if (fs_selection & 1u) {
+      slant = FontStyle::kItalic_Slant;
+    }
+  } else if (FindTable(reader, face_offset, kTagHead, &table) &&
+             table.length_ >= 46) {
+    const auto mac_style = reader->U16(table.offset_ + 44);
+    if (mac_style & 1u) weight = FontStyle::kBold_Weight;
+    if (mac_style & 2u) slant = FontStyle::kItalic_Slant;
+  }
+  // some old fonts store the weight class divided by 100
+  if (weight >= 1 && weight <= 9) weight *= 100;
+  weight = std::min<uint32_t>(std::max<uint32_t>(weight, 1), 1000);
+  width = std::min<uint32_t>(std::max<uint32_t>(width, 1), 9);
+  return FontStyle(static_cast<FontStyle::Weight>(weight),
+                   static_cast<FontStyle::Width>(width), slant);
+}
+
+void AddRange(std::vector<std::pair<uint32_t, uint32_t>>* coverage,
+              uint32_t first, uint32_t last) {
+  if (first > last) return;
+  if (!coverage->empty() && coverage->back().second + 1 >= first &&
+      coverage->back().first <= first) {
+    coverage->back().second = std::max(coverage->back().second, last);
+    return;
+  }
+  coverage->emplace_back(first, last);
+}
+
+void ReadCmapFormat4(SfntReader* reader, size_t subtable,
+                     std::vector<std::pair<uint32_t, uint32_t>>* coverage) {
+  const auto seg_count = reader->U16(subtable + 6) / 2u;
+  const size_t end_codes = subtable + 14;
+  const size_t start_codes = end_codes + seg_count * 2 + 2;
+  const size_t id_deltas = start_codes + seg_count * 2;
+  const size_t id_range_offsets = id_deltas + seg_count * 2;
+  for (auto k = 0u; k < seg_count && reader->IsOk(); k++) {
+    const uint32_t end = reader->U16(end_codes + k * 2);
+    const uint32_t start = reader->U16(start_codes + k * 2);
+    const auto delta = reader->U16(id_deltas + k * 2);
+    const size_t range_offset_pos = id_range_offsets + k * 2;
+    const auto range_offset = reader->U16(range_offset_pos);
+    if (start > end || start == 0xFFFF) continue;
+    uint32_t run_start = 0xFFFFFFFF;
+    auto c = start;
+    for (; c <= end; c++) {
+      uint32_t glyph = 0;
+      if (range_offset == 0) {
+        glyph = (c + delta) & 0xFFFF;
+      } else {
+        const size_t glyph_pos =
+            range_offset_pos + range_offset + (c - start) * 2;
+        if (!reader->Has(glyph_pos, 2)) break;
+        glyph = reader->U16(glyph_pos);
+        if (glyph != 0) glyph = (glyph + delta) & 0xFFFF;
+      }
+      if (glyph != 0 && run_start == 0xFFFFFFFF) {
+        run_start = c;
+      } else if (glyph == 0 && run_start != 0xFFFFFFFF) {
+        AddRange(coverage, run_start, c - 1);
+        run_start = 0xFFFFFFFF;
+      }
+    }
+    if (run_start != 0xFFFFFFFF) AddRange(coverage, run_start, c - 1);
+  }
+}
+
+void ReadCmapFormat12(SfntReader* reader, size_t subtable,
+                      std::vector<std::pair<uint32_t, uint32_t>>* coverage) {
+  const auto group_count = reader->U32(subtable + 12);
+  for (auto k = 0u; k < group_count && reader->IsOk(); k++) {
+    const size_t group = subtable + 16 + static_cast<size_t>(k) * 12;
+    auto start = reader->U32(group);
+    const auto end = std::min<uint32_t>(reader->U32(group + 4), 0x10FFFF);
+    // the first code point of a group starting at glyph 0 is not mapped
+    if (reader->U32(group + 8) == 0) start++;
+    AddRange(coverage, start, end);
+  }
+}
+
+void ReadCoverage(SfntReader* reader, uint32_t face_offset,
+                  std::vector<std::pair<uint32_t, uint32_t>>* coverage) {
+  TableRange cmap;
+  if (!FindTable(reader, face_offset, kTagCmap, &cmap)) return;
+  size_t best_subtable = 0;
+  uint16_t best_format = 0;
+  const auto num_subtables = reader->U16(cmap.offset_ + 2);
+  for (auto k = 0u; k < num_subtables; k++) {
+    const size_t record = cmap.offset_ + 4 + k * 8;
+    const auto platform_id = reader->U16(record);
+    const auto encoding_id = reader->U16(record + 2);
+    const size_t subtable = cmap.offset_ + reader->U32(record + 4);
+    const auto format = reader->U16(subtable);
+    if (!reader->IsOk()) return;
+    const bool unicode =
+        platform_id == 0 ||
+        (platform_id == 3 &&
+         (encoding_id == 0 || encoding_id == 1 || encoding_id == 10));
+    if (!unicode) continue;
+    // a full repertoire format 12 table is preferred over a bmp one
+    if (format == 12 || (format == 4 && best_format != 12)) {
+      best_subtable = subtable;
+      best_format = format;
+    }
+  }
+  if (best_format == 12) {
+    ReadCmapFormat12(reader, best_subtable, coverage);
+  } else if (best_format == 4) {
+    ReadCmapFormat4(reader, best_subtable, coverage);
+  }
+  // segments are sorted, groups of a malformed table may not be
+  std::sort(coverage->begin(), coverage->end());
+  std::vector<std::pair<uint32_t, uint32_t>> merged;
+  merged.reserve(coverage->size());
+  for (const auto& range : *coverage) {
+    AddRange(&merged, range.first, range.second);
+  }
+  coverage->swap(merged);
+}
+
+bool ParseFace(SfntReader* reader, uint32_t face_offset,
+               FontFaceRecord* face) {
+  const auto version = reader->U32(face_offset);
+  if (version != 0x00010000 && version != kTagOtto && version != kTagTrue) {
+    return false;
+  }
+  TableRange name;
+  if (FindTable(reader, face_offset, kTagName, &name)) {
+    ReadFamilies(reader, name, &face->families_);
+  }
+  face->style_ = ReadStyle(reader, face_offset);
+  ReadCoverage(reader, face_offset, &face->coverage_);
+  return !face->families_.empty();
+}
+
+void AppendString(std::string* data, const std::string& str) {
+  little_endian::Append(data, static_cast<uint32_t>(str.length()));
+  data->append(str);
+}
+void Append64(std::string* data, uint64_t value) {
+  little_endian::Append(data, static_cast<uint32_t>(value & 0xFFFFFFFF));
+  little_endian::Append(data, static_cast<uint32_t>(value >> 32));
+}
+
+/**
+ * @brief Bounds checked reads of a buffer written by FontIndex::Serialize().
+ */
+class IndexReader {
+ public:
+  IndexReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+ public:
+  template <typename T>
+  bool Read(T* value) {
+    if (size_ - offset_ < sizeof(T)) return false;
+    *value = little_endian::Read<T>(data_, &offset_);
+    return true;
+  }
+  bool Read64(uint64_t* value) {
+    uint32_t low, high;
+    if (!Read(&low) || !Read(&high)) return false;
+    *value = (static_cast<uint64_t>(high) << 32) | low;
+    return true;
+  }
+  bool ReadString(std::string* str) {
+    uint32_t length;
+    if (!Read(&length) || size_ - offset_ < length) return false;
+    str->assign(reinterpret_cast<const char*>(data_ + offset_), length);
+    offset_ += length;
+    return true;
+  }
+  // guards the reserve of a count read from the buffer
+  bool Fits(uint32_t count, size_t min_bytes_each) const {
+    return count <= (size_ - offset_) / min_bytes_each;
+  }
+  bool AtEnd() const { return offset_ == size_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+}  // namespace
+
+bool FontFaceRecord::Covers(uint32_t code_point) const {
+  auto iter = std::upper_bound(
+      coverage_.begin(), coverage_.end(), code_point,
+      [](uint32_t value, const std::pair<uint32_t, uint32_t>& range) {
+        return value < range.first;
+      });
+  if (iter == coverage_.begin()) return false;
+  --iter;
+  return code_point <= iter->second;
+}
+
+bool FontIndex::ParseFontFile(const uint8_t* data, size_t size,
+                              std::vector<FontFaceRecord>* faces) {
+  SfntReader reader(data, size);
+  std::vector<uint32_t> face_offsets;
+  if (reader.U32(0) == kTagTtcf) {
+    const auto num_fonts = reader.U32(8);
+    for (auto k = 0u; k < num_fonts && reader.Has(12 + k * 4ul, 4); k++) {
+      face_offsets.push_back(reader.U32(12 + k * 4ul));
+    }
+  } else {
+    face_offsets.push_back(0);
+  }
+  if (!reader.IsOk()) return false;
+  bool is_sfnt = false;
+  for (auto k = 0u; k < face_offsets.size(); k++) {
+    SfntReader face_reader(data, size);
+    FontFaceRecord face;
+    face.ttc_index_ = k;
+    if (ParseFace(&face_reader, face_offsets[k], &face)) {
+      is_sfnt = true;
+      faces->push_back(std::move(face));
+    }
+  }
+  return is_sfnt;
+}
+
+std::string FontIndex::Serialize(const std::vector<FontFileRecord>& files) {
+  std::string data;
+  little_endian::Append(&data, kIndexMagic);
+  little_endian::Append(&data, kIndexVersion);
+  little_endian::Append(&data, static_cast<uint32_t>(files.size()));
+  for (const auto& file : files) {
+    AppendString(&data, file.path_);
+    Append64(&data, file.size_);
+    Append64(&data, static_cast<uint64_t>(file.mtime_));
+    little_endian::Append(&data, static_cast<uint32_t>(file.faces_.size()));
+    for (const auto& face : file.faces_) {
+      little_endian::Append(&data, face.ttc_index_);
+      little_endian::Append(&data,
+                            static_cast<uint16_t>(face.style_.GetWeight()));
+      little_endian::Append(&data,
+                            static_cast<uint8_t>(face.style_.GetWidth()));
+      little_endian::Append(&data,
+                            static_cast<uint8_t>(face.style_.GetSlant()));
+      little_endian::Append(&data,
+                            static_cast<uint32_t>(face.families_.size()));
+      for (const auto& family : face.families_) {
+        AppendString(&data, family);
+      }
+      little_endian::Append(&data,
+                            static_cast<uint32_t>(face.coverage_.size()));
+      for (const auto& range : face.coverage_) {
+        little_endian::Append(&data, range.first);
+        little_endian::Append(&data, range.second);
+      }
+    }
+  }
+  return data;
+}
+
+bool FontIndex::Deserialize(const uint8_t* data, size_t size,
+                            std::vector<FontFileRecord>* files) {
+  IndexReader reader(data, size);
+  uint32_t magic, version, file_count;
+  if (!reader.Read(&magic) || magic != kIndexMagic || !reader.Read(&version) ||
+      version != kIndexVersion || !reader.Read(&file_count) ||
+      !reader.Fits(file_count, 24)) {
+    return false;
+  }
+  std::vector<FontFileRecord> result(file_count);
+  for (auto& file : result) {
+    uint64_t mtime;
+    uint32_t face_count;
+    if (!reader.ReadString(&file.path_) || !reader.Read64(&file.size_) ||
+        !reader.Read64(&mtime) || !reader.Read(&face_count) ||
+        !reader.Fits(face_count, 16)) {
+      return false;
+    }
+    file.mtime_ = static_cast<int64_t>(mtime);
+    file.faces_.resize(face_count);
+    for (auto& face : file.faces_) {
+      uint16_t weight;
+      uint8_t width, slant;
+      uint32_t family_count, range_count;
+      if (!reader.Read(&face.ttc_index_) || !reader.Read(&weight) ||
+          !reader.Read(&width) || !reader.Read(&slant) ||
+          slant > FontStyle::kOblique_Slant || !reader.Read(&family_count) ||
+          !reader.Fits(family_count, 4)) {
+        return false;
+      }
+      face.style_ = FontStyle(static_cast<FontStyle::Weight>(weight),
+                              static_cast<FontStyle::Width>(width),
+                              static_cast<FontStyle::Slant>(slant));
+      face.families_.resize(family_count);
+      for (auto& family : face.families_) {
+        if (!reader.ReadString(&family)) return false;
+      }
+      if (!reader.Read(&range_count) || !reader.Fits(range_count, 8)) {
+        return false;
+      }
+      face.coverage_.resize(range_count);
+      for (auto& range : face.coverage_) {
+        if (!reader.Read(&range.first) || !reader.Read(&range.second)) {
+          return false;
+        }
+      }
+    }
+  }
+  if (!reader.AtEnd()) return false;
+  files->swap(result);
+  return true;
+}
+
+std::string FontIndex::ToLowerAscii(const char* str) {
+  std::string lower(str != nullptr ? str : "");
+  for (auto& c : lower) {
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+  }
+  return lower;
+}
+}  // namespace tttext
+}  // namespace ttoffice
@@ -0,0 +1,65 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_PORTS_PLATFORM_LINUX_FONT_INDEX_H_
+#define SRC_PORTS_PLATFORM_LINUX_FONT_INDEX_H_
+
+#include <textra/font_info.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief What font matching needs to know about one face of a font file,
+ * read once from its name, OS/2, head and cmap tables.
+ */
+struct FontFaceRecord {
+  uint32_t ttc_index_ = 0;
+  // family names of all the platforms and languages with ascii letters in
+  // lower case, a typographic family first
+  std::vector<std::string> families_;
+  FontStyle style_;
+  // sorted disjoint [first, last] ranges of the code points the cmap maps
+  std::vector<std::pair<uint32_t, uint32_t>> coverage_;
+
+  bool Covers(uint32_t code_point) const;
+};
+struct FontFileRecord {
+  std::string path_;
+  uint64_t size_ = 0;
+  int64_t mtime_ = 0;
+  std::vector<FontFaceRecord> faces_;
+};
+
+/**
+ * @brief Reads sfnt files (ttf, otf, ttc) into records and stores the records
+ * of a whole font directory in a compact little-endian buffer, so that they
+ * are parsed only when a file changes.
+ */
+class FontIndex {
+ public:
+  /**
+   * @brief Parses every face of a font file or collection.
+   * @return false if data is not an sfnt file, faces that can't be read are
+   * skipped
+   */
+  static bool ParseFontFile(const uint8_t* data, size_t size,
+                            std::vector<FontFaceRecord>* faces);
+  static std::string Serialize(const std::vector<FontFileRecord>& files);
+  /**
+   * @return false if data is not a buffer produced by Serialize() of this
+   * version
+   */
+  static bool Deserialize(const uint8_t* data, size_t size,
+                          std::vector<FontFileRecord>* files);
+  static std::string ToLowerAscii(const char* str);
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // SRC_PORTS_PLATFORM_LINUX_FONT_INDEX_H_
@@ -0,0 +1,427 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <textra/platform/linux/linux_font_manager.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "src/ports/platform/linux/font_index.h"
+#include "src/textlayout/utils/log_util.h"
+
+namespace ttoffice {
+namespace tttext {
+namespace {
+constexpr int kMaxDirDepth = 16;
+constexpr int32_t kNoFace = -1;
+constexpr const char* kSansSerif = "sans-serif";
+
+bool IsFontFile(const std::string& name) {
+  auto dot = name.rfind('.');
+  if (dot == std::string::npos) return false;
+  auto ext = FontIndex::ToLowerAscii(name.c_str() + dot);
+  return ext == ".ttf" || ext == ".otf" || ext == ".ttc" || ext == ".otc";
+}
+
+void ListFontFiles(const std::string& dir, int depth,
+                   std::vector<std::string>* paths) {
+  if (depth > kMaxDirDepth) return;
+  auto* handle = opendir(dir.c_str());
+  if (handle == nullptr) return;
+  while (auto* entry = readdir(handle)) {
+    std::string name = entry->d_name;
+    if (name.empty() || name[0] == '.') continue;
+    auto path = dir + "/" + name;
+    struct stat st = {};
+    if (stat(path.c_str(), &st) != 0) continue;
+    if (S_ISDIR(st.st_mode)) {
+      ListFontFiles(path, depth + 1, paths);
+    } else if (S_ISREG(st.st_mode) && IsFontFile(name)) {
+      paths->push_back(std::move(path));
+    }
+  }
+  closedir(handle);
+}
+
+/**
+ * @brief CSS font matching: the width comes first, then the slant, then the
+ * weight. A larger score is a better match.
+ */
+int StyleScore(const FontStyle& pattern, const FontStyle& current) {
+  const int pattern_width = pattern.GetWidth();
+  const int width = current.GetWidth();
+  int width_score;
+  if (width == pattern_width) {
+    width_score = 10;
+  } else if (pattern_width <= FontStyle::kNormal_Width) {
+    // narrower first, then wider
+    width_score = width < pattern_width ? 10 - pattern_width + width
+                                        : 10 - width;
+  } else {
+    // wider first, then narrower
+    width_score = width > pattern_width ? 10 + pattern_width - width : width;
+  }
+  // [pattern][current], oblique and italic substitute each other
+  static const int kSlantScore[3][3] = {{3, 1, 2}, {1, 3, 2}, {1, 2, 3}};
+  const int slant_score =
+      kSlantScore[pattern.GetSlant() % 3][current.GetSlant() % 3];
+  const int pattern_weight = pattern.GetWeight();
+  const int weight = current.GetWeight();
+  int weight_score;
+  if (pattern_weight == weight) {
+    weight_score = 1000;
+  } else if (pattern_weight < 400) {
+    // lighter first, then heavier
+    weight_score = weight <= pattern_weight ? 1000 - pattern_weight + weight
+                                            : 1000 - weight;
+  } else if (pattern_weight <= 500) {
+    // up to 500 first, then lighter, then heavier
+    if (weight >= pattern_weight && weight <= 500) {
+      weight_score = 1000 + pattern_weight - weight;
+    } else if (weight <= pattern_weight) {
+      weight_score = 500 + weight;
+    } else {
+      weight_score = 1000 - weight;
+    }
+  } else {
+    // heavier first, then lighter: a heavier face scores at least
+    // pattern_weight, more than any lighter one
+    weight_score =
+        weight > pattern_weight ? 1000 + pattern_weight - weight : weight;
+  }
+  // the slant score takes 2 bits, the weight score 11
+  return (width_score << 13) | (slant_score << 11) | weight_score;
+}
+}  // namespace
+
+std::shared_ptr<FontFileMapping> FontFileMapping::Map(
+    const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) return nullptr;
+  struct stat st = {};
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) return nullptr;
+  return std::shared_ptr<FontFileMapping>(new FontFileMapping(
+      static_cast<const uint8_t*>(data), static_cast<size_t>(st.st_size)));
+}
+FontFileMapping::~FontFileMapping() {
+  munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+LinuxFontManager::LinuxFontManager(std::vector<std::string> font_dirs,
+                                   TypefaceFactory factory,
+                                   std::string index_path)
+    : font_dirs_(std::move(font_dirs)),
+      factory_(std::move(factory)),
+      index_path_(std::move(index_path)) {
+  generic_families_[kSansSerif] = {"noto sans", "dejavu sans",
+                                   "liberation sans", "roboto", "inter"};
+  generic_families_["serif"] = {"noto serif", "dejavu serif",
+                                "liberation serif"};
+  generic_families_["monospace"] = {"noto sans mono", "dejavu sans mono",
+                                    "liberation mono", "jetbrains mono"};
+  Scan();
+}
+LinuxFontManager::LinuxFontManager(std::vector<std::string> font_dirs,
+                                   std::shared_ptr<IFontManager> backend,
+                                   std::string index_path)
+    : LinuxFontManager(
+          std::move(font_dirs),
+          [backend](const std::string& path, int ttc_index) {
+            return backend->makeFromFile(path.c_str(), ttc_index);
+          },
+          std::move(index_path)) {}
+LinuxFontManager::~LinuxFontManager() = default;
+
+int LinuxFontManager::countFamilies() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  std::unordered_set<std::string> families;
+  for (const auto& face : faces_) {
+    families.insert(
+        files_[face.file_idx_].faces_[face.record_idx_].families_.front());
+  }
+  return static_cast<int>(families.size());
+}
+TypefaceRef LinuxFontManager::matchFamilyStyle(const char familyName[],
+                                               const FontStyle& style) {
+  return legacyMakeTypeface(familyName, style);
+}
+TypefaceRef LinuxFontManager::matchFamilyStyleCharacter(
+    const char familyName[], const FontStyle& style, const char* bcp47[],
+    int bcp47Count, uint32_t character) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto face_idx = kNoFace;
+  if (familyName != nullptr && familyName[0] != '\0') {
+    auto family = FontIndex::ToLowerAscii(familyName);
+    auto generic = generic_families_.find(family);
+    if (generic != generic_families_.end()) {
+      for (const auto& name : generic->second) {
+        auto iter = family_faces_.find(name);
+        if (iter == family_faces_.end()) continue;
+        face_idx = MatchCharacterLocked(iter->second, style, character);
+        if (face_idx != kNoFace) break;
+      }
+    } else {
+      auto iter = family_faces_.find(family);
+      if (iter != family_faces_.end()) {
+        face_idx = MatchCharacterLocked(iter->second, style, character);
+      }
+    }
+  }
+  if (face_idx == kNoFace) {
+    face_idx = MatchFallbackLocked(style, character);
+  }
+  return GetTypefaceLocked(face_idx);
+}
+TypefaceRef LinuxFontManager::makeFromFile(const char path[], int ttcIndex) {
+  if (path == nullptr) return nullptr;
+  std::lock_guard<std::mutex> guard(lock_);
+  auto key = std::string(path) + "#" + std::to_string(ttcIndex);
+  auto& typeface = typefaces_[key];
+  if (typeface == nullptr) typeface = factory_(path, ttcIndex);
+  return typeface;
+}
+TypefaceRef LinuxFontManager::legacyMakeTypeface(const char familyName[],
+                                                 FontStyle style) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto family = FontIndex::ToLowerAscii(familyName);
+  if (family.empty()) family = kSansSerif;
+  auto face_idx = generic_families_.count(family) > 0
+                      ? MatchGenericLocked(family, style)
+                      : MatchFamilyLocked(family, style);
+  return GetTypefaceLocked(face_idx);
+}
+
+void LinuxFontManager::SetGenericFamilies(const std::string& generic,
+                                          std::vector<std::string> families) {
+  std::lock_guard<std::mutex> guard(lock_);
+  for (auto& family : families) {
+    family = FontIndex::ToLowerAscii(family.c_str());
+  }
+  generic_families_[FontIndex::ToLowerAscii(generic.c_str())] =
+      std::move(families);
+  fallback_cache_.clear();
+}
+void LinuxFontManager::Rescan() {
+  std::lock_guard<std::mutex> guard(lock_);
+  Scan();
+}
+std::shared_ptr<FontFileMapping> LinuxFontManager::MapFontFile(
+    const std::string& path) {
+  std::lock_guard<std::mutex> guard(mapping_lock_);
+  auto& entry = mappings_[path];
+  auto mapping = entry.lock();
+  if (mapping == nullptr) {
+    mapping = FontFileMapping::Map(path);
+    entry = mapping;
+  }
+  return mapping;
+}
+uint32_t LinuxFontManager::GetFaceCount() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return static_cast<uint32_t>(faces_.size());
+}
+
+void LinuxFontManager::Scan() {
+  std::vector<std::string> paths;
+  for (auto dir : font_dirs_) {
+    while (dir.length() > 1 && dir.back() == '/') dir.pop_back();
+    ListFontFiles(dir, 0, &paths);
+  }
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+  std::vector<FontFileRecord> previous;
+  if (files_.empty()) {
+    LoadIndex(&previous);
+  } else {
+    previous.swap(files_);
+  }
+  std::unordered_map<std::string, FontFileRecord*> previous_by_path;
+  for (auto& file : previous) {
+    previous_by_path[file.path_] = &file;
+  }
+  bool changed = previous.size() != paths.size();
+  std::vector<FontFileRecord> files;
+  files.reserve(paths.size());
+  for (auto& path : paths) {
+    struct stat st = {};
+    if (stat(path.c_str(), &st) != 0) continue;
+    FontFileRecord file;
+    file.path_ = std::move(path);
+    file.size_ = static_cast<uint64_t>(st.st_size);
+    file.mtime_ = static_cast<int64_t>(st.st_mtime);
+    auto iter = previous_by_path.find(file.path_);
+    if (iter != previous_by_path.end() && iter->second->size_ == file.size_ &&
+        iter->second->mtime_ == file.mtime_) {
+      file.faces_ = std::move(iter->second->faces_);
+    } else {
+      // files that are not fonts are recorded without faces so that they are
+      // not parsed again on the next start
+      changed = true;
+      auto mapping = FontFileMapping::Map(file.path_);
+      if (mapping == nullptr ||
+          !FontIndex::ParseFontFile(mapping->GetData(), mapping->GetSize(),
+                                    &file.faces_)) {
+        LogUtil::W("LinuxFontManager skips %s", file.path_.c_str());
+      }
+    }
+    files.push_back(std::move(file));
+  }
+  files_.swap(files);
+  if (changed) StoreIndex(files_);
+  BuildLookup();
+}
+void LinuxFontManager::BuildLookup() {
+  faces_.clear();
+  family_faces_.clear();
+  fallback_cache_.clear();
+  for (auto file_idx = 0u; file_idx < files_.size(); file_idx++) {
+    const auto& records = files_[file_idx].faces_;
+    for (auto record_idx = 0u; record_idx < records.size(); record_idx++) {
+      if (records[record_idx].families_.empty()) continue;
+      const auto face_idx = static_cast<uint32_t>(faces_.size());
+      faces_.push_back({file_idx, record_idx});
+      for (const auto& family : records[record_idx].families_) {
+        family_faces_[family].push_back(face_idx);
+      }
+    }
+  }
+}
+bool LinuxFontManager::LoadIndex(std::vector<FontFileRecord>* files) const {
+  if (index_path_.empty()) return false;
+  auto mapping = FontFileMapping::Map(index_path_);
+  if (mapping == nullptr) return false;
+  if (!FontIndex::Deserialize(mapping->GetData(), mapping->GetSize(), files)) {
+    LogUtil::W("LinuxFontManager ignores invalid index %s",
+               index_path_.c_str());
+    return false;
+  }
+  return true;
+}
+void LinuxFontManager::StoreIndex(
+    const std::vector<FontFileRecord>& files) const {
+  if (index_path_.empty()) return;
+  const auto data = FontIndex::Serialize(files);
+  // written aside and renamed, so that another process never reads half of it
+  const auto tmp_path = index_path_ + "." + std::to_string(getpid());
+  auto* file = fopen(tmp_path.c_str(), "wb");
+  if (file == nullptr) {
+    LogUtil::W("LinuxFontManager can't write index %s", tmp_path.c_str());
+    return;
+  }
+  const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+  if (fclose(file) != 0 || !written ||
+      rename(tmp_path.c_str(), index_path_.c_str()) != 0) {
+    LogUtil::W("LinuxFontManager can't write index %s", index_path_.c_str());
+    remove(tmp_path.c_str());
+  }
+}
+
+int32_t LinuxFontManager::MatchFamilyLocked(const std::string& family,
+                                            const FontStyle& style) const {
+  auto iter = family_faces_.find(family);
+  if (iter == family_faces_.end()) return kNoFace;
+  auto best_face = kNoFace;
+  auto best_score = 0;
+  for (auto face_idx : iter->second) {
+    const auto& face = faces_[face_idx];
+    auto score = StyleScore(
+        style, files_[face.file_idx_].faces_[face.record_idx_].style_);
+    if (best_face == kNoFace || score > best_score) {
+      best_face = static_cast<int32_t>(face_idx);
+      best_score = score;
+    }
+  }
+  return best_face;
+}
+int32_t LinuxFontManager::MatchGenericLocked(const std::string& generic,
+                                             const FontStyle& style) const {
+  auto iter = generic_families_.find(generic);
+  if (iter != generic_families_.end()) {
+    for (const auto& family : iter->second) {
+      auto face_idx = MatchFamilyLocked(family, style);
+      if (face_idx != kNoFace) return face_idx;
+    }
+  }
+  // none of the generic families is installed, any latin face does
+  return MatchFallbackLocked(style, 'a');
+}
+int32_t LinuxFontManager::MatchCharacterLocked(
+    const std::vector<uint32_t>& faces, const FontStyle& style,
+    uint32_t character) const {
+  auto best_face = kNoFace;
+  auto best_score = 0;
+  for (auto face_idx : faces) {
+    const auto& face = faces_[face_idx];
+    const auto& record = files_[face.file_idx_].faces_[face.record_idx_];
+    if (!record.Covers(character)) continue;
+    auto score = StyleScore(style, record.style_);
+    if (best_face == kNoFace || score > best_score) {
+      best_face = static_cast<int32_t>(face_idx);
+      best_score = score;
+    }
+  }
+  return best_face;
+}
+int32_t LinuxFontManager::MatchFallbackLocked(const FontStyle& style,
+                                              uint32_t character) const {
+  const auto key = (static_cast<uint64_t>(character) << 32) |
+                   static_cast<uint32_t>(style.Value());
+  auto cached = fallback_cache_.find(key);
+  if (cached != fallback_cache_.end()) return cached->second;
+  auto face_idx = kNoFace;
+  // the generic sans-serif families first, so that fallback text looks alike
+  auto generic = generic_families_.find(kSansSerif);
+  if (generic != generic_families_.end()) {
+    for (const auto& family : generic->second) {
+      auto iter = family_faces_.find(family);
+      if (iter == family_faces_.end()) continue;
+      face_idx = MatchCharacterLocked(iter->second, style, character);
+      if (face_idx != kNoFace) break;
+    }
+  }
+  if (face_idx == kNoFace) {
+    auto best_score = 0;
+    for (auto k = 0u; k < faces_.size(); k++) {
+      const auto& record =
+          files_[faces_[k].file_idx_].faces_[faces_[k].record_idx_];
+      if (!record.Covers(character)) continue;
+      auto score = StyleScore(style, record.style_);
+      if (face_idx == kNoFace || score > best_score) {
+        face_idx = static_cast<int32_t>(k);
+        best_score = score;
+      }
+    }
+  }
+  fallback_cache_.emplace(key, face_idx);
+  return face_idx;
+}
+TypefaceRef LinuxFontManager::GetTypefaceLocked(int32_t face_idx) const {
+  if (face_idx == kNoFace) return nullptr;
+  const auto& face = faces_[face_idx];
+  const auto& file = files_[face.file_idx_];
+  const auto ttc_index =
+      static_cast<int>(file.faces_[face.record_idx_].ttc_index_);
+  auto key = file.path_ + "#" + std::to_string(ttc_index);
+  auto& typeface = typefaces_[key];
+  if (typeface == nullptr) typeface = factory_(file.path_, ttc_index);
+  return typeface;
+}
+}  // namespace tttext
+}  // namespace ttoffice
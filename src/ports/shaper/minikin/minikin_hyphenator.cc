@@ -0,0 +1,84 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "minikin_hyphenator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "lib/Hyphenator.h"
+#include "src/textlayout/utils/log_util.h"
+
+namespace ttoffice {
+namespace tttext {
+std::shared_ptr<IHyphenator> MinikinHyphenator::GetOrCreate(
+    const std::string& pattern_path, const std::string& locale,
+    size_t min_prefix, size_t min_suffix) {
+  static std::mutex lock;
+  // the prefix and suffix limits are baked into the minikin hyphenator
+  static std::map<std::tuple<std::string, std::string, size_t, size_t>,
+                  std::weak_ptr<IHyphenator>>
+      cache;
+  std::lock_guard<std::mutex> guard(lock);
+  auto& entry = cache[std::make_tuple(pattern_path, locale, min_prefix,
+                                      min_suffix)];
+  if (auto hyphenator = entry.lock()) {
+    return hyphenator;
+  }
+  int fd = open(pattern_path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    LogUtil::E("MinikinHyphenator open pattern failed: %s",
+               pattern_path.c_str());
+    return nullptr;
+  }
+  struct stat st = {};
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    LogUtil::E("MinikinHyphenator map pattern failed: %s",
+               pattern_path.c_str());
+    return nullptr;
+  }
+  std::unique_ptr<minikin::Hyphenator> minikin_hyphenator(
+      minikin::Hyphenator::loadBinary(static_cast<const uint8_t*>(data),
+                                      min_prefix, min_suffix, locale));
+  std::shared_ptr<IHyphenator> hyphenator(new MinikinHyphenator(
+      data, static_cast<size_t>(st.st_size), std::move(minikin_hyphenator)));
+  entry = hyphenator;
+  return hyphenator;
+}
+MinikinHyphenator::MinikinHyphenator(
+    void* data, size_t size, std::unique_ptr<minikin::Hyphenator> hyphenator)
+    : data_(data), size_(size), hyphenator_(std::move(hyphenator)) {}
+MinikinHyphenator::~MinikinHyphenator() {
+  hyphenator_ = nullptr;
+  munmap(data_, size_);
+}
+void MinikinHyphenator::Hyphenate(const char32_t* word, uint32_t length,
+                                  bool* breaks) const {
+  // minikin works on utf-16 code units, only BMP words keep a 1:1 index map
+  std::vector<uint16_t> u16_word(length);
+  for (auto k = 0u; k < length; k++) {
+    if (word[k] > 0xFFFF) return;
+    u16_word[k] = static_cast<uint16_t>(word[k]);
+  }
+  std::vector<minikin::HyphenationType> result;
+  hyphenator_->hyphenate(u16_word, &result);
+  for (auto k = 0u; k < length && k < result.size(); k++) {
+    breaks[k] = result[k] != minikin::HyphenationType::DONT_BREAK;
+  }
+}
+}  // namespace tttext
+}  // namespace ttoffice
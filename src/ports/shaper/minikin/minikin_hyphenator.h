@@ -0,0 +1,59 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_PORTS_SHAPER_MINIKIN_MINIKIN_HYPHENATOR_H_
+#define SRC_PORTS_SHAPER_MINIKIN_MINIKIN_HYPHENATOR_H_
+
+#include <textra/i_hyphenator.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace minikin {
+class Hyphenator;
+}  // namespace minikin
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief IHyphenator backed by minikin's pattern based Hyphenator.
+ *
+ * Pattern files use the minikin binary format (hyph-<locale>.hyb). A file is
+ * memory mapped once per locale and prefix/suffix limits, and shared by every
+ * paragraph using the same ones.
+ */
+class MinikinHyphenator : public IHyphenator {
+ public:
+  /**
+   * @brief Get the hyphenator of a pattern file, locale and limits, mapping
+   * the pattern file on first use.
+   * @param pattern_path path of the .hyb pattern file
+   * @param locale language tag, e.g. "en-us"
+   * @param min_prefix minimal number of chars kept before a hyphen
+   * @param min_suffix minimal number of chars moved after a hyphen
+   * @return nullptr if the pattern file can not be mapped
+   */
+  static std::shared_ptr<IHyphenator> GetOrCreate(
+      const std::string& pattern_path, const std::string& locale,
+      size_t min_prefix = 2, size_t min_suffix = 3);
+  ~MinikinHyphenator() override;
+
+ public:
+  void Hyphenate(const char32_t* word, uint32_t length,
+                 bool* breaks) const override;
+
+ private:
+  MinikinHyphenator(void* data, size_t size,
+                    std::unique_ptr<minikin::Hyphenator> hyphenator);
+
+ private:
+  void* data_;
+  size_t size_;
+  std::unique_ptr<minikin::Hyphenator> hyphenator_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+
+#endif  // SRC_PORTS_SHAPER_MINIKIN_MINIKIN_HYPHENATOR_H_
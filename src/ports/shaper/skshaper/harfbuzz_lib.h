@@ -29,6 +29,7 @@ namespace tttext {
   HB_FUNC(hb_ot_font_set_funcs)                    \
                                                    \
   HB_FUNC(hb_face_create)                          \
+  HB_FUNC(hb_face_create_for_tables)               \
   HB_FUNC(hb_face_set_index)                       \
   HB_FUNC(hb_face_set_upem)                        \
                                                    \
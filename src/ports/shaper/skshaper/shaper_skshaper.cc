@@ -16,6 +16,7 @@ namespace tttext {
 ShaperSkShaper::ShaperSkShaper(FontmgrCollection& font_collection)
     : TTShaper(font_collection) {
   shaper_ = std::make_unique<OneLineShaper>(font_collection_);
+  simple_shaper_ = std::make_unique<SimpleTextShaper>();
 }
 ShaperSkShaper::~ShaperSkShaper() = default;
 
@@ -105,8 +106,29 @@ class ShapingBlockReader : public PlatformShapingResultReader {
   uint32_t text_count_;
 };
 
+bool ShaperSkShaper::ShapeSimpleText(const ShapeKey& key,
+                                     ShapeResult* result) const {
+  const auto& fd = key.style_.GetFontDescriptor();
+  if (key.rtl_ || fd.platform_font_ != 0) {
+    return false;
+  }
+  // OneLineShaper tries the same typeface first and would resolve the whole
+  // run with it
+  auto typefaces = font_collection_.findTypefaces(fd);
+  if (typefaces.empty()) {
+    return false;
+  }
+  return simple_shaper_->Shape(key.text_.c_str(),
+                               static_cast<uint32_t>(key.text_.length()),
+                               typefaces.front(), key.style_.GetFontSize(),
+                               result);
+}
+
 void ShaperSkShaper::OnShapeText(const ShapeKey& key,
                                  ShapeResult* result) const {
+  if (ShapeSimpleText(key, result)) {
+    return;
+  }
   shaper_->shape(key.text_.c_str(), static_cast<uint32_t>(key.text_.length()),
                  key.style_, key.rtl_);
   //  TTASSERT(shaper_->fResolvedBlocks.size() == 1);
@@ -13,6 +13,7 @@
 #include <string>
 
 #include "src/ports/shaper/skshaper/one_line_shaper.h"
+#include "src/ports/shaper/skshaper/simple_text_shaper.h"
 #include "src/textlayout/tt_shaper.h"
 namespace ttoffice {
 namespace tttext {
@@ -29,8 +30,16 @@ class ShaperSkShaper : public TTShaper {
  public:
   void OnShapeText(const ShapeKey& key, ShapeResult* result) const override;
 
+ protected:
+  /**
+   * @brief Shapes the text with the first typeface of the style when the run
+   * is simple, see SimpleTextShaper.
+   */
+  bool ShapeSimpleText(const ShapeKey& key, ShapeResult* result) const;
+
  protected:
   std::unique_ptr<OneLineShaper> shaper_;
+  std::unique_ptr<SimpleTextShaper> simple_shaper_;
 };
 }  // namespace tttext
 }  // namespace ttoffice
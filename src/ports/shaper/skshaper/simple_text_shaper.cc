@@ -0,0 +1,244 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/ports/shaper/skshaper/simple_text_shaper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "src/textlayout/tt_shaper.h"
+
+namespace ttoffice {
+namespace tttext {
+namespace {
+constexpr uint32_t MakeTag(char a, char b, char c, char d) {
+  return (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(b) << 16) |
+         (static_cast<uint32_t>(c) << 8) | static_cast<uint32_t>(d);
+}
+
+// [first, last] ranges of the simple code points, sorted
+constexpr std::pair<Unichar, Unichar> kSimpleRanges[] = {
+    {0x0020, 0x007E},  // Basic Latin
+    {0x00A0, 0x00AC},  // Latin-1 Supplement, soft hyphen excluded
+    {0x00AE, 0x02FF},  // Latin Extended-A/B, IPA, spacing modifiers
+    {0x0370, 0x0377},  // Greek
+    {0x037A, 0x03FF},
+    {0x0400, 0x0482},  // Cyrillic, combining marks excluded
+    {0x048A, 0x052F},
+    {0x1E00, 0x1FFF},  // Latin Extended Additional, Greek Extended
+    {0x2010, 0x2027},  // General Punctuation, format characters excluded
+    {0x2030, 0x205E},
+    {0x20A0, 0x20C0},  // Currency Symbols
+    {0x2100, 0x21FF},  // Letterlike Symbols, Number Forms, Arrows
+    {0x3000, 0x3029},  // CJK Symbols and Punctuation, tone marks excluded
+    {0x3030, 0x303F},
+    {0x3041, 0x3096},  // Hiragana, combining voiced marks excluded
+    {0x309B, 0x30FF},  // Katakana
+    {0x3400, 0x4DBF},  // CJK Unified Ideographs Extension A
+    {0x4E00, 0x9FFF},  // CJK Unified Ideographs
+    {0xAC00, 0xD7A3},  // Hangul Syllables
+    {0xFF01, 0xFFDC},  // Halfwidth and Fullwidth Forms
+};
+
+// GSUB and GPOS features HarfBuzz applies to horizontal text by default that
+// can change the glyphs or the advances of simple code points. The mark
+// features are left out, simple runs have no marks. locl depends on the
+// language HarfBuzz is given and rvrn on the variation coordinates, neither
+// is known here.
+constexpr uint32_t kGsubFeatures[] = {
+    MakeTag('c', 'c', 'm', 'p'), MakeTag('l', 'o', 'c', 'l'),
+    MakeTag('r', 'v', 'r', 'n'), MakeTag('l', 'i', 'g', 'a'),
+    MakeTag('c', 'l', 'i', 'g'), MakeTag('r', 'l', 'i', 'g'),
+    MakeTag('c', 'a', 'l', 't'), MakeTag('r', 'c', 'l', 't'),
+};
+constexpr uint32_t kGposFeatures[] = {
+    MakeTag('k', 'e', 'r', 'n'),
+    MakeTag('d', 'i', 's', 't'),
+    MakeTag('c', 'u', 'r', 's'),
+};
+// legacy kerning and AAT tables HarfBuzz shapes with when present
+constexpr uint32_t kComplexTables[] = {
+    MakeTag('k', 'e', 'r', 'n'), MakeTag('k', 'e', 'r', 'x'),
+    MakeTag('m', 'o', 'r', 'x'), MakeTag('m', 'o', 'r', 't'),
+    MakeTag('t', 'r', 'a', 'k'),
+};
+
+uint16_t ReadU16(const uint8_t* data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+uint32_t ReadU32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+         (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+/**
+ * Same contract as ITypefaceHelper::GetTableData(), served from the sfnt
+ * directory of the font data when the whole font is in memory.
+ */
+size_t ReadTable(const ITypefaceHelper& typeface, uint32_t tag, size_t offset,
+                 size_t length, uint8_t* out) {
+  const auto* data = static_cast<const uint8_t*>(typeface.GetFontData());
+  if (data == nullptr) {
+    return typeface.GetTableData(tag, offset, length, out);
+  }
+  const size_t size = typeface.GetFontDataSize();
+  size_t face_offset = 0;
+  if (size >= 12 && ReadU32(data) == MakeTag('t', 't', 'c', 'f')) {
+    const size_t entry =
+        12 + static_cast<size_t>(std::max(typeface.GetFontIndex(), 0)) * 4;
+    if (entry + 4 > size) {
+      return 0;
+    }
+    face_offset = ReadU32(data + entry);
+  }
+  if (face_offset + 12 > size) {
+    return 0;
+  }
+  const size_t num_tables = ReadU16(data + face_offset + 4);
+  for (size_t k = 0; k < num_tables; k++) {
+    const size_t record = face_offset + 12 + k * 16;
+    if (record + 16 > size) {
+      return 0;
+    }
+    if (ReadU32(data + record) != tag) {
+      continue;
+    }
+    const size_t table_offset = ReadU32(data + record + 8);
+    size_t table_length = ReadU32(data + record + 12);
+    if (table_offset > size) {
+      return 0;
+    }
+    table_length = std::min(table_length, size - table_offset);
+    if (out == nullptr) {
+      return table_length;
+    }
+    if (offset >= table_length) {
+      return 0;
+    }
+    const size_t copied = std::min(length, table_length - offset);
+    std::memcpy(out, data + table_offset + offset, copied);
+    return copied;
+  }
+  return 0;
+}
+
+template <size_t N>
+bool HasAnyFeature(const ITypefaceHelper& typeface, uint32_t table,
+                   const uint32_t (&features)[N]) {
+  uint8_t header[10];
+  if (ReadTable(typeface, table, 0, sizeof(header), header) < sizeof(header)) {
+    return false;
+  }
+  const size_t feature_list = ReadU16(header + 6);
+  uint8_t count[2];
+  if (ReadTable(typeface, table, feature_list, sizeof(count), count) <
+      sizeof(count)) {
+    return false;
+  }
+  std::vector<uint8_t> records(ReadU16(count) * 6u);
+  const size_t read = ReadTable(typeface, table, feature_list + 2,
+                                records.size(), records.data());
+  for (size_t k = 0; k + 6 <= read; k += 6) {
+    const auto tag = ReadU32(records.data() + k);
+    if (std::find(std::begin(features), std::end(features), tag) !=
+        std::end(features)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+class SimpleRunReader : public PlatformShapingResultReader {
+ public:
+  SimpleRunReader(const std::vector<GlyphID>& glyphs,
+                  const std::vector<float>& advances, TypefaceRef typeface)
+      : glyphs_(glyphs), advances_(advances), typeface_(std::move(typeface)) {}
+
+ public:
+  uint32_t GlyphCount() const override {
+    return static_cast<uint32_t>(glyphs_.size());
+  }
+  uint32_t TextCount() const override {
+    return static_cast<uint32_t>(glyphs_.size());
+  }
+  GlyphID ReadGlyphID(uint32_t idx) const override { return glyphs_[idx]; }
+  float ReadAdvanceX(uint32_t idx) const override { return advances_[idx]; }
+  uint32_t ReadIndices(uint32_t idx) const override { return idx; }
+  TypefaceRef ReadFontId(uint32_t idx) const override { return typeface_; }
+
+ private:
+  const std::vector<GlyphID>& glyphs_;
+  const std::vector<float>& advances_;
+  TypefaceRef typeface_;
+};
+}  // namespace
+
+bool SimpleTextShaper::IsSimpleCodePoint(Unichar code_point) {
+  auto iter = std::upper_bound(
+      std::begin(kSimpleRanges), std::end(kSimpleRanges), code_point,
+      [](Unichar cp, const std::pair<Unichar, Unichar>& range) {
+        return cp < range.first;
+      });
+  return iter != std::begin(kSimpleRanges) && code_point <= (--iter)->second;
+}
+
+bool SimpleTextShaper::IsSimpleTypeface(const ITypefaceHelper& typeface) {
+  auto found = simple_typefaces_.find(typeface.GetUniqueId());
+  if (found != simple_typefaces_.end()) {
+    return found->second;
+  }
+  // A typeface whose tables can't be read is simple: HarfBuzz gets no tables
+  // from it either and maps it one to one.
+  bool simple =
+      !HasAnyFeature(typeface, MakeTag('G', 'S', 'U', 'B'), kGsubFeatures) &&
+      !HasAnyFeature(typeface, MakeTag('G', 'P', 'O', 'S'), kGposFeatures);
+  for (auto tag : kComplexTables) {
+    if (!simple) break;
+    simple = ReadTable(typeface, tag, 0, 0, nullptr) == 0;
+  }
+  simple_typefaces_[typeface.GetUniqueId()] = simple;
+  return simple;
+}
+
+bool SimpleTextShaper::Shape(const char32_t* text, uint32_t length,
+                             const TypefaceRef& typeface, float font_size,
+                             ShapeResult* result) {
+  static_assert(sizeof(char32_t) == sizeof(Unichar), "");
+  if (length == 0 || typeface == nullptr) {
+    return false;
+  }
+  for (uint32_t k = 0; k < length; k++) {
+    if (!IsSimpleCodePoint(text[k])) {
+      return false;
+    }
+  }
+  if (!IsSimpleTypeface(*typeface)) {
+    return false;
+  }
+  glyphs_.resize(length);
+  typeface->UnicharsToGlyphs(reinterpret_cast<const Unichar*>(text), length,
+                             glyphs_.data());
+  if (std::find(glyphs_.begin(), glyphs_.end(), 0) != glyphs_.end()) {
+    // needs a fallback font
+    return false;
+  }
+  advances_.resize(length);
+  typeface->GetHorizontalAdvances(glyphs_.data(), length, advances_.data(),
+                                  font_size);
+  // round to the 16.16 positions HarfBuzz works with, so that both paths
+  // measure a run the same
+  constexpr float kHbPosition1 = 1 << 16;
+  for (auto& advance : advances_) {
+    advance = std::floor(advance * kHbPosition1 + 0.5f) / kHbPosition1;
+  }
+  const SimpleRunReader reader(glyphs_, advances_, typeface);
+  result->AppendPlatformShapingResult(reader);
+  return true;
+}
+}  // namespace tttext
+}  // namespace ttoffice
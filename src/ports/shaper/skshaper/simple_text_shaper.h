@@ -0,0 +1,60 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_PORTS_SHAPER_SKSHAPER_SIMPLE_TEXT_SHAPER_H_
+#define SRC_PORTS_SHAPER_SKSHAPER_SIMPLE_TEXT_SHAPER_H_
+
+#include <textra/i_typeface_helper.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+class ShapeResult;
+/**
+ * @brief Shapes runs that HarfBuzz would map one character to one glyph
+ * without moving anything, by reading the cmap and the advances of the
+ * typeface directly.
+ *
+ * A run is simple when all of its characters belong to scripts without
+ * complex shaping, the typeface maps every one of them and the typeface has
+ * none of the substitution or positioning features HarfBuzz enables by
+ * default. The glyphs and advances are then the ones HarfBuzz would produce,
+ * the caller shapes the other runs as usual.
+ */
+class SimpleTextShaper {
+ public:
+  SimpleTextShaper() = default;
+  SimpleTextShaper(const SimpleTextShaper&) = delete;
+  SimpleTextShaper& operator=(const SimpleTextShaper&) = delete;
+
+ public:
+  /**
+   * @brief Characters of the Latin, Greek, Cyrillic, CJK, kana and Hangul
+   * syllable blocks, combining marks, controls and format characters excluded.
+   */
+  static bool IsSimpleCodePoint(Unichar code_point);
+  /**
+   * @brief Whether the typeface has no ligature, contextual, kerning or AAT
+   * lookups, the answer is cached by the unique id of the typeface.
+   */
+  bool IsSimpleTypeface(const ITypefaceHelper& typeface);
+  /**
+   * @brief Appends a 1:1 char to glyph result of the text to result.
+   * @return false if the run is not simple, result is not modified
+   */
+  bool Shape(const char32_t* text, uint32_t length, const TypefaceRef& typeface,
+             float font_size, ShapeResult* result);
+  void ClearCache() { simple_typefaces_.clear(); }
+
+ private:
+  std::unordered_map<uint32_t, bool> simple_typefaces_;
+  std::vector<GlyphID> glyphs_;
+  std::vector<float> advances_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // SRC_PORTS_SHAPER_SKSHAPER_SIMPLE_TEXT_SHAPER_H_
@@ -8,6 +8,8 @@
 #include <hb-ot.h>
 #include <hb.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <locale>
 #include <mutex>
 #include <vector>
@@ -302,32 +304,37 @@ hb_font_funcs_t* skhb_get_font_funcs() {
   return funcs;
 }
 
-// hb_blob_t* skhb_get_table(hb_face_t* face, hb_tag_t tag, void* user_data) {
-//   ITypefaceHelper& typeface = *reinterpret_cast<ITypefaceHelper*>(user_data);
-//
-//   auto data = typeface.copyTableData(tag);
-//   if (!data) {
-//     return nullptr;
-//   }
-//   SkData* rawData = data.release();
-//   return hb_blob_create(reinterpret_cast<char*>(rawData->writable_data()),
-//                         rawData->size(), HB_MEMORY_MODE_READONLY, rawData,
-//                         [](void* ctx) { SkSafeUnref(((SkData*)ctx)); });
-// }
+hb_blob_t* skhb_get_table(hb_face_t* face, hb_tag_t tag, void* user_data) {
+  const auto& typeface = *reinterpret_cast<TypefaceRef*>(user_data);
+  // tag 0 asks for the whole font, which is not in memory
+  if (tag == 0) {
+    return nullptr;
+  }
+  const auto size = typeface->GetTableData(tag, 0, 0, nullptr);
+  if (size == 0) {
+    return nullptr;
+  }
+  auto* data = static_cast<char*>(malloc(size));
+  if (data == nullptr) {
+    return nullptr;
+  }
+  const auto copied = typeface->GetTableData(tag, 0, size, data);
+  return tt_hb_blob_create(data, static_cast<uint32_t>(copied),
+                           HB_MEMORY_MODE_WRITABLE, data, free);
+}
 
 HBBlob stream_to_blob(const TypefaceRef typeface) {
   size_t size = typeface->GetFontDataSize();
   HBBlob blob;
   if (const void* base = typeface->GetFontData()) {
+    // the blob keeps the typeface owning the data alive, a cached HBFace may
+    // be shared by other typefaces of the same font and outlive this one
     blob.reset(tt_hb_blob_create((const char*)base, static_cast<uint32_t>(size),
-                                 HB_MEMORY_MODE_READONLY, nullptr, nullptr));
-  } else {
-    TTASSERT(false);
-    // SkDebugf("Extra SkStreamAsset copy\n");
-    //    void* ptr = size ? sk_malloc_throw(size) : nullptr;
-    //    asset->read(ptr, size);
-    //    blob.reset(hb_blob_create((char*)ptr, SkToUInt(size),
-    //                              HB_MEMORY_MODE_READONLY, ptr, sk_free));
+                                 HB_MEMORY_MODE_READONLY,
+                                 new TypefaceRef(typeface), [](void* user_data) {
+                                   delete reinterpret_cast<TypefaceRef*>(
+                                       user_data);
+                                 }));
   }
   TTASSERT(blob);
   tt_hb_blob_make_immutable(blob.get());
@@ -337,24 +344,18 @@ HBBlob stream_to_blob(const TypefaceRef typeface) {
 // SkDEBUGCODE(static hb_user_data_key_t gDataIdKey;)
 
 HBFace create_hb_face(const TypefaceRef typeface) {
-  int index = 0;
+  int index = typeface->GetFontIndex();
   HBFace face;
   if (typeface->GetFontData() != nullptr) {
     HBBlob blob(stream_to_blob(typeface));
     face.reset(tt_hb_face_create(blob.get(), (unsigned)index));
+  } else {
+    // tables are read one by one when harfbuzz first needs them
+    face.reset(tt_hb_face_create_for_tables(
+        skhb_get_table, new TypefaceRef(typeface), [](void* user_data) {
+          delete reinterpret_cast<TypefaceRef*>(user_data);
+        }));
   }
-  //  std::unique_ptr<SkStreamAsset> typefaceAsset =
-  //  typeface.openStream(&index); if (typefaceAsset &&
-  //  typefaceAsset->getMemoryBase()) {
-  //    HBBlob blob(stream_to_blob(std::move(typefaceAsset)));
-  //    face.reset(hb_face_create(blob.get(), (unsigned)index));
-  //  } else {
-  //    face.reset(hb_face_create_for_tables(
-  //        skhb_get_table, static_cast<void*>(typeface.get()),
-  //        [](void* user_data) {
-  ////          reinterpret_cast<ITypefaceHelper*>(user_data);
-  //        }));
-  //  }
   TTASSERT(face);
   if (!face) {
     return nullptr;
@@ -369,6 +370,58 @@ HBFace create_hb_face(const TypefaceRef typeface) {
   return face;
 }
 
+using FontDataId = uint64_t;
+constexpr FontDataId kTypefaceIdFlag = 1ull << 63;
+
+uint32_t read_u32_be(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+         (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+void fnv1a(FontDataId* hash, const uint8_t* data, size_t size) {
+  for (size_t k = 0; k < size; k++) {
+    *hash = (*hash ^ data[k]) * 0x100000001B3ull;
+  }
+}
+
+/**
+ * Identifies the font data of a typeface by its content, so that the
+ * typefaces different font managers create for the same font file share one
+ * HBFace. The sfnt table directory of the face holds the checksum, offset and
+ * length of every table, hashing it with the data size is cheap and tells
+ * fonts apart. Typefaces without data in memory are identified by their
+ * unique id.
+ */
+FontDataId get_font_data_id(const TypefaceRef& typeface) {
+  const auto* data = static_cast<const uint8_t*>(typeface->GetFontData());
+  const size_t size = typeface->GetFontDataSize();
+  if (data == nullptr || size < 12) {
+    return kTypefaceIdFlag | typeface->GetUniqueId();
+  }
+  const auto index = static_cast<uint32_t>(typeface->GetFontIndex());
+  size_t face_offset = 0;
+  if (read_u32_be(data) == 0x74746366) {  // 'ttcf'
+    const size_t entry = 12 + static_cast<size_t>(index) * 4;
+    face_offset = entry + 4 <= size ? read_u32_be(data + entry) : size;
+  }
+  size_t directory_size = 0;
+  if (face_offset + 12 <= size) {
+    const size_t num_tables =
+        (data[face_offset + 4] << 8) | data[face_offset + 5];
+    directory_size = std::min(12 + num_tables * 16, size - face_offset);
+  } else {
+    // not an sfnt, hash what fits in a directory
+    face_offset = 0;
+    directory_size = std::min<size_t>(size, 4096);
+  }
+  FontDataId hash = 0xCBF29CE484222325ull;
+  const uint64_t header[2] = {size, index};
+  fnv1a(&hash, reinterpret_cast<const uint8_t*>(header), sizeof(header));
+  fnv1a(&hash, data + face_offset, directory_size);
+  return hash & ~kTypefaceIdFlag;
+}
+
 HBFont create_hb_font(const Font& font, const HBFace& face) {
   //  SkDEBUGCODE(void* dataId = hb_face_get_user_data(face.get(), &gDataIdKey);
   //              TTASSERT(dataId == font.getTypeface());)
@@ -582,11 +635,11 @@ void ShapeDontWrapOrReorder::wrap(const char32_t* const utf8, size_t utf8Bytes,
   handler->commitLine();
 }
 
-using SkFontID = uint32_t;
 using Mutex = std::mutex;
 class HBLockedFaceCache {
  public:
-  HBLockedFaceCache(android::LruCache<SkFontID, HBFace>* lruCache, Mutex* mutex)
+  HBLockedFaceCache(android::LruCache<FontDataId, HBFace>* lruCache,
+                    Mutex* mutex)
       : fLRUCache(lruCache), fMutex(mutex) {
     fMutex->lock();
   }
@@ -597,19 +650,19 @@ class HBLockedFaceCache {
 
   ~HBLockedFaceCache() { fMutex->unlock(); }
 
-  HBFace* find(SkFontID fontId) { return fLRUCache->get(fontId); }
-  HBFace* insert(SkFontID fontId, HBFace hbFace) {
-    return fLRUCache->put(fontId, std::move(hbFace));
+  HBFace* find(FontDataId dataId) { return fLRUCache->get(dataId); }
+  HBFace* insert(FontDataId dataId, HBFace hbFace) {
+    return fLRUCache->put(dataId, std::move(hbFace));
   }
   void reset() { fLRUCache->clear(); }
 
  private:
-  android::LruCache<SkFontID, HBFace>* fLRUCache;
+  android::LruCache<FontDataId, HBFace>* fLRUCache;
   Mutex* fMutex;
 };
 static HBLockedFaceCache get_hbFace_cache() {
   static Mutex gHBFaceCacheMutex;
-  static android::LruCache<SkFontID, HBFace> gHBFaceCache(100);
+  static android::LruCache<FontDataId, HBFace> gHBFaceCache(100);
   return HBLockedFaceCache(&gHBFaceCache, &gHBFaceCacheMutex);
 }
 
@@ -670,15 +723,15 @@ ShapedRun ShaperHarfBuzz::shape(
   tt_hb_buffer_set_language(buffer, hbLanguage);
   tt_hb_buffer_guess_segment_properties(buffer);
 
-  // TODO(hfuttyh): better cache HBFace (data) / hbfont (typeface)
   // An HBFace is expensive (it sanitizes the bits).
   // An HBFont is fairly inexpensive.
-  // An HBFace is actually tied to the data, not the typeface.
+  // An HBFace is tied to the data, not the typeface, it is cached by the
+  // content of the data and shared by the typefaces of the same font.
   // The size of 100 here is completely arbitrary and used to match libtxt.
   HBFont hbFont;
   {
+    const auto dataId = get_font_data_id(font.currentFont().GetTypeface());
     HBLockedFaceCache cache = get_hbFace_cache();
-    SkFontID dataId = font.currentFont().GetTypeface()->GetUniqueId();
     HBFace* hbFaceCached = cache.find(dataId);
     if (!hbFaceCached) {
       HBFace hbFace(create_hb_face(font.currentFont().GetTypeface()));
@@ -0,0 +1,410 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <textra/flat_layout_result.h>
+#include <textra/i_typeface_helper.h>
+#include <textra/layout_drawer.h>
+#include <textra/layout_region.h>
+#include <textra/recording_canvas_helper.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/textlayout/utils/little_endian.h"
+
+namespace ttoffice {
+namespace tttext {
+namespace {
+constexpr char kMagic[4] = {'T', 'T', 'F', 'L'};
+constexpr uint8_t kVersion = 1;
+// encoded size of the header and of each record, see Serialize()
+constexpr uint64_t kHeaderSize = sizeof(kMagic) + 1 + 2 * 4 + 6 * 4;
+constexpr uint64_t kLineSize = 9 * 4;
+constexpr uint64_t kOpSize = 1 + 4 + 5 * 4 + 4 * 4;
+constexpr uint64_t kPaintSize = 8 * 4 + 6;
+constexpr uint64_t kShadowSize = 4 * 4;
+constexpr uint64_t kGlyphSize = 2 + 2 * 4;
+
+bool InRange(uint64_t start, uint64_t count, uint64_t size) {
+  return start <= size && count <= size - start;
+}
+}  // namespace
+
+FlatLayoutResult::FlatLayoutResult() = default;
+FlatLayoutResult::~FlatLayoutResult() = default;
+
+std::unique_ptr<FlatLayoutResult> FlatLayoutResult::Create(
+    LayoutRegion* region, LayoutDrawerListener* listener) {
+  TTASSERT(region != nullptr);
+  RecordingCanvasHelper recorder;
+  LayoutDrawer drawer(&recorder);
+  if (listener != nullptr) drawer.SetListener(listener);
+  auto line_count = region->GetLineCount();
+  std::vector<Line> lines;
+  lines.reserve(line_count);
+  region->VisitLines(0, line_count, [&](uint32_t, TextLine* line) {
+    Line record{};
+    record.top_ = line->GetLineTop();
+    record.height_ = line->GetLineHeight();
+    record.baseline_ = line->GetLineBaseLine();
+    record.left_ = line->GetLineLeft();
+    record.right_ = line->GetLineRight();
+    record.start_char_ = line->GetStartCharPos();
+    record.end_char_ = line->GetEndCharPos();
+    record.op_start_ = recorder.GetOpCount();
+    drawer.DrawTextLine(line, 0, line->GetCharCount());
+    record.op_end_ = recorder.GetOpCount();
+    lines.push_back(record);
+    return true;
+  });
+  auto result = recorder.FinishRecording();
+  result->width_ = region->GetPageWidth();
+  result->height_ = region->GetLayoutedHeight();
+  result->lines_ = std::move(lines);
+  return result;
+}
+
+std::string FlatLayoutResult::Serialize() const {
+  std::string data;
+  data.reserve(kHeaderSize + lines_.size() * kLineSize + ops_.size() * kOpSize +
+               paints_.size() * kPaintSize + shadows_.size() * kShadowSize +
+               glyphs_.size() * kGlyphSize + string_pool_.size());
+  data.append(kMagic, sizeof(kMagic));
+  data.push_back(static_cast<char>(kVersion));
+  little_endian::Append(&data, width_);
+  little_endian::Append(&data, height_);
+  little_endian::Append(&data, static_cast<uint32_t>(lines_.size()));
+  little_endian::Append(&data, static_cast<uint32_t>(ops_.size()));
+  little_endian::Append(&data, static_cast<uint32_t>(paints_.size()));
+  little_endian::Append(&data, static_cast<uint32_t>(shadows_.size()));
+  little_endian::Append(&data, static_cast<uint32_t>(glyphs_.size()));
+  little_endian::Append(&data, static_cast<uint32_t>(string_pool_.size()));
+  for (const auto& line : lines_) {
+    little_endian::Append(&data, line.top_);
+    little_endian::Append(&data, line.height_);
+    little_endian::Append(&data, line.baseline_);
+    little_endian::Append(&data, line.left_);
+    little_endian::Append(&data, line.right_);
+    little_endian::Append(&data, line.start_char_);
+    little_endian::Append(&data, line.end_char_);
+    little_endian::Append(&data, line.op_start_);
+    little_endian::Append(&data, line.op_end_);
+  }
+  for (const auto& op : ops_) {
+    little_endian::Append(&data, op.op_);
+    little_endian::Append(&data, op.paint_idx_);
+    for (auto value : op.values_) little_endian::Append(&data, value);
+    little_endian::Append(&data, op.typeface_id_);
+    little_endian::Append(&data, op.data_start_);
+    little_endian::Append(&data, op.data_count_);
+    little_endian::Append(&data, op.flags_);
+  }
+  for (const auto& paint : paints_) {
+    little_endian::Append(&data, paint.color_);
+    little_endian::Append(&data, paint.stroke_width_);
+    little_endian::Append(&data, paint.stroke_miter_);
+    little_endian::Append(&data, paint.text_size_);
+    little_endian::Append(&data, paint.font_family_start_);
+    little_endian::Append(&data, paint.font_family_length_);
+    little_endian::Append(&data, paint.shadow_start_);
+    little_endian::Append(&data, paint.shadow_count_);
+    little_endian::Append(&data, paint.fill_style_);
+    little_endian::Append(&data, paint.cap_);
+    little_endian::Append(&data, paint.join_);
+    little_endian::Append(&data, paint.bold_);
+    little_endian::Append(&data, paint.italic_);
+    little_endian::Append(&data, paint.under_line_);
+  }
+  for (const auto& shadow : shadows_) {
+    little_endian::Append(&data, shadow.color_);
+    little_endian::Append(&data, shadow.offset_x_);
+    little_endian::Append(&data, shadow.offset_y_);
+    little_endian::Append(&data, shadow.blur_radius_);
+  }
+  for (auto glyph : glyphs_) little_endian::Append(&data, glyph);
+  for (auto x : pos_x_) little_endian::Append(&data, x);
+  for (auto y : pos_y_) little_endian::Append(&data, y);
+  data.append(string_pool_);
+  return data;
+}
+
+std::unique_ptr<FlatLayoutResult> FlatLayoutResult::Deserialize(
+    const uint8_t* data, size_t size) {
+  if (data == nullptr || size < kHeaderSize ||
+      !std::equal(kMagic, kMagic + sizeof(kMagic), data) ||
+      data[sizeof(kMagic)] != kVersion) {
+    return nullptr;
+  }
+  auto result = std::make_unique<FlatLayoutResult>();
+  size_t offset = sizeof(kMagic) + 1;
+  result->width_ = little_endian::Read<float>(data, &offset);
+  result->height_ = little_endian::Read<float>(data, &offset);
+  uint64_t line_count = little_endian::Read<uint32_t>(data, &offset);
+  uint64_t op_count = little_endian::Read<uint32_t>(data, &offset);
+  uint64_t paint_count = little_endian::Read<uint32_t>(data, &offset);
+  uint64_t shadow_count = little_endian::Read<uint32_t>(data, &offset);
+  uint64_t glyph_count = little_endian::Read<uint32_t>(data, &offset);
+  uint64_t string_size = little_endian::Read<uint32_t>(data, &offset);
+  if (size != kHeaderSize + line_count * kLineSize + op_count * kOpSize +
+                  paint_count * kPaintSize + shadow_count * kShadowSize +
+                  glyph_count * kGlyphSize + string_size) {
+    return nullptr;
+  }
+
+  result->lines_.resize(line_count);
+  for (auto& line : result->lines_) {
+    line.top_ = little_endian::Read<float>(data, &offset);
+    line.height_ = little_endian::Read<float>(data, &offset);
+    line.baseline_ = little_endian::Read<float>(data, &offset);
+    line.left_ = little_endian::Read<float>(data, &offset);
+    line.right_ = little_endian::Read<float>(data, &offset);
+    line.start_char_ = little_endian::Read<uint32_t>(data, &offset);
+    line.end_char_ = little_endian::Read<uint32_t>(data, &offset);
+    line.op_start_ = little_endian::Read<uint32_t>(data, &offset);
+    line.op_end_ = little_endian::Read<uint32_t>(data, &offset);
+  }
+  result->ops_.resize(op_count);
+  for (auto& op : result->ops_) {
+    op.op_ = little_endian::Read<CanvasOp>(data, &offset);
+    op.paint_idx_ = little_endian::Read<uint32_t>(data, &offset);
+    for (auto& value : op.values_) {
+      value = little_endian::Read<float>(data, &offset);
+    }
+    op.typeface_id_ = little_endian::Read<uint32_t>(data, &offset);
+    op.data_start_ = little_endian::Read<uint32_t>(data, &offset);
+    op.data_count_ = little_endian::Read<uint32_t>(data, &offset);
+    op.flags_ = little_endian::Read<uint32_t>(data, &offset);
+  }
+  result->paints_.resize(paint_count);
+  for (auto& paint : result->paints_) {
+    paint.color_ = little_endian::Read<uint32_t>(data, &offset);
+    paint.stroke_width_ = little_endian::Read<float>(data, &offset);
+    paint.stroke_miter_ = little_endian::Read<float>(data, &offset);
+    paint.text_size_ = little_endian::Read<float>(data, &offset);
+    paint.font_family_start_ = little_endian::Read<uint32_t>(data, &offset);
+    paint.font_family_length_ = little_endian::Read<uint32_t>(data, &offset);
+    paint.shadow_start_ = little_endian::Read<uint32_t>(data, &offset);
+    paint.shadow_count_ = little_endian::Read<uint32_t>(data, &offset);
+    paint.fill_style_ = little_endian::Read<FillStyle>(data, &offset);
+    paint.cap_ = little_endian::Read<Cap>(data, &offset);
+    paint.join_ = little_endian::Read<Join>(data, &offset);
+    paint.bold_ = little_endian::Read<uint8_t>(data, &offset) != 0;
+    paint.italic_ = little_endian::Read<uint8_t>(data, &offset) != 0;
+    paint.under_line_ = little_endian::Read<uint8_t>(data, &offset) != 0;
+  }
+  result->shadows_.resize(shadow_count);
+  for (auto& shadow : result->shadows_) {
+    shadow.color_ = little_endian::Read<uint32_t>(data, &offset);
+    shadow.offset_x_ = little_endian::Read<float>(data, &offset);
+    shadow.offset_y_ = little_endian::Read<float>(data, &offset);
+    shadow.blur_radius_ = little_endian::Read<float>(data, &offset);
+  }
+  result->glyphs_.resize(glyph_count);
+  for (auto& glyph : result->glyphs_) {
+    glyph = little_endian::Read<uint16_t>(data, &offset);
+  }
+  result->pos_x_.resize(glyph_count);
+  for (auto& x : result->pos_x_) x = little_endian::Read<float>(data, &offset);
+  result->pos_y_.resize(glyph_count);
+  for (auto& y : result->pos_y_) y = little_endian::Read<float>(data, &offset);
+  result->string_pool_.assign(reinterpret_cast<const char*>(data + offset),
+                              string_size);
+  if (!result->IsValid()) return nullptr;
+  return result;
+}
+
+bool FlatLayoutResult::IsValid() const {
+  for (const auto& line : lines_) {
+    if (line.op_start_ > line.op_end_ || line.op_end_ > ops_.size()) {
+      return false;
+    }
+  }
+  for (const auto& paint : paints_) {
+    if (!InRange(paint.font_family_start_, paint.font_family_length_,
+                 string_pool_.size()) ||
+        !InRange(paint.shadow_start_, paint.shadow_count_, shadows_.size())) {
+      return false;
+    }
+  }
+  for (const auto& op : ops_) {
+    if (op.paint_idx_ != kNoPaint && op.paint_idx_ >= paints_.size()) {
+      return false;
+    }
+    switch (op.op_) {
+      case CanvasOp::kDrawGlyphs:
+        if (!InRange(op.data_start_, op.data_count_, glyphs_.size())) {
+          return false;
+        }
+        break;
+      case CanvasOp::kDrawText:
+      case CanvasOp::kDrawImage:
+        if (!InRange(op.data_start_, op.data_count_, string_pool_.size())) {
+          return false;
+        }
+        break;
+      case CanvasOp::kSave:
+      case CanvasOp::kRestore:
+      case CanvasOp::kTranslate:
+      case CanvasOp::kScale:
+      case CanvasOp::kRotate:
+      case CanvasOp::kSkew:
+      case CanvasOp::kClipRect:
+      case CanvasOp::kFillRect:
+      case CanvasOp::kDrawLine:
+      case CanvasOp::kDrawRect:
+      case CanvasOp::kDrawOval:
+      case CanvasOp::kDrawCircle:
+      case CanvasOp::kDrawRoundRect:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+const ITypefaceHelper* FlatLayoutResult::GetTypeface(
+    uint32_t typeface_id) const {
+  auto iter = typefaces_.find(typeface_id);
+  return iter == typefaces_.end() ? nullptr : iter->second.get();
+}
+
+void FlatLayoutResult::Draw(ICanvasHelper* canvas,
+                            const TypefaceResolver& resolver) const {
+  if (canvas == nullptr) return;
+  PainterList painters(paints_.size());
+  for (const auto& op : ops_) {
+    DrawOp(canvas, op, resolver, &painters);
+  }
+}
+
+void FlatLayoutResult::DrawLines(ICanvasHelper* canvas, uint32_t start_line,
+                                 uint32_t end_line,
+                                 const TypefaceResolver& resolver) const {
+  if (canvas == nullptr) return;
+  end_line = std::min(end_line, GetLineCount());
+  PainterList painters(paints_.size());
+  for (auto idx = start_line; idx < end_line; idx++) {
+    const auto& line = lines_[idx];
+    for (auto k = line.op_start_; k < line.op_end_; k++) {
+      DrawOp(canvas, ops_[k], resolver, &painters);
+    }
+  }
+}
+
+void FlatLayoutResult::ApplyPaint(uint32_t paint_idx, Painter* painter) const {
+  const auto& paint = paints_[paint_idx];
+  painter->SetColor(paint.color_);
+  painter->SetStrokeWidth(paint.stroke_width_);
+  painter->SetStrokeMiter(paint.stroke_miter_);
+  painter->SetTextSize(paint.text_size_);
+  painter->SetFontFamily(
+      GetString(paint.font_family_start_, paint.font_family_length_));
+  painter->SetFillStyle(paint.fill_style_);
+  painter->SetCap(paint.cap_);
+  painter->SetJoin(paint.join_);
+  painter->SetBold(paint.bold_);
+  painter->SetItalic(paint.italic_);
+  painter->SetUnderLine(paint.under_line_);
+  if (paint.shadow_count_ > 0) {
+    std::vector<TextShadow> shadow_list(paint.shadow_count_);
+    for (auto k = 0u; k < paint.shadow_count_; k++) {
+      const auto& shadow = shadows_[paint.shadow_start_ + k];
+      shadow_list[k].color_ = TTColor(shadow.color_);
+      shadow_list[k].offset_[0] = shadow.offset_x_;
+      shadow_list[k].offset_[1] = shadow.offset_y_;
+      shadow_list[k].blur_radius_ = shadow.blur_radius_;
+    }
+    painter->SetShadowList(shadow_list);
+  }
+}
+
+void FlatLayoutResult::DrawOp(ICanvasHelper* canvas, const Op& op,
+                              const TypefaceResolver& resolver,
+                              PainterList* painters) const {
+  Painter* p = nullptr;
+  if (op.paint_idx_ != kNoPaint) {
+    auto& painter = (*painters)[op.paint_idx_];
+    if (painter == nullptr) {
+      painter = canvas->CreatePainter();
+      ApplyPaint(op.paint_idx_, painter.get());
+    }
+    p = painter.get();
+  }
+  const auto* v = op.values_;
+  auto typeface = [this, &op, &resolver]() {
+    return resolver ? resolver(op.typeface_id_) : GetTypeface(op.typeface_id_);
+  };
+  switch (op.op_) {
+    case CanvasOp::kSave:
+      canvas->Save();
+      break;
+    case CanvasOp::kRestore:
+      canvas->Restore();
+      break;
+    case CanvasOp::kTranslate:
+      canvas->Translate(v[0], v[1]);
+      break;
+    case CanvasOp::kScale:
+      canvas->Scale(v[0], v[1]);
+      break;
+    case CanvasOp::kRotate:
+      canvas->Rotate(v[0]);
+      break;
+    case CanvasOp::kSkew:
+      canvas->Skew(v[0], v[1]);
+      break;
+    case CanvasOp::kClipRect:
+      canvas->ClipRect(v[0], v[1], v[2], v[3], op.flags_ != 0);
+      break;
+    case CanvasOp::kFillRect:
+      canvas->FillRect(v[0], v[1], v[2], v[3], op.flags_);
+      break;
+    case CanvasOp::kDrawLine:
+      canvas->DrawLine(v[0], v[1], v[2], v[3], p);
+      break;
+    case CanvasOp::kDrawRect:
+      canvas->DrawRect(v[0], v[1], v[2], v[3], p);
+      break;
+    case CanvasOp::kDrawOval:
+      canvas->DrawOval(v[0], v[1], v[2], v[3], p);
+      break;
+    case CanvasOp::kDrawCircle:
+      canvas->DrawCircle(v[0], v[1], v[2], p);
+      break;
+    case CanvasOp::kDrawRoundRect:
+      canvas->DrawRoundRect(v[0], v[1], v[2], v[3], v[4], p);
+      break;
+    case CanvasOp::kDrawText: {
+      const auto* font = typeface();
+      if (font == nullptr) break;
+      canvas->DrawText(font, string_pool_.data() + op.data_start_,
+                       op.data_count_, v[0], v[1], p);
+      break;
+    }
+    case CanvasOp::kDrawGlyphs: {
+      const auto* font = typeface();
+      if (font == nullptr) break;
+      // canvases only read the positions
+      canvas->DrawGlyphs(font, op.data_count_, glyphs_.data() + op.data_start_,
+                         nullptr, op.flags_, v[0], v[1],
+                         const_cast<float*>(pos_x_.data()) + op.data_start_,
+                         const_cast<float*>(pos_y_.data()) + op.data_start_,
+                         p);
+      break;
+    }
+    case CanvasOp::kDrawImage: {
+      auto src = GetString(op.data_start_, op.data_count_);
+      canvas->DrawImage(src.c_str(), v[0], v[1], v[2], v[3], p);
+      break;
+    }
+    default:
+      break;
+  }
+}
+}  // namespace tttext
+}  // namespace ttoffice
@@ -0,0 +1,54 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/textlayout/internal/bidi_run_table.h"
+
+#include <algorithm>
+
+namespace ttoffice {
+namespace tttext {
+void BidiRunTable::Build(const uint8_t* levels, uint32_t char_count) {
+  runs_.clear();
+  if (char_count == 0) return;
+  auto start = 0u;
+  for (auto k = 1u; k <= char_count; k++) {
+    if (k == char_count || levels[k] != levels[start]) {
+      runs_.push_back({start, k, levels[start]});
+      start = k;
+    }
+  }
+}
+uint32_t BidiRunTable::FindRunIndex(uint32_t char_pos) const {
+  TTASSERT(!runs_.empty());
+  auto iter = std::upper_bound(
+      runs_.begin(), runs_.end(), char_pos,
+      [](uint32_t pos, const BidiRun& run) { return pos < run.end_; });
+  if (iter == runs_.end()) return GetRunCount() - 1;
+  return static_cast<uint32_t>(iter - runs_.begin());
+}
+void BidiRunTable::ReorderByLevels(const uint8_t* levels, uint32_t count,
+                                   uint32_t* visual_order) {
+  uint8_t max_level = 0;
+  uint8_t min_odd_level = 0xFF;
+  for (auto k = 0u; k < count; k++) {
+    visual_order[k] = k;
+    max_level = std::max(max_level, levels[k]);
+    if (levels[k] % 2 == 1) min_odd_level = std::min(min_odd_level, levels[k]);
+  }
+  for (auto level = max_level; level >= min_odd_level && level > 0; level--) {
+    auto k = 0u;
+    while (k < count) {
+      if (levels[visual_order[k]] < level) {
+        k++;
+        continue;
+      }
+      auto end = k + 1;
+      while (end < count && levels[visual_order[end]] >= level) end++;
+      std::reverse(visual_order + k, visual_order + end);
+      k = end;
+    }
+  }
+}
+}  // namespace tttext
+}  // namespace ttoffice
@@ -0,0 +1,73 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_TEXTLAYOUT_INTERNAL_BIDI_RUN_TABLE_H_
+#define SRC_TEXTLAYOUT_INTERNAL_BIDI_RUN_TABLE_H_
+#include <textra/macro.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief Run-length encoded bidi information of a paragraph.
+ *
+ * Instead of keeping one level and two map entries per character, the
+ * paragraph is stored as a sorted list of level runs, so the level of any
+ * character can be answered with a binary search over the runs. Visual order
+ * is resolved per line with ReorderByLevels().
+ */
+class BidiRunTable {
+ public:
+  struct BidiRun {
+    uint32_t start_;
+    uint32_t end_;
+    uint8_t level_;
+  };
+
+ public:
+  BidiRunTable() = default;
+
+ public:
+  /**
+   * @brief Build the run table from per character embedding levels.
+   * @param levels embedding level of each character, even: ltr, odd: rtl
+   * @param char_count
+   */
+  void Build(const uint8_t* levels, uint32_t char_count);
+  void Clear() { runs_.clear(); }
+  bool Empty() const { return runs_.empty(); }
+  uint32_t GetRunCount() const { return static_cast<uint32_t>(runs_.size()); }
+  const BidiRun& GetRun(uint32_t idx) const { return runs_[idx]; }
+  /**
+   * @brief Index of the run containing char_pos, positions past the end map
+   * to the last run.
+   */
+  uint32_t FindRunIndex(uint32_t char_pos) const;
+  uint8_t GetLevel(uint32_t char_pos) const {
+    return runs_.empty() ? 0 : runs_[FindRunIndex(char_pos)].level_;
+  }
+  bool IsRtl(uint32_t char_pos) const { return GetLevel(char_pos) % 2 == 1; }
+
+ public:
+  /**
+   * @brief Apply UAX#9 rule L2 to a sequence of levels.
+   *
+   * Reverses every maximal sequence at or above each level, from the highest
+   * level down to the lowest odd level.
+   * @param levels level of each item in logical order
+   * @param count
+   * @param visual_order output, logical index of the item at each visual slot
+   */
+  static void ReorderByLevels(const uint8_t* levels, uint32_t count,
+                              uint32_t* visual_order);
+
+ private:
+  std::vector<BidiRun> runs_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+
+#endif  // SRC_TEXTLAYOUT_INTERNAL_BIDI_RUN_TABLE_H_
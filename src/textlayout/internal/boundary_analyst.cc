@@ -6,6 +6,7 @@
 
 #include <textra/macro.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #ifdef BOUNDARY_ANALYST_ICU
@@ -138,6 +139,15 @@ uint32_t BoundaryAnalyst::FindPrevBoundary(uint32_t start,
   }
   return 0;
 }
+uint32_t BoundaryAnalyst::FindPrevHyphenBreak(uint32_t start,
+                                              uint32_t lower) const {
+  if (!HasHyphenBreak()) return lower;
+  const auto last = static_cast<uint32_t>(hyphen_break_.size() - 1);
+  for (auto k = std::min(start, last); k > lower; --k) {
+    if (hyphen_break_[k]) return k;
+  }
+  return lower;
+}
 void BoundaryAnalyst::UpgradeBoundaryType(const Range& range,
                                           BoundaryType type) {
   TTASSERT(range.GetEnd() <= boundary_.size());
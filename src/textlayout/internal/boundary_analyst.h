@@ -30,10 +30,27 @@ class BoundaryAnalyst {
     return boundary_[idx];
   }
   void UpgradeBoundaryType(const Range& range, BoundaryType type);
+  /**
+   * Hyphenation opportunities are kept apart from boundary_, a hyphen break
+   * is only taken when no kLineBreakable boundary fits into the line.
+   */
+  void SetHyphenBreakBefore(uint32_t idx) {
+    TTASSERT(idx > 0 && idx < boundary_.size());
+    if (hyphen_break_.empty()) hyphen_break_.resize(boundary_.size(), false);
+    hyphen_break_[idx] = true;
+  }
+  bool IsHyphenBreakBefore(uint32_t idx) const {
+    return idx < hyphen_break_.size() && hyphen_break_[idx];
+  }
+  bool HasHyphenBreak() const { return !hyphen_break_.empty(); }
+  /**
+   * @return the last hyphen break in (lower, start], or lower if there is none
+   */
+  uint32_t FindPrevHyphenBreak(uint32_t start, uint32_t lower) const;
 
- private:
  private:
   std::vector<BoundaryType> boundary_;
+  std::vector<bool> hyphen_break_;
 };
 }  // namespace tttext
 }  // namespace ttoffice
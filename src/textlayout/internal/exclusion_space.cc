@@ -0,0 +1,118 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/textlayout/internal/exclusion_space.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "src/textlayout/utils/float_comparison.h"
+
+namespace ttoffice {
+namespace tttext {
+void ExclusionSpace::AddExclusion(const Exclusion& exclusion) {
+  if (!FloatsLarger(exclusion.right_, exclusion.left_) ||
+      !FloatsLarger(exclusion.bottom_, exclusion.top_)) {
+    return;
+  }
+  auto iter = std::upper_bound(
+      exclusions_.begin(), exclusions_.end(), exclusion.top_,
+      [](float top, const Exclusion& item) { return top < item.top_; });
+  const auto idx = static_cast<uint32_t>(iter - exclusions_.begin());
+  exclusions_.insert(iter, exclusion);
+  if (GetExclusionCount() > capacity_) {
+    // grow geometrically, the whole tree is built again
+    capacity_ = std::max(capacity_ * 2, 4u);
+    max_bottom_.assign(capacity_ * 2, std::numeric_limits<float>::lowest());
+    UpdateMaxBottom(0);
+  } else {
+    UpdateMaxBottom(idx);
+  }
+}
+void ExclusionSpace::Clear() {
+  exclusions_.clear();
+  max_bottom_.clear();
+  capacity_ = 0;
+}
+/**
+ * @brief Updates the leaves from first_idx to the last exclusion, which moved
+ * or were added, and their ancestors.
+ */
+void ExclusionSpace::UpdateMaxBottom(uint32_t first_idx) {
+  const auto count = GetExclusionCount();
+  if (first_idx >= count) return;
+  for (auto k = first_idx; k < count; k++) {
+    max_bottom_[capacity_ + k] = exclusions_[k].bottom_;
+  }
+  auto lo = (capacity_ + first_idx) / 2;
+  auto hi = (capacity_ + count - 1) / 2;
+  while (lo > 0) {
+    for (auto node = lo; node <= hi; node++) {
+      max_bottom_[node] =
+          std::max(max_bottom_[node * 2], max_bottom_[node * 2 + 1]);
+    }
+    lo /= 2;
+    hi /= 2;
+  }
+}
+/**
+ * @brief Collects the exclusions crossing [top, bottom) under the node
+ * covering the leaves [lo, hi).
+ */
+void ExclusionSpace::CollectCrossing(
+    uint32_t node, uint32_t lo, uint32_t hi, float top, float bottom,
+    std::vector<const Exclusion*>* result) const {
+  if (lo >= GetExclusionCount()) return;
+  // nothing in this subtree reaches below the band top
+  if (!FloatsLarger(max_bottom_[node], top)) return;
+  // this subtree and everything after it starts below the band
+  if (!FloatsLarger(bottom, exclusions_[lo].top_)) return;
+  if (hi - lo == 1) {
+    result->push_back(&exclusions_[lo]);
+    return;
+  }
+  const auto mid = lo + (hi - lo) / 2;
+  CollectCrossing(node * 2, lo, mid, top, bottom, result);
+  CollectCrossing(node * 2 + 1, mid, hi, top, bottom, result);
+}
+bool ExclusionSpace::HasExclusionStartingIn(float top, float bottom) const {
+  auto iter = std::partition_point(
+      exclusions_.begin(), exclusions_.end(),
+      [top](const Exclusion& item) { return FloatsLarger(top, item.top_); });
+  return iter != exclusions_.end() && FloatsLarger(bottom, iter->top_);
+}
+bool ExclusionSpace::GetAvailableRanges(
+    float top, float height, float left, float right,
+    std::vector<std::array<float, 2>>* ranges, float* next_top) const {
+  ranges->clear();
+  std::vector<const Exclusion*> crossing;
+  if (!Empty()) {
+    CollectCrossing(1, 0, capacity_, top, top + std::max(height, 0.f),
+                    &crossing);
+  }
+  if (crossing.empty()) {
+    ranges->push_back({left, right});
+    return false;
+  }
+  std::sort(crossing.begin(), crossing.end(),
+            [](const Exclusion* a, const Exclusion* b) {
+              return a->left_ < b->left_;
+            });
+  auto range_start = left;
+  auto lowest_bottom = crossing[0]->bottom_;
+  for (const auto* exclusion : crossing) {
+    lowest_bottom = std::min(lowest_bottom, exclusion->bottom_);
+    if (FloatsLarger(std::min(exclusion->left_, right), range_start)) {
+      ranges->push_back({range_start, std::min(exclusion->left_, right)});
+    }
+    range_start = std::max(range_start, exclusion->right_);
+  }
+  if (FloatsLarger(right, range_start)) {
+    ranges->push_back({range_start, right});
+  }
+  *next_top = lowest_bottom;
+  return true;
+}
+}  // namespace tttext
+}  // namespace ttoffice
@@ -0,0 +1,79 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_TEXTLAYOUT_INTERNAL_EXCLUSION_SPACE_H_
+#define SRC_TEXTLAYOUT_INTERNAL_EXCLUSION_SPACE_H_
+#include <textra/macro.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief Rectangles excluded from text flow in a LayoutRegion, such as
+ * floating objects.
+ *
+ * The rectangles are kept sorted by top and indexed by a segment tree over the
+ * sorted array, each node stores the max bottom of its subtree. Finding the
+ * rectangles crossing a horizontal band costs O(log n + k). Adding one only
+ * updates the nodes of the rectangles after it, O(log n) when it is the lowest
+ * one, as floats placed by layout usually are.
+ */
+class ExclusionSpace {
+ public:
+  struct Exclusion {
+    float left_;
+    float top_;
+    float right_;
+    float bottom_;
+  };
+
+ public:
+  ExclusionSpace() = default;
+
+ public:
+  void AddExclusion(const Exclusion& exclusion);
+  void Clear();
+  bool Empty() const { return exclusions_.empty(); }
+  uint32_t GetExclusionCount() const {
+    return static_cast<uint32_t>(exclusions_.size());
+  }
+  /**
+   * @brief Computes the x ranges of [left, right] not covered by any
+   * exclusion crossing the band [top, top + height).
+   * @param ranges output, ascending ranges of at least some width, empty when
+   * the band is fully covered
+   * @param next_top output, the lowest bottom of the crossing exclusions, the
+   * first y below top where the ranges can become wider. Unchanged when no
+   * exclusion crosses the band.
+   * @return whether any exclusion crosses the band
+   */
+  bool GetAvailableRanges(float top, float height, float left, float right,
+                          std::vector<std::array<float, 2>>* ranges,
+                          float* next_top) const;
+  /**
+   * @brief Whether an exclusion starts inside [top, bottom). When a band grows
+   * downward, only those exclusions can change its available ranges.
+   */
+  bool HasExclusionStartingIn(float top, float bottom) const;
+
+ private:
+  void UpdateMaxBottom(uint32_t first_idx);
+  void CollectCrossing(uint32_t node, uint32_t lo, uint32_t hi, float top,
+                       float bottom,
+                       std::vector<const Exclusion*>* result) const;
+
+ private:
+  std::vector<Exclusion> exclusions_;  // sorted by top
+  // segment tree with the leaves at [capacity_, 2 * capacity_), node k covers
+  // the nodes 2k and 2k + 1
+  std::vector<float> max_bottom_;
+  uint32_t capacity_ = 0;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+
+#endif  // SRC_TEXTLAYOUT_INTERNAL_EXCLUSION_SPACE_H_
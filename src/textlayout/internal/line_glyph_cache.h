@@ -0,0 +1,46 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_TEXTLAYOUT_INTERNAL_LINE_GLYPH_CACHE_H_
+#define SRC_TEXTLAYOUT_INTERNAL_LINE_GLYPH_CACHE_H_
+
+#include <textra/i_canvas_helper.h>
+#include <textra/painter.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+/**
+ * @brief The glyph runs LayoutDrawer drew for a whole line, kept on the line
+ * so that the next frame hands the same runs and the backend objects prepared
+ * for them to the canvas without looking at the runs again.
+ *
+ * Glyphs, positions and painters are owned by the cache, runs_ points into
+ * them. Painters are made by the canvas of the drawer drawer_id_ and only
+ * their color is updated on redraw. The cache is keyed on the drawer rather
+ * than on the canvas address, which a new canvas may reuse once the old one
+ * is freed.
+ */
+struct LineGlyphCache {
+  // the painter colored by the foreground color of char_pos_
+  struct ColorSource {
+    uint32_t painter_idx_;
+    uint32_t char_pos_;
+  };
+  uint64_t drawer_id_ = 0;
+  float line_top_ = 0;
+  std::vector<GlyphRun> runs_;
+  std::vector<uint16_t> glyphs_;
+  std::vector<float> pos_x_;
+  std::vector<float> pos_y_;
+  std::vector<std::unique_ptr<Painter>> painters_;
+  std::vector<ColorSource> color_sources_;
+  std::unique_ptr<PreparedGlyphRuns> prepared_;
+};
+}  // namespace tttext
+}  // namespace ttoffice
+#endif  // SRC_TEXTLAYOUT_INTERNAL_LINE_GLYPH_CACHE_H_
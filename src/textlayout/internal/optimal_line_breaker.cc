@@ -0,0 +1,96 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/textlayout/internal/optimal_line_breaker.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "src/textlayout/internal/boundary_analyst.h"
+#include "src/textlayout/paragraph_impl.h"
+#include "src/textlayout/run/base_run.h"
+#include "src/textlayout/utils/float_comparison.h"
+#include "src/textlayout/utils/u_8_string.h"
+
+namespace ttoffice {
+namespace tttext {
+namespace {
+// Lines wider than the available width are only chosen when a single word
+// does not fit, the builder then breaks the word itself.
+constexpr double kOverflowPenalty = 1e8;
+}  // namespace
+std::vector<uint32_t> OptimalLineBreaker::ComputeBreaks(
+    const ParagraphImpl& paragraph, float first_line_width, float line_width) {
+  std::vector<uint32_t> breaks;
+  const auto char_count = paragraph.GetCharCount();
+  if (char_count == 0) return breaks;
+
+  // prefix[k] is the width of chars [0, k)
+  std::vector<float> prefix(char_count + 1, 0);
+  for (auto r = 0u; r < paragraph.GetRunCount(); r++) {
+    const auto* run = paragraph.GetRun(r);
+    if (run->IsGhostRun() || run->IsBlockRun()) continue;
+    for (auto k = 0u; k < run->GetCharCount(); k++) {
+      prefix[run->GetStartCharPos() + k + 1] = run->GetCharAdvance(k);
+    }
+  }
+  for (auto k = 1u; k <= char_count; k++) {
+    prefix[k] += prefix[k - 1];
+  }
+
+  const auto* analyst = paragraph.boundary_analyst_.get();
+  std::vector<uint32_t> candidates{0};
+  for (auto k = 1u; k <= char_count; k++) {
+    if (k == char_count ||
+        analyst->GetBoundaryTypeBefore(k) >= BoundaryType::kLineBreakable) {
+      candidates.push_back(k);
+    }
+  }
+
+  const auto count = static_cast<uint32_t>(candidates.size());
+  const auto max_width = std::max(first_line_width, line_width);
+  std::vector<double> cost(count, std::numeric_limits<double>::max());
+  std::vector<uint32_t> prev(count, 0);
+  cost[0] = 0;
+  auto segment_start = 0u;
+  for (auto j = 1u; j < count; j++) {
+    const auto end = candidates[j];
+    // trailing spaces hang outside of the line
+    auto content_end = end;
+    while (content_end > candidates[j - 1] &&
+           base::IsSpaceChar(paragraph.content_.GetUnicode(content_end - 1))) {
+      content_end--;
+    }
+    const bool hard_break =
+        end == char_count ||
+        analyst->GetBoundaryTypeBefore(end) >= BoundaryType::kMustLineBreak;
+    for (auto i = j; i-- > segment_start;) {
+      const auto start = candidates[i];
+      const auto width = prefix[content_end] - prefix[start];
+      if (i + 1 < j && FloatsLarger(width, max_width)) break;
+      const auto available = start == 0 ? first_line_width : line_width;
+      double line_cost = 0;
+      if (FloatsLarger(width, available)) {
+        const double overflow = width - available;
+        line_cost = kOverflowPenalty + overflow * overflow;
+      } else if (!hard_break) {
+        const double slack = available - width;
+        line_cost = slack * slack;
+      }
+      if (cost[i] + line_cost < cost[j]) {
+        cost[j] = cost[i] + line_cost;
+        prev[j] = i;
+      }
+    }
+    if (hard_break) segment_start = j;
+  }
+
+  for (auto j = count - 1; j > 0; j = prev[j]) {
+    breaks.push_back(candidates[j]);
+  }
+  std::reverse(breaks.begin(), breaks.end());
+  return breaks;
+}
+}  // namespace tttext
+}  // namespace ttoffice
@@ -0,0 +1,39 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_TEXTLAYOUT_INTERNAL_OPTIMAL_LINE_BREAKER_H_
+#define SRC_TEXTLAYOUT_INTERNAL_OPTIMAL_LINE_BREAKER_H_
+#include <cstdint>
+#include <vector>
+
+namespace ttoffice {
+namespace tttext {
+class ParagraphImpl;
+/**
+ * @brief Knuth-Plass style line breaker.
+ *
+ * Chooses the break positions of a whole paragraph by minimizing the sum of
+ * squared slack of every line except the last one of each hard-break segment.
+ * Candidates are the kLineBreakable boundaries of the paragraph, widths come
+ * from the shaped runs, and trailing spaces hang outside the line like in the
+ * greedy layout. Only predecessors within one line width are visited, so the
+ * cost is linear in the number of candidates times candidates per line.
+ */
+class OptimalLineBreaker {
+ public:
+  /**
+   * @param paragraph formatted paragraph
+   * @param first_line_width available width of the first line
+   * @param line_width available width of the other lines
+   * @return char positions in paragraph where each line ends, ascending, the
+   * last element is the char count of the paragraph
+   */
+  static std::vector<uint32_t> ComputeBreaks(const ParagraphImpl& paragraph,
+                                             float first_line_width,
+                                             float line_width);
+};
+}  // namespace tttext
+}  // namespace ttoffice
+
+#endif  // SRC_TEXTLAYOUT_INTERNAL_OPTIMAL_LINE_BREAKER_H_
@@ -73,11 +73,18 @@ class RunRange {
    */
   CharPos FindCharPosInParagraphByX(float x) const {
     if (FloatsLargerOrEqual(0, x)) return GetStartCharPosInParagraph();
-    uint32_t k = 1;
-    for (; k < GetCharCount(); k++) {
-      if (FloatsLarger(GetWidthInRange(0, k), x)) break;
+    // find the shortest prefix wider than x, prefix widths never decrease
+    uint32_t low = 1;
+    uint32_t high = GetCharCount();
+    while (low < high) {
+      auto mid = low + (high - low) / 2;
+      if (FloatsLarger(GetWidthInRange(0, mid), x)) {
+        high = mid;
+      } else {
+        low = mid + 1;
+      }
     }
-    return k + GetStartCharPosInParagraph() - 1;
+    return low + GetStartCharPosInParagraph() - 1;
   }
   float GetXOffset() const { return x_offset_; }
   void SetXOffset(float x_offset) { x_offset_ = x_offset; }
@@ -87,17 +94,8 @@ class RunRange {
   // void SetEndIndent(float end_indent) { end_indent_ = end_indent; };
   const BaseRun* GetRun() const { return run_; }
   //  bool Visible() const { return run_->Visible(); }
-  uint32_t GetVisualOrderIndex() const { return run_->GetVisualOrderIndex(); }
   RunType GetType() const { return run_->GetType(); }
   const LayoutMetrics& GetLayoutMetrics() const { return metrics_; }
-  void AddHyphnateRun(std::unique_ptr<BaseRun> hyphnate_run) {
-    //    ghost_content_ = std::move(hyphnate_run);
-  }
-  const BaseRun* GetHyphnateRun() const {
-    TTASSERT(false);
-    return nullptr;
-    //    return ghost_content_.get();
-  }
   const LineRange* GetParent() const { return parent_; }
 
  private:
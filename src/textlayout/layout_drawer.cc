@@ -6,18 +6,23 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 
 // #include "block_region.h"
+#include <textra/flat_layout_result.h>
 #include <textra/i_canvas_helper.h>
 #include <textra/layout_region.h>
 
+#include "src/textlayout/internal/line_glyph_cache.h"
 #include "src/textlayout/internal/line_range.h"
 #include "src/textlayout/internal/run_range.h"
 #include "src/textlayout/layout_measurer.h"
+#include "src/textlayout/paragraph_impl.h"
 #include "src/textlayout/run/ghost_run.h"
 #include "src/textlayout/run/object_run.h"
 #include "src/textlayout/style/style_manager.h"
 #include "src/textlayout/text_line_impl.h"
+#include "src/textlayout/utils/float_comparison.h"
 #include "src/textlayout/utils/tt_rectf.h"
 
 #if defined(TTTEXT_DEBUG)
@@ -28,30 +33,193 @@ constexpr float kUnderlineDefaultDashLength = 2.5f;
 constexpr float kUnderlineDefaultGapLength = 1.5f;
 constexpr float kUnderlineDefaultStrokeWidth = 1.f;
 constexpr float kUnderlineDefaultSideMargin = 2.5f;
+// never reused, a glyph cache is only drawn by the drawer which made it
+std::atomic<uint64_t> next_drawer_id{1};
 }  // namespace
 namespace ttoffice {
 namespace tttext {
+/**
+ * @brief A painter borrowed from the pool of the drawer for one scope, the
+ * painter is reset to the default attributes.
+ */
+class LayoutDrawer::PooledPainter {
+ public:
+  explicit PooledPainter(const LayoutDrawer* drawer)
+      : drawer_(drawer), painter_(drawer->AcquirePainter()) {}
+  ~PooledPainter() { drawer_->ReleasePainter(); }
+  PooledPainter(const PooledPainter&) = delete;
+  PooledPainter& operator=(const PooledPainter&) = delete;
+
+ public:
+  Painter* get() const { return painter_; }
+  Painter* operator->() const { return painter_; }
+
+ private:
+  const LayoutDrawer* drawer_;
+  Painter* painter_;
+};
+
 LayoutDrawer::LayoutDrawer(ICanvasHelper* canvas)
-    : canvas_(canvas), listener_(LayoutDrawerListener::GetInstance()) {}
+    : canvas_(canvas),
+      listener_(LayoutDrawerListener::GetInstance()),
+      drawer_id_(next_drawer_id.fetch_add(1, std::memory_order_relaxed)) {}
 LayoutDrawer::~LayoutDrawer() = default;
 void LayoutDrawer::DrawLayoutPage(LayoutRegion* layout_page) {
   if (!canvas_) return;
+  if (const auto* display_list = EnsureDisplayList(layout_page)) {
+    display_list->Draw(canvas_);
+    return;
+  }
+  if (layout_page->IsVirtualized()) {
+    DrawLayoutPage(layout_page, 0, layout_page->GetLayoutedHeight());
+    return;
+  }
   for (auto& line : layout_page->line_lst_) {
     DrawTextLine(line.get(), 0, line->GetCharCount());
   }
 }
+void LayoutDrawer::DrawLayoutPage(LayoutRegion* layout_page, float top,
+                                  float bottom) {
+  if (!canvas_) return;
+  auto line_count = layout_page->GetLineCount();
+  if (const auto* display_list = EnsureDisplayList(layout_page)) {
+    auto start = layout_page->FindLineIndexByY(top);
+    auto end = start;
+    while (end < line_count &&
+           FloatsLarger(bottom, display_list->GetLine(end).top_)) {
+      end++;
+    }
+    display_list->DrawLines(canvas_, start, end);
+    return;
+  }
+  layout_page->VisitLines(
+      layout_page->FindLineIndexByY(top), line_count,
+      [this, bottom](uint32_t, TextLine* line) {
+        if (!FloatsLarger(bottom, line->GetLineTop())) return false;
+        DrawTextLine(line, 0, line->GetCharCount());
+        return true;
+      });
+}
+void LayoutDrawer::DrawLayoutPage(LayoutRegion* layout_page,
+                                  const float clip_rect_ltrb[4]) {
+  if (!canvas_) return;
+  const auto left = clip_rect_ltrb[0];
+  const auto top = clip_rect_ltrb[1];
+  const auto right = clip_rect_ltrb[2];
+  const auto bottom = clip_rect_ltrb[3];
+  if (EnsureDisplayList(layout_page) != nullptr) {
+    // display lists are replayed by whole lines
+    DrawLayoutPage(layout_page, top, bottom);
+    return;
+  }
+  layout_page->VisitLines(
+      layout_page->FindLineIndexByY(top), layout_page->GetLineCount(),
+      [&](uint32_t, TextLine* line) {
+        if (!FloatsLarger(bottom, line->GetLineTop())) return false;
+        uint32_t char_start = 0;
+        uint32_t char_end = 0;
+        if (GetCharRangeInClip(line, left, right, &char_start, &char_end)) {
+          DrawTextLine(line, char_start, char_end);
+        }
+        return true;
+      });
+}
+/**
+ * @brief Chars of the drawer pieces crossing [left, right). Pieces are
+ * widened by half the line height since glyphs may draw outside of their
+ * advances, the ellipsis and the hyphen are only drawn with the whole line.
+ * @return false if no piece is visible
+ */
+bool LayoutDrawer::GetCharRangeInClip(TextLine* i_line, float left,
+                                      float right,
+                                      uint32_t* char_start_in_line,
+                                      uint32_t* char_end_in_line) const {
+  auto* line = TTDYNAMIC_CAST<TextLineImpl*>(i_line);
+  line->EnsureDrawerPiece();
+  const auto line_start = line->GetStartCharPos();
+  const auto overflow = line->GetLineHeight() / 2;
+  auto char_start = line->GetCharCount();
+  uint32_t char_end = 0;
+  for (const auto& piece : line->drawer_list_) {
+    if (!FloatsLarger(piece->GetRight() + overflow, left) ||
+        !FloatsLarger(right, piece->GetLeft() - overflow)) {
+      continue;
+    }
+    if (piece->GetRun()->IsGhostRun()) {
+      char_start = 0;
+      char_end = line->GetCharCount();
+      break;
+    }
+    char_start = std::min(char_start,
+                          piece->GetStartCharPosInParagraph() - line_start);
+    char_end =
+        std::max(char_end, piece->GetEndCharPosInParagraph() - line_start);
+  }
+  *char_start_in_line = char_start;
+  *char_end_in_line = char_end;
+  return char_start < char_end;
+}
 void LayoutDrawer::SetListener(LayoutDrawerListener* listener) {
   listener_ = listener;
 }
+Painter* LayoutDrawer::AcquirePainter() const {
+  if (painter_pool_used_ == painter_pool_.size()) {
+    painter_pool_.emplace_back(canvas_->CreatePainter());
+  }
+  auto* painter = painter_pool_[painter_pool_used_++].get();
+  painter->Reset();
+  return painter;
+}
+void LayoutDrawer::ReleasePainter() const {
+  TTASSERT(painter_pool_used_ > 0);
+  painter_pool_used_--;
+}
+const FlatLayoutResult* LayoutDrawer::EnsureDisplayList(
+    LayoutRegion* layout_page) {
+  if (!use_display_list_ || layout_page->IsVirtualized()) return nullptr;
+  if (layout_page->display_list_listener_ == listener_) {
+    if (layout_page->display_list_ != nullptr) {
+      return layout_page->display_list_.get();
+    }
+    if (layout_page->display_list_unrecordable_) return nullptr;
+  }
+  layout_page->display_list_ = nullptr;
+  layout_page->display_list_listener_ = listener_;
+  layout_page->display_list_unrecordable_ = true;
+  // a run delegate draws whatever it wants on the canvas, each time
+  for (const auto* i_paragraph : layout_page->paragraph_list_) {
+    const auto* paragraph = TTDYNAMIC_CAST<const ParagraphImpl*>(i_paragraph);
+    if (paragraph->GetParagraphStyle().GetEllipsisDelegate() != nullptr) {
+      return nullptr;
+    }
+    for (const auto& run : paragraph->run_lst_) {
+      if (run->GetRunDelegate() != nullptr) return nullptr;
+    }
+  }
+  std::shared_ptr<const FlatLayoutResult> display_list =
+      FlatLayoutResult::Create(layout_page, listener_);
+  if (display_list->GetDroppedOpCount() > 0) return nullptr;
+  layout_page->display_list_ = std::move(display_list);
+  layout_page->display_list_unrecordable_ = false;
+  return layout_page->display_list_.get();
+}
 
 void LayoutDrawer::DrawTextLine(TextLine* i_line, uint32_t char_start_in_line,
                                 uint32_t char_end_in_line) {
   auto* line = TTDYNAMIC_CAST<TextLineImpl*>(i_line);
+  line->EnsureDrawerPiece();
 
   auto line_start_in_para = line->GetStartCharPos();
   auto char_start_in_para = char_start_in_line + line_start_in_para;
   auto char_end_in_para = char_end_in_line + line_start_in_para;
   DrawLineBackground(line, char_start_in_para, char_end_in_para);
+  const bool whole_line = cache_glyph_runs_ && char_start_in_line == 0 &&
+                          char_end_in_line >= line->GetCharCount();
+  if (whole_line && DrawCachedGlyphRuns(line)) {
+    DrawLineDecoration(line, char_start_in_para, char_end_in_para);
+    return;
+  }
+  caching_line_ = whole_line;
   bool not_ghost_content_drawed = false;
   for (auto& drawer_piece : line->drawer_list_) {
     TTASSERT(!drawer_piece->GetRun()->IsControlRun());
@@ -65,12 +233,17 @@ void LayoutDrawer::DrawTextLine(TextLine* i_line, uint32_t char_start_in_line,
       auto piece_end = drawer_piece->GetEndCharPosInParagraph();
       auto draw_start = std::max(piece_start, char_start_in_para);
       auto draw_end = std::min(piece_end, char_end_in_para);
-      if (draw_start >= draw_end) break;
+      if (draw_start >= draw_end) continue;
       DrawDrawerPiece(line, drawer_piece.get(), draw_start - piece_start,
                       draw_end - piece_start);
       not_ghost_content_drawed = true;
     }
   }
+  if (caching_line_) {
+    CacheGlyphRuns(line);
+    DrawGlyphCache(*line->glyph_cache_);
+  }
+  FlushGlyphRuns();
   DrawLineDecoration(line, char_start_in_para, char_end_in_para);
 #if DRAW_AUXILIARY_LINE
   line->DumpLineInfo();
@@ -108,7 +281,7 @@ void LayoutDrawer::DrawLineBackground(TextLine* i_line,
       auto end_char = std::min(range.GetRange().GetEnd(), char_end_in_para);
       line->GetBoundingRectByCharRange(rect.data(), start_char, end_char);
       auto& style = range.GetStyle();
-      auto default_painter = canvas_->CreatePainter();
+      PooledPainter default_painter(this);
       auto painter = style.GetBackgroundPainter();
       if (painter == nullptr) {
         painter = default_painter.get();
@@ -156,7 +329,7 @@ void LayoutDrawer::DrawLineDecoration(TextLine* i_line,
           line_y = (line->GetLineTop() + line->GetLineBottom()) / 2;
           break;
       }
-      auto painter = canvas_->CreatePainter();
+      PooledPainter painter(this);
       painter->SetFillStyle(FillStyle::kStrokeAndFill);
       painter->SetColor(decorate_style.GetDecorationColor());
       auto stroke_width = painter->GetStrokeWidth();
@@ -237,8 +410,10 @@ void LayoutDrawer::DrawDrawerPiece(const TextLine* line,
     auto glyph_start = result.CharToGlyph(piece_start);
     auto glyph_end = result.CharToGlyph(piece_end);
     auto glyph_count = glyph_end - glyph_start;
-    std::vector<float> pos_x(glyph_count);
-    std::vector<float> pos_y(glyph_count);
+    pos_x_buffer_.resize(glyph_count);
+    pos_y_buffer_.resize(glyph_count);
+    auto* pos_x = pos_x_buffer_.data();
+    auto* pos_y = pos_y_buffer_.data();
     float char_x_pos = 0.f;
     float min_x = 0.f;
     for (uint32_t k = 0; k < glyph_count; k++) {
@@ -253,27 +428,32 @@ void LayoutDrawer::DrawDrawerPiece(const TextLine* line,
         char_x_pos += run->GetLayoutStyle().GetLetterSpacing();
       }
     }
-    for (auto& xx : pos_x) {
-      xx -= min_x;
+    for (uint32_t k = 0; k < glyph_count; k++) {
+      pos_x[k] -= min_x;
     }
 
-    DrawTextRun(run, piece_start, piece_end, run_range->GetXOffset(), y,
-                pos_x.data(), pos_y.data(),
+    // positions stay relative to the piece, only the glyphs of the requested
+    // chars are drawn
+    auto draw_start = piece_start + char_start_in_piece;
+    auto draw_end = std::min(piece_start + char_end_in_piece, piece_end);
+    auto offset = GlyphOffsetInRange(run, glyph_start, glyph_end,
+                                     result.CharToGlyph(draw_start),
+                                     result.CharToGlyph(draw_end));
+    DrawTextRun(run, draw_start, draw_end, run_range->GetXOffset(), y,
+                pos_x + offset, pos_y + offset,
                 background_rect.ToArrayLTWH().data());
     background_rect.SetLeft(background_rect.GetRight());
-    // TODO(hfuttyh) need to implement
-    // if (run_range->GetHyphnateRun()) {
-    //   const auto* hyphnate_run = run_range->GetHyphnateRun();
-    //   background_rect.SetWidth(hyphnate_run->GetWidth(0, nullptr));
-    //   DrawTextRun(hyphnate_run, 0, hyphnate_run->GetCharCount(),
-    //               background_rect.GetLeft(), y, background_rect);
-    // }
   }
   if (run->GetType() == RunType::kInlineObject) {
     auto y_offset = run_range->GetYOffsetInLine();
     auto y = line->GetLineTop() + y_offset;
+    FlushGlyphRuns();
     run->GetRunDelegate()->Draw(canvas_, run_range->GetXOffset(),
                                 y + metrics.GetMaxAscent());
+  } else if (run->GetType() == RunType::kFloatObject) {
+    auto* delegate = run->GetRunDelegate();
+    FlushGlyphRuns();
+    delegate->Draw(canvas_, delegate->GetXOffset(), delegate->GetYOffset());
   }
 }
 float LayoutDrawer::DrawTextRun(const BaseRun* run, uint32_t start_char_in_run,
@@ -288,9 +468,14 @@ float LayoutDrawer::DrawTextRun(const BaseRun* run, uint32_t start_char_in_run,
   if (paragraph != nullptr) {
     style_manager = paragraph->style_manager_.get();
   }
+  // colors of cached runs are looked up in the style manager
+  if (style_manager == nullptr) caching_line_ = false;
+  auto& result = run->shape_result_;
+  const auto run_glyph_start = result.CharToGlyph(start_char_in_run);
+  const auto run_glyph_end = result.CharToGlyph(end_char_in_run);
   while (piece_start < char_end_pos) {
     const Style* style = nullptr;
-    auto default_painter = canvas_->CreatePainter();
+    PooledPainter default_painter(this);
     Painter* painter = nullptr;
     auto piece_end = char_end_pos;
     StyleRange style_range;
@@ -322,7 +507,10 @@ float LayoutDrawer::DrawTextRun(const BaseRun* run, uint32_t start_char_in_run,
         painter->SetTextSize(layout_style.GetTextSize());
       }
     }
-    auto& result = run->shape_result_;
+    // painters of the style are owned by the caller and may carry platform
+    // state, only the drawer's own painters are batched
+    const bool batch = painter == default_painter.get();
+    color_source_char_ = run->GetStartCharPos() + piece_start;
     auto glyph_start = result.CharToGlyph(piece_start);
     auto glyph_end = result.CharToGlyph(piece_end);
     auto glyph_count = glyph_end - glyph_start;
@@ -332,9 +520,14 @@ float LayoutDrawer::DrawTextRun(const BaseRun* run, uint32_t start_char_in_run,
       }
     } else {
       y += style->GetBaselineOffset();
-      std::vector<uint16_t> glyphs(glyph_count);
-      std::vector<const ITypefaceHelper*> fonts(glyph_count);
-      std::vector<float> advance(glyph_count);
+      glyph_buffer_.resize(glyph_count);
+      font_buffer_.resize(glyph_count);
+      auto* glyphs = glyph_buffer_.data();
+      auto* fonts = font_buffer_.data();
+      auto offset = GlyphOffsetInRange(run, run_glyph_start, run_glyph_end,
+                                       glyph_start, glyph_end);
+      auto* piece_pos_x = pos_x + offset;
+      auto* piece_pos_y = pos_y + offset;
       uint32_t prev_start = 0;
       uint32_t prev_glyph_id = run->IsRtl() ? glyph_count - 1 : 0;
       for (uint32_t k = 0; k < glyph_count; k++) {
@@ -343,29 +536,43 @@ float LayoutDrawer::DrawTextRun(const BaseRun* run, uint32_t start_char_in_run,
         glyphs[k] = result.Glyphs(invert_glyph_id);
         fonts[k] = result.Font(invert_glyph_id).get();
         if (k > 0 && fonts[k] != fonts[k - 1]) {
-          DrawGlyphsOrText(run, glyphs.data() + prev_start, k - prev_start,
+          DrawGlyphsOrText(run, glyphs + prev_start, k - prev_start,
                            prev_glyph_id + glyph_start, fonts[prev_start], x, y,
-                           pos_x + prev_start, pos_y + prev_start, painter);
+                           piece_pos_x + prev_start, piece_pos_y + prev_start,
+                           painter, batch);
           prev_start = k;
           prev_glyph_id = invert_glyph_id - glyph_start;
         }
       }
-      DrawGlyphsOrText(run, glyphs.data() + prev_start,
-                       glyph_count - prev_start, prev_glyph_id + glyph_start,
-                       fonts[prev_start], x, y, pos_x + prev_start,
-                       pos_y + prev_start, painter);
+      DrawGlyphsOrText(run, glyphs + prev_start, glyph_count - prev_start,
+                       prev_glyph_id + glyph_start, fonts[prev_start], x, y,
+                       piece_pos_x + prev_start, piece_pos_y + prev_start,
+                       painter, batch);
     }
     piece_start = piece_end;
   }
   return x;
 }
 
+/**
+ * @brief Index of the first glyph of [sub_start, sub_end) in positions laid
+ * out for the glyphs [range_start, range_end) of run. Positions are in visual
+ * order, so the glyphs of a rtl run are counted from the end.
+ */
+uint32_t LayoutDrawer::GlyphOffsetInRange(const BaseRun* run,
+                                          uint32_t range_start,
+                                          uint32_t range_end,
+                                          uint32_t sub_start,
+                                          uint32_t sub_end) {
+  TTASSERT(range_start <= sub_start && sub_end <= range_end);
+  return run->IsRtl() ? range_end - sub_end : sub_start - range_start;
+}
 void LayoutDrawer::DrawGlyphsOrText(const BaseRun* run, uint16_t* glyphs,
                                     uint32_t glyph_count,
                                     uint32_t glyph_start_index,
                                     const ITypefaceHelper* font, float ox,
                                     float oy, float* pos_x, float* pos_y,
-                                    Painter* p) const {
+                                    Painter* p, bool batch) const {
   if (glyph_count == 0) return;
   auto desired_font_style =
       run->GetShapeStyle().GetFontDescriptor().font_style_;
@@ -383,8 +590,21 @@ void LayoutDrawer::DrawGlyphsOrText(const BaseRun* run, uint16_t* glyphs,
   }
   while (glyph_count > 0 && glyphs[glyph_count - 1] == 0) glyph_count--;
   /* tricky rtl implemention */
-  canvas_->DrawGlyphs(font, glyph_count, glyphs, nullptr, run->IsRtl() ? 1 : 0,
-                      ox, oy + run->baseline_offset_, pos_x, pos_y, p);
+  if (batch) {
+    if (glyph_count == 0) return;
+    // glyphs are in visual order, the ids of a rtl run go down
+    const auto last_glyph = run->IsRtl()
+                                ? glyph_start_index - (glyph_count - 1)
+                                : glyph_start_index + (glyph_count - 1);
+    AddGlyphRun(font, glyphs, glyph_count, run->IsRtl() ? 1 : 0, ox,
+                oy + run->baseline_offset_, pos_x, pos_y,
+                run->shape_result_.Advances(last_glyph)[0], *p);
+  } else {
+    FlushGlyphRuns();
+    canvas_->DrawGlyphs(font, glyph_count, glyphs, nullptr,
+                        run->IsRtl() ? 1 : 0, ox, oy + run->baseline_offset_,
+                        pos_x, pos_y, p);
+  }
 #if defined(DRAW_LINE_BOX)
   auto painter = canvas_->CreatePainter();
   painter->SetFillStyle(FillStyle::kStroke);
@@ -398,5 +618,158 @@ void LayoutDrawer::DrawGlyphsOrText(const BaseRun* run, uint16_t* glyphs,
                     painter.get());
 #endif
 }
+void LayoutDrawer::AddGlyphRun(const ITypefaceHelper* font,
+                               const uint16_t* glyphs, uint32_t glyph_count,
+                               uint32_t text_bytes, float ox, float oy,
+                               const float* pos_x, const float* pos_y,
+                               float last_advance,
+                               const Painter& painter) const {
+  if (glyph_count == 0) return;
+  auto* last = pending_runs_.empty() ? nullptr : &pending_runs_.back();
+  auto painter_idx = last != nullptr ? last->painter_idx_ : 0;
+  if (last == nullptr ||
+      !batch_painters_[painter_idx]->HasSameAttributes(painter)) {
+    if (batch_painter_count_ == batch_painters_.size()) {
+      batch_painters_.emplace_back(canvas_->CreatePainter());
+    }
+    painter_idx = batch_painter_count_++;
+    *batch_painters_[painter_idx] = painter;
+  }
+  if (caching_line_ && (pending_color_sources_.empty() ||
+                        pending_color_sources_.back() !=
+                            std::make_pair(painter_idx, color_source_char_))) {
+    pending_color_sources_.emplace_back(painter_idx, color_source_char_);
+  }
+  // Runs on the same baseline with the same font, paint and direction become
+  // one run when the first glyph of the new run starts where the last run
+  // ends, positions are moved to the origin of the first one. Backends which
+  // only read the first position of a run (e.g. Java) still place the glyphs
+  // of a merged run right, and justify or letter spacing gaps between pieces
+  // keep them apart. Only x is shifted, backends do not agree on the
+  // direction of y offsets.
+  float dx = 0;
+  const float end_x = ox + pos_x[glyph_count - 1] + last_advance;
+  if (last != nullptr && last->painter_idx_ == painter_idx &&
+      last->font_ == font && last->text_bytes_ == text_bytes &&
+      FloatsEqual(last->origin_y_, oy) &&
+      FloatsEqual(last->end_x_, ox + pos_x[0])) {
+    dx = ox - last->origin_x_;
+    last->glyph_count_ += glyph_count;
+    last->end_x_ = end_x;
+  } else {
+    pending_runs_.push_back({font, static_cast<uint32_t>(batch_glyphs_.size()),
+                             glyph_count, text_bytes, ox, oy, painter_idx,
+                             end_x});
+  }
+  batch_glyphs_.insert(batch_glyphs_.end(), glyphs, glyphs + glyph_count);
+  for (auto k = 0u; k < glyph_count; k++) {
+    batch_pos_x_.push_back(pos_x[k] + dx);
+    batch_pos_y_.push_back(pos_y[k]);
+  }
+}
+void LayoutDrawer::FlushGlyphRuns() const {
+  // runs drawn before the end of a line can not be replayed from its cache
+  caching_line_ = false;
+  if (pending_runs_.empty()) return;
+  glyph_runs_.clear();
+  for (const auto& run : pending_runs_) {
+    glyph_runs_.push_back({run.font_, batch_glyphs_.data() + run.glyph_start_,
+                           run.glyph_count_, run.text_bytes_, run.origin_x_,
+                           run.origin_y_,
+                           batch_pos_x_.data() + run.glyph_start_,
+                           batch_pos_y_.data() + run.glyph_start_,
+                           batch_painters_[run.painter_idx_].get()});
+  }
+  canvas_->DrawGlyphRuns(glyph_runs_.data(),
+                         static_cast<uint32_t>(glyph_runs_.size()));
+  ClearGlyphRuns();
+}
+void LayoutDrawer::ClearGlyphRuns() const {
+  pending_runs_.clear();
+  batch_glyphs_.clear();
+  batch_pos_x_.clear();
+  batch_pos_y_.clear();
+  batch_painter_count_ = 0;
+  pending_color_sources_.clear();
+}
+/**
+ * @brief Moves the pending runs of the line into its glyph cache. The cache
+ * owns copies of the glyphs, positions and painters, the scratch buffers of
+ * the drawer are kept for the next line.
+ */
+void LayoutDrawer::CacheGlyphRuns(TextLine* i_line) const {
+  auto* line = TTDYNAMIC_CAST<TextLineImpl*>(i_line);
+  auto cache = std::make_unique<LineGlyphCache>();
+  cache->drawer_id_ = drawer_id_;
+  cache->line_top_ = line->GetLineTop();
+  cache->glyphs_ = batch_glyphs_;
+  cache->pos_x_ = batch_pos_x_;
+  cache->pos_y_ = batch_pos_y_;
+  for (auto k = 0u; k < batch_painter_count_; k++) {
+    cache->painters_.emplace_back(canvas_->CreatePainter());
+    *cache->painters_.back() = *batch_painters_[k];
+  }
+  for (const auto& source : pending_color_sources_) {
+    cache->color_sources_.push_back({source.first, source.second});
+  }
+  for (const auto& run : pending_runs_) {
+    cache->runs_.push_back(
+        {run.font_, cache->glyphs_.data() + run.glyph_start_, run.glyph_count_,
+         run.text_bytes_, run.origin_x_, run.origin_y_,
+         cache->pos_x_.data() + run.glyph_start_,
+         cache->pos_y_.data() + run.glyph_start_,
+         cache->painters_[run.painter_idx_].get()});
+  }
+  if (!cache->runs_.empty()) {
+    cache->prepared_ = canvas_->PrepareGlyphRuns(
+        cache->runs_.data(), static_cast<uint32_t>(cache->runs_.size()));
+  }
+  line->glyph_cache_ = std::move(cache);
+  ClearGlyphRuns();
+}
+/**
+ * @brief Draws the glyph cache of a line after updating the colors of its
+ * painters.
+ * @return false if the line has no usable cache, it is dropped when another
+ * drawer made it, the position of the line changed, or a color change would
+ * split a run
+ */
+bool LayoutDrawer::DrawCachedGlyphRuns(TextLine* i_line) const {
+  auto* line = TTDYNAMIC_CAST<TextLineImpl*>(i_line);
+  auto* cache = line->glyph_cache_.get();
+  if (cache == nullptr) return false;
+  bool valid = cache->drawer_id_ == drawer_id_ &&
+               FloatsEqual(cache->line_top_, line->GetLineTop());
+  auto& style_manager = line->GetParagraph()->style_manager_;
+  color_updated_.assign(cache->painters_.size(), 0);
+  for (auto k = 0u; valid && k < cache->color_sources_.size(); k++) {
+    const auto& source = cache->color_sources_[k];
+    StyleRange range;
+    style_manager->GetStyleRange(
+        &range, source.char_pos_,
+        Style::ForegroundColorFlag() | Style::ForegroundPainterFlag());
+    const auto& style = range.GetStyle();
+    auto color = style.GetForegroundColor().GetPlainColor();
+    auto* painter = cache->painters_[source.painter_idx_].get();
+    if (style.GetForegroundPainter() != nullptr ||
+        (color_updated_[source.painter_idx_] && painter->GetColor() != color)) {
+      valid = false;
+      break;
+    }
+    painter->SetColor(color);
+    color_updated_[source.painter_idx_] = 1;
+  }
+  if (!valid) {
+    line->InvalidateGlyphCache();
+    return false;
+  }
+  DrawGlyphCache(*cache);
+  return true;
+}
+void LayoutDrawer::DrawGlyphCache(const LineGlyphCache& cache) const {
+  if (cache.runs_.empty()) return;
+  canvas_->DrawPreparedGlyphRuns(cache.prepared_.get(), cache.runs_.data(),
+                                 static_cast<uint32_t>(cache.runs_.size()));
+}
 }  // namespace tttext
 }  // namespace ttoffice
@@ -8,13 +8,18 @@
 #include <textra/tttext_context.h>
 
 #include <algorithm>
+#include <utility>
 
+#include "src/textlayout/internal/exclusion_space.h"
 #include "src/textlayout/internal/line_range.h"
 #include "src/textlayout/layout_measurer.h"
 #include "src/textlayout/paragraph_impl.h"
 #include "src/textlayout/run/object_run.h"
 #include "src/textlayout/style/style_manager.h"
+#include "src/textlayout/text_layout_impl.h"
 #include "src/textlayout/text_line_impl.h"
+#include "src/textlayout/utils/float_comparison.h"
+#include "src/textlayout/utils/log_util.h"
 namespace ttoffice {
 namespace tttext {
 LayoutRegion::LayoutRegion(float width, float height, LayoutMode width_mode,
@@ -38,32 +43,199 @@ std::vector<std::array<float, 2>> LayoutRegion::GetRangeList(float* top,
   std::vector<std::array<float, 2>> range_list;
   float range_start = 0 + start_indent;
   float range_end = size_.first - end_indent;
-  range_list.emplace_back(std::array<float, 2>{range_start, range_end});
-  *top = *top + 1;
+  if (exclusion_space_ == nullptr ||
+      !exclusion_space_->GetAvailableRanges(*top, range_height, range_start,
+                                            range_end, &range_list, top)) {
+    range_list.clear();
+    range_list.emplace_back(std::array<float, 2>{range_start, range_end});
+    *top = *top + 1;
+    return range_list;
+  }
+  if (range_list.empty()) {
+    // fully covered, an empty range makes the line move below the exclusions
+    range_list.emplace_back(std::array<float, 2>{range_start, range_start});
+  }
   return range_list;
 }
+bool LayoutRegion::RangeListMayChange(float top, float height,
+                                      float new_height) const {
+  return exclusion_space_ != nullptr &&
+         exclusion_space_->HasExclusionStartingIn(top + height,
+                                                  top + new_height);
+}
 std::pair<LayoutResult, bool> LayoutRegion::ProcessFloatObject(
     const TTTextContext& context, const BaseRun& run, int char_x,
     float line_y) {
-  return {LayoutResult::kNormal, false};
+  auto* delegate = run.GetRunDelegate();
+  if (delegate == nullptr ||
+      !placed_floats_.emplace(run.GetParagraph(), run.GetStartCharPos())
+           .second) {
+    return {LayoutResult::kNormal, false};
+  }
+  const auto x = static_cast<float>(char_x);
+  delegate->SetOffset(x, line_y);
+  AddExclusion(x, line_y, delegate->GetAdvance(),
+               delegate->GetDescent() - delegate->GetAscent());
+  return {LayoutResult::kNormal, true};
+}
+void LayoutRegion::AddExclusionRect(float left, float top, float width,
+                                    float height) {
+  exclusion_rects_.push_back({left, top, width, height});
+  AddExclusion(left, top, width, height);
+}
+void LayoutRegion::AddExclusion(float left, float top, float width,
+                                float height) {
+  if (exclusion_space_ == nullptr) {
+    exclusion_space_ = std::make_unique<ExclusionSpace>();
+  }
+  exclusion_space_->AddExclusion({left, top, left + width, top + height});
+}
+void LayoutRegion::Reset() {
+  paragraph_list_.clear();
+  line_lst_.clear();
+  line_records_.clear();
+  materialized_lines_.clear();
+  materialized_line_map_.clear();
+  full_filled_ = false;
+  exceeded_max_lines_ = false;
+  last_line_stripped_ = false;
+  layouted_width_ = 0;
+  layouted_bottom_ = 0;
+  InvalidateDisplayList();
+  placed_floats_.clear();
+  if (exclusion_space_ != nullptr) {
+    exclusion_space_->Clear();
+    for (const auto& rect : exclusion_rects_) {
+      exclusion_space_->AddExclusion(
+          {rect[0], rect[1], rect[0] + rect[2], rect[1] + rect[3]});
+    }
+  }
 }
 LayoutResult LayoutRegion::AddLine(std::unique_ptr<TextLine> line,
                                    const TTTextContext& context) {
   auto* line_impl = TTDYNAMIC_CAST<TextLineImpl*>(line.get());
   UpdateLayoutedSize(line.get(), context);
+  InvalidateDisplayList();
   if (paragraph_list_.empty() ||
       line_impl->GetParagraph() != paragraph_list_.back()) {
     paragraph_list_.emplace_back(line->GetParagraph());
   }
-  line_lst_.emplace_back(std::move(line));
+  auto* added_line = line.get();
+  if (IsVirtualized()) {
+    static_assert(sizeof(LineRecord) == 24,
+                  "a virtualized line should stay compact");
+    line_context_.SetLastLineCanOverflow(context.IsLastLineCanOverflow());
+    line_context_.SetSkipSpacingBeforeFirstLine(
+        context.IsSkipSpacingBeforeFirstLine());
+    const auto& start = line_impl->GetStartLayoutPosition();
+    line_records_.push_back(
+        {static_cast<uint32_t>(paragraph_list_.size() - 1), start.GetRunIdx(),
+         start.GetCharIdx(), line->GetLineTop(), line->GetLineHeight(),
+         line->GetLineBaseLine()});
+    CacheMaterializedLine(GetLineCount() - 1, std::move(line));
+  } else {
+    line_lst_.emplace_back(std::move(line));
+  }
   LayoutResult result = LayoutResult::kNormal;
   if (listener_ != nullptr) {
     listener_->OnLineLayouted(this, GetLineCount() - 1,
-                              line_lst_.back()->IsLastLineOfParagraph(),
+                              added_line->IsLastLineOfParagraph(),
                               GetPageHeight() - layouted_bottom_, &result);
   }
   return result;
 }
+TextLine* LayoutRegion::GetLine(uint32_t idx) const {
+  if (idx >= GetLineCount()) return nullptr;
+  if (!IsVirtualized()) return line_lst_[idx].get();
+  for (const auto& [visiting_idx, line] : visiting_lines_) {
+    if (visiting_idx == idx) return line;
+  }
+  auto line = TakeMaterializedLine(idx);
+  auto* cached_line = line.get();
+  CacheMaterializedLine(idx, std::move(line));
+  return cached_line;
+}
+void LayoutRegion::VisitLines(uint32_t start, uint32_t end,
+                              const LineVisitor& visit) const {
+  end = std::min(end, GetLineCount());
+  for (auto idx = start; idx < end; idx++) {
+    if (!IsVirtualized()) {
+      if (!visit(idx, line_lst_[idx].get())) return;
+      continue;
+    }
+    auto visiting = std::find_if(
+        visiting_lines_.begin(), visiting_lines_.end(),
+        [idx](const std::pair<uint32_t, TextLine*>& visiting_line) {
+          return visiting_line.first == idx;
+        });
+    if (visiting != visiting_lines_.end()) {
+      if (!visit(idx, visiting->second)) return;
+      continue;
+    }
+    // kept out of the cache during the visit, so that lines the visit lays
+    // out do not release it
+    auto line = TakeMaterializedLine(idx);
+    visiting_lines_.emplace_back(idx, line.get());
+    const bool go_on = visit(idx, line.get());
+    visiting_lines_.pop_back();
+    CacheMaterializedLine(idx, std::move(line));
+    if (!go_on) return;
+  }
+}
+uint32_t LayoutRegion::FindLineIndexByY(float y) const {
+  if (IsVirtualized()) {
+    auto iter = std::upper_bound(line_records_.begin(), line_records_.end(), y,
+                                 [](float y, const LineRecord& record) {
+                                   return y < record.top_ + record.height_;
+                                 });
+    return static_cast<uint32_t>(iter - line_records_.begin());
+  }
+  auto iter = std::upper_bound(
+      line_lst_.begin(), line_lst_.end(), y,
+      [](float y, const std::unique_ptr<TextLine>& line) {
+        return y < line->GetLineBottom();
+      });
+  return static_cast<uint32_t>(iter - line_lst_.begin());
+}
+std::unique_ptr<TextLine> LayoutRegion::MaterializeLine(uint32_t idx) const {
+  const auto& record = line_records_[idx];
+  auto* paragraph =
+      TTDYNAMIC_CAST<ParagraphImpl*>(paragraph_list_[record.paragraph_idx_]);
+  materializing_line_idx_ = idx;
+  auto line = TextLayoutImpl::LayoutLine(
+      paragraph, const_cast<LayoutRegion*>(this),
+      LayoutPosition{record.run_idx_, record.char_idx_}, record.top_,
+      line_context_);
+  materializing_line_idx_ = UINT32_MAX;
+  if (!FloatsEqual(line->GetLineHeight(), record.height_)) {
+    // the paragraph changed after layout, the line keeps its recorded top
+    // and may overlap the next one until the region is laid out again
+    LogUtil::W("LayoutRegion line:%u height:%f differs from layout:%f", idx,
+               line->GetLineHeight(), record.height_);
+  }
+  if (last_line_stripped_ && idx + 1 == GetLineCount()) {
+    line->StripByEllipsis(nullptr);
+  }
+  return line;
+}
+std::unique_ptr<TextLine> LayoutRegion::TakeMaterializedLine(
+    uint32_t idx) const {
+  auto iter = materialized_line_map_.find(idx);
+  if (iter == materialized_line_map_.end()) return MaterializeLine(idx);
+  auto line = std::move(iter->second->second);
+  materialized_lines_.erase(iter->second);
+  materialized_line_map_.erase(iter);
+  return line;
+}
+void LayoutRegion::CacheMaterializedLine(
+    uint32_t idx, std::unique_ptr<TextLine> line) const {
+  materialized_lines_.emplace_front(idx, std::move(line));
+  materialized_line_map_[idx] = materialized_lines_.begin();
+  while (materialized_lines_.size() > max_materialized_lines_) {
+    materialized_line_map_.erase(materialized_lines_.back().first);
+    materialized_lines_.pop_back();
+  }
+}
 void LayoutRegion::UpdateLayoutedSize(TextLine* line,
                                       const TTTextContext& context) {
   float line_left = line->GetLineLeft() - line->GetStartIndent();
@@ -0,0 +1,166 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <textra/layout_definition.h>
+#include <textra/layout_region_distribute.h>
+#include <textra/text_layout.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/textlayout/layout_position.h"
+#include "src/textlayout/paragraph_impl.h"
+#include "src/textlayout/utils/float_comparison.h"
+
+namespace ttoffice {
+namespace tttext {
+namespace {
+constexpr uint32_t kBalanceIterations = 32;
+}  // namespace
+LayoutRegionDistribute::LayoutRegionDistribute(
+    const TextLayout* layout, std::vector<Paragraph*> paragraphs)
+    : layout_(layout),
+      paragraphs_(paragraphs),
+      paginator_(layout, std::move(paragraphs), 0, 0) {}
+LayoutRegionDistribute::~LayoutRegionDistribute() = default;
+
+void LayoutRegionDistribute::AddRegion(float width, float height) {
+  region_sizes_.emplace_back(width, height);
+}
+bool LayoutRegionDistribute::Layout() { return LayoutFrom(0); }
+bool LayoutRegionDistribute::ResizeRegion(uint32_t region_idx, float width,
+                                          float height) {
+  if (region_idx >= GetRegionCount()) return !HasOverflow();
+  region_sizes_[region_idx] = {width, height};
+  return LayoutFrom(region_idx);
+}
+bool LayoutRegionDistribute::LayoutFrom(uint32_t region_idx) {
+  regions_.resize(GetRegionCount());
+  // the start of a region is only known once the regions before it are laid
+  // out
+  const auto& checkpoints = paginator_.GetPageCheckpoints();
+  region_idx = std::min(region_idx,
+                        static_cast<uint32_t>(checkpoints.size() - 1));
+  const auto checkpoint = checkpoints[region_idx];
+  paginator_.SeekTo(checkpoint, region_idx);
+  for (auto k = region_idx; k < GetRegionCount(); k++) {
+    const auto& size = region_sizes_[k];
+    paginator_.SetPageSize(size.first, size.second);
+    auto region = paginator_.NextPage();
+    if (region == nullptr) {
+      // nothing left, the following regions stay empty
+      region = std::make_unique<LayoutRegion>(size.first, size.second);
+    }
+    regions_[k] = std::move(region);
+  }
+  return !HasOverflow();
+}
+/**
+ * @brief Vertical space taken by each line when the paragraphs are laid out
+ * in a single column of the given width. Kept until the width, the layout
+ * configurations of the context or a paragraph change.
+ */
+const std::vector<float>& LayoutRegionDistribute::GetLineAdvances(
+    float width) {
+  const auto& config = GetContext();
+  std::vector<uint32_t> revisions;
+  revisions.reserve(paragraphs_.size());
+  for (auto* paragraph : paragraphs_) {
+    revisions.push_back(
+        TTDYNAMIC_CAST<ParagraphImpl*>(paragraph)->GetLayoutRevision());
+  }
+  if (FloatsEqual(width, line_advances_width_) &&
+      config.IsLastLineCanOverflow() == line_advances_can_overflow_ &&
+      config.IsSkipSpacingBeforeFirstLine() == line_advances_skip_spacing_ &&
+      revisions == line_advances_revisions_) {
+    return line_advances_;
+  }
+  line_advances_.clear();
+  line_advances_width_ = width;
+  line_advances_can_overflow_ = config.IsLastLineCanOverflow();
+  line_advances_skip_spacing_ = config.IsSkipSpacingBeforeFirstLine();
+  LayoutRegion region(width, LAYOUT_MAX_UNITS, LayoutMode::kDefinite,
+                      LayoutMode::kIndefinite);
+  TTTextContext context;
+  context.SetLastLineCanOverflow(line_advances_can_overflow_);
+  context.SetSkipSpacingBeforeFirstLine(line_advances_skip_spacing_);
+  context.SetMeasureOnly(true);
+  for (auto* paragraph : paragraphs_) {
+    context.ResetLayoutPosition(LayoutPosition{0, 0});
+    layout_->Layout(paragraph, &region, context);
+  }
+  // laying out may format the paragraphs, the revisions are read afterwards
+  line_advances_revisions_.clear();
+  for (auto* paragraph : paragraphs_) {
+    line_advances_revisions_.push_back(
+        TTDYNAMIC_CAST<ParagraphImpl*>(paragraph)->GetLayoutRevision());
+  }
+  float bottom = 0;
+  region.VisitLines(0, region.GetLineCount(), [&](uint32_t, TextLine* line) {
+    const auto line_bottom = line->GetLineBottom();
+    line_advances_.push_back(line_bottom - bottom);
+    bottom = line_bottom;
+    return true;
+  });
+  return line_advances_;
+}
+/**
+ * @brief Number of columns of the given height filled greedily by the
+ * measured lines. The first line of a column is counted with the spacing to
+ * the previous line, so the estimation never puts more lines in a column than
+ * the actual layout.
+ */
+uint32_t LayoutRegionDistribute::CountColumns(float height,
+                                              float* used_height) const {
+  uint32_t columns = 1;
+  float column = 0;
+  *used_height = 0;
+  for (auto advance : line_advances_) {
+    if (FloatsLarger(column, 0) && FloatsLarger(column + advance, height)) {
+      columns++;
+      column = 0;
+    }
+    column += advance;
+    *used_height = std::max(*used_height, column);
+  }
+  return columns;
+}
+float LayoutRegionDistribute::BalanceColumns(float max_height) {
+  if (GetRegionCount() == 0) return 0;
+  const auto width = region_sizes_[0].first;
+  const auto& advances = GetLineAdvances(width);
+  float height = max_height;
+  float used_height = 0;
+  if (!advances.empty() &&
+      CountColumns(max_height, &used_height) <= GetRegionCount()) {
+    float low = *std::max_element(advances.begin(), advances.end());
+    float high = max_height;
+    for (auto k = 0u; k < kBalanceIterations && FloatsLarger(high, low); k++) {
+      auto mid = (low + high) / 2;
+      if (CountColumns(mid, &used_height) <= GetRegionCount()) {
+        high = mid;
+      } else {
+        low = mid;
+      }
+    }
+    CountColumns(high, &used_height);
+    height = std::min(used_height, max_height);
+  }
+
+  auto& context = GetContext();
+  const auto can_overflow = context.IsLastLineCanOverflow();
+  context.SetLastLineCanOverflow(false);
+  for (auto& size : region_sizes_) size.second = height;
+  if (!LayoutFrom(0) && FloatsLarger(max_height, height)) {
+    height = max_height;
+    for (auto& size : region_sizes_) size.second = height;
+    LayoutFrom(0);
+  }
+  context.SetLastLineCanOverflow(can_overflow);
+  return height;
+}
+}  // namespace tttext
+}  // namespace ttoffice
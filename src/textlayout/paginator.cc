@@ -0,0 +1,152 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <textra/paginator.h>
+#include <textra/paragraph.h>
+#include <textra/text_layout.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/textlayout/layout_position.h"
+#include "src/textlayout/utils/little_endian.h"
+#include "src/textlayout/utils/log_util.h"
+
+namespace ttoffice {
+namespace tttext {
+namespace {
+constexpr uint8_t kCheckpointVersion = 1;
+constexpr size_t kCheckpointSize =
+    1 + 3 * sizeof(uint32_t) + 2 * sizeof(float);
+}  // namespace
+
+bool PageCheckpoint::operator==(const PageCheckpoint& other) const {
+  return paragraph_idx_ == other.paragraph_idx_ && run_idx_ == other.run_idx_ &&
+         char_idx_ == other.char_idx_ &&
+         paragraph_space_ == other.paragraph_space_ &&
+         line_space_ == other.line_space_;
+}
+std::string PageCheckpoint::Serialize() const {
+  std::string data;
+  data.reserve(kCheckpointSize);
+  data.push_back(static_cast<char>(kCheckpointVersion));
+  little_endian::Append(&data, paragraph_idx_);
+  little_endian::Append(&data, run_idx_);
+  little_endian::Append(&data, char_idx_);
+  little_endian::Append(&data, paragraph_space_);
+  little_endian::Append(&data, line_space_);
+  return data;
+}
+bool PageCheckpoint::Deserialize(const std::string& data,
+                                 PageCheckpoint* checkpoint) {
+  if (checkpoint == nullptr || data.size() != kCheckpointSize ||
+      static_cast<uint8_t>(data[0]) != kCheckpointVersion) {
+    return false;
+  }
+  const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+  size_t offset = 1;
+  checkpoint->paragraph_idx_ = little_endian::Read<uint32_t>(bytes, &offset);
+  checkpoint->run_idx_ = little_endian::Read<uint32_t>(bytes, &offset);
+  checkpoint->char_idx_ = little_endian::Read<uint32_t>(bytes, &offset);
+  checkpoint->paragraph_space_ = little_endian::Read<float>(bytes, &offset);
+  checkpoint->line_space_ = little_endian::Read<float>(bytes, &offset);
+  return true;
+}
+
+Paginator::Paginator(const TextLayout* layout,
+                     std::vector<Paragraph*> paragraphs, float page_width,
+                     float page_height)
+    : layout_(layout),
+      paragraphs_(std::move(paragraphs)),
+      page_width_(page_width),
+      page_height_(page_height) {
+  TTASSERT(layout_ != nullptr);
+  page_checkpoints_.push_back(checkpoint_);
+}
+Paginator::~Paginator() = default;
+
+bool Paginator::HasNextPage() const {
+  return checkpoint_.paragraph_idx_ < paragraphs_.size();
+}
+void Paginator::RestoreContext() {
+  context_.Reset();
+  context_.ResetLayoutPosition(
+      LayoutPosition{checkpoint_.run_idx_, checkpoint_.char_idx_});
+  context_.SetParagraphSpace(checkpoint_.paragraph_space_);
+  context_.SetLineSpace(checkpoint_.line_space_);
+}
+std::unique_ptr<LayoutRegion> Paginator::NextPage() {
+  if (!HasNextPage() || page_width_ <= 0 || page_height_ <= 0) return nullptr;
+  auto page = std::make_unique<LayoutRegion>(page_width_, page_height_);
+  RestoreContext();
+  auto para_idx = checkpoint_.paragraph_idx_;
+  while (para_idx < paragraphs_.size()) {
+    auto* para = paragraphs_[para_idx];
+    auto result = layout_->Layout(para, page.get(), context_);
+    if (context_.GetPositionRef().GetRunIdx() >= para->GetRunCount()) {
+      para_idx++;
+      context_.ResetLayoutPosition(LayoutPosition{0, 0});
+    }
+    if (result == LayoutResult::kBreakPage || page->IsFullFilled()) break;
+  }
+
+  PageCheckpoint next;
+  next.paragraph_idx_ = para_idx;
+  next.run_idx_ = context_.GetPositionRef().GetRunIdx();
+  next.char_idx_ = context_.GetPositionRef().GetCharIdx();
+  next.paragraph_space_ = context_.GetParagraphGap();
+  next.line_space_ = context_.GetLineSpace();
+  if (next == checkpoint_) {
+    // The first line does not fit in an empty page. Keep it anyway, otherwise
+    // the same page would be laid out forever.
+    LogUtil::E("Paginator: page %u is too small for its first line",
+               page_idx_);
+    const bool can_overflow = context_.IsLastLineCanOverflow();
+    context_.SetLastLineCanOverflow(true);
+    page = std::make_unique<LayoutRegion>(page_width_, page_height_);
+    RestoreContext();
+    auto* para = paragraphs_[checkpoint_.paragraph_idx_];
+    layout_->Layout(para, page.get(), context_);
+    context_.SetLastLineCanOverflow(can_overflow);
+    next.run_idx_ = context_.GetPositionRef().GetRunIdx();
+    next.char_idx_ = context_.GetPositionRef().GetCharIdx();
+    if (next.run_idx_ >= para->GetRunCount() || next == checkpoint_) {
+      next.paragraph_idx_++;
+      next.run_idx_ = 0;
+      next.char_idx_ = 0;
+    }
+  }
+
+  checkpoint_ = next;
+  page_idx_++;
+  if (page_idx_ == page_checkpoints_.size()) {
+    page_checkpoints_.push_back(checkpoint_);
+  }
+  return page;
+}
+std::unique_ptr<LayoutRegion> Paginator::LayoutPage(uint32_t page_idx) {
+  const auto known = std::min(
+      page_idx, static_cast<uint32_t>(page_checkpoints_.size() - 1));
+  checkpoint_ = page_checkpoints_[known];
+  page_idx_ = known;
+  while (page_idx_ < page_idx && HasNextPage()) {
+    NextPage();
+  }
+  return page_idx_ == page_idx ? NextPage() : nullptr;
+}
+void Paginator::SeekTo(const PageCheckpoint& checkpoint, uint32_t page_idx) {
+  checkpoint_ = checkpoint;
+  page_idx_ = page_idx;
+  // Pages after a seek are recorded only while the index stays contiguous
+  // with the known ones.
+  if (page_idx_ < page_checkpoints_.size()) {
+    page_checkpoints_.resize(page_idx_ + 1);
+    page_checkpoints_[page_idx_] = checkpoint_;
+  }
+}
+}  // namespace tttext
+}  // namespace ttoffice
@@ -4,19 +4,26 @@
 
 #include "src/textlayout/paragraph_impl.h"
 
+#include <textra/i_hyphenator.h>
 #include <textra/run_delegate.h>
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "src/textlayout/internal/boundary_analyst.h"
+#include "src/textlayout/internal/optimal_line_breaker.h"
 #include "src/textlayout/layout_position.h"
 #include "src/textlayout/run/ghost_run.h"
 #include "src/textlayout/run/object_run.h"
 #include "src/textlayout/shape_cache.h"
+#include "src/textlayout/style_attributes.h"
 #include "src/textlayout/tt_shaper.h"
+#include "src/textlayout/utils/float_comparison.h"
 #include "src/textlayout/utils/u_8_string.h"
 #include "style/style_manager.h"
 
@@ -56,8 +63,60 @@ void ParagraphImpl::AddTextRun(const Style& style, const char* content,
                                       end_char_pos - start_char_pos);
     run_lst_.emplace_back(std::make_unique<BaseRun>(
         this, style, start_char_pos, end_char_pos, RunType::kTextRun));
+    InvalidateLayoutCaches();
   }
 }
+void ParagraphImpl::AddTextRuns(const char* content, uint32_t length,
+                                const TextSpan* spans, uint32_t span_count,
+                                const Style* const* styles,
+                                uint32_t style_count) {
+  if (content == nullptr || spans == nullptr || span_count == 0) return;
+  if (!base::CheckValidUTF8String(content, length)) {
+    LogUtil::E("textlayout AddTextRuns discard not valid utf8 buffer");
+    return;
+  }
+  auto is_boundary = [content, length](uint32_t offset) {
+    return offset == length || base::IsUtf8CharStart(content + offset);
+  };
+  // pass 1: the text of the valid spans and their char counts
+  std::string text;
+  text.reserve(length);
+  std::vector<std::pair<const TextSpan*, uint32_t>> valid_spans;
+  valid_spans.reserve(span_count);
+  uint32_t min_offset = 0;
+  for (auto k = 0u; k < span_count; k++) {
+    const auto& span = spans[k];
+    if (span.length_ == 0 || span.offset_ < min_offset ||
+        span.offset_ > length || span.length_ > length - span.offset_ ||
+        span.style_idx_ >= style_count || !is_boundary(span.offset_) ||
+        !is_boundary(span.offset_ + span.length_)) {
+      LogUtil::W("textlayout AddTextRuns discard span:%u", k);
+      continue;
+    }
+    min_offset = span.offset_ + span.length_;
+    text.append(content + span.offset_, span.length_);
+    valid_spans.emplace_back(
+        &span, static_cast<uint32_t>(base::CalcCharCount(
+                   content + span.offset_, static_cast<int>(span.length_))));
+  }
+  if (valid_spans.empty()) return;
+
+  // pass 2: content, style ranges and runs
+  auto char_pos = GetCharCount();
+  AddTextContent(text);
+  run_lst_.reserve(run_lst_.size() + valid_spans.size());
+  for (auto& [span, char_count] : valid_spans) {
+    const auto* style = styles[span->style_idx_];
+    const auto& run_style =
+        style == nullptr ? paragraph_style_.GetDefaultStyle() : *style;
+    style_manager_->AppendStyleInRange(run_style, char_pos, char_count);
+    run_lst_.emplace_back(std::make_unique<BaseRun>(
+        this, run_style, char_pos, char_pos + char_count, RunType::kTextRun));
+    char_pos += char_count;
+  }
+  TTASSERT(char_pos == GetCharCount());
+  InvalidateLayoutCaches();
+}
 /**
  * @brief Append a ObjectRun to paragraph, backed by the Style and RunDelegate.
  *
@@ -65,7 +124,9 @@ void ParagraphImpl::AddTextRun(const Style& style, const char* content,
  * @param shape
  * @param need_placeholder True to append U+FFFC (Object Replacement Character)
  * to the text content.
- * @param is_float unused
+ * @param is_float True to take the object out of the text flow, layout places
+ * it with LayoutRegion::ProcessFloatObject() at the line it is reached in and
+ * the following text flows around it.
  * @param offset_y unused
  */
 void ParagraphImpl::AddShapeRun(const Style& style,
@@ -77,10 +138,11 @@ void ParagraphImpl::AddShapeRun(const Style& style,
       this, std::move(shape), start_char_pos,
       need_placeholder ? AddTextContent(BaseRun::ObjectReplacementCharacter())
                        : start_char_pos,
-      RunType::kInlineObject);
+      is_float ? RunType::kFloatObject : RunType::kInlineObject);
   run->layout_style_ = style;
   style_manager_->ApplyStyleInRange(style, start_char_pos, 1);
   run_lst_.emplace_back(std::move(run));
+  InvalidateLayoutCaches();
 }
 bool ParagraphImpl::SplitRun(uint32_t idx, uint32_t char_pos_in_run) {
   auto* run = run_lst_[idx].get();
@@ -104,6 +166,10 @@ void ParagraphImpl::FormatRunList() {
       AddTextRun(nullptr, "\n", 1);
     }
     TTASSERT(!content_.Empty() || !run_lst_.empty());
+    optimal_breaks_.clear();
+    optimal_breaks_width_[0] = optimal_breaks_width_[1] = -1;
+    min_intrinsic_width_ = max_intrinsic_width_ = -1;
+    measured_sizes_.clear();
     auto u32_content = content_.ToUTF32();
     boundary_analyst_ = std::make_unique<BoundaryAnalyst>(
         u32_content.data(), u32_content.length(),
@@ -111,13 +177,17 @@ void ParagraphImpl::FormatRunList() {
     TTASSERT(u32_content.length() == GetCharCount());
 
     std::vector<bool> must_split_run_pos(GetCharCount(), false);
-    visual_map_.resize(GetCharCount(), 0);
-    logical_map_.resize(GetCharCount(), 0);
-    bidi_level_.resize(GetCharCount(), 0);
-    shaper_->ProcessBidirection(
-        u32_content.data(), static_cast<uint32_t>(u32_content.length()),
-        paragraph_style_.GetWriteDirection(), visual_map_.data(),
-        logical_map_.data(), bidi_level_.data());
+    {
+      // the per character buffers only live until the run table is built
+      std::vector<uint32_t> visual_map(GetCharCount(), 0);
+      std::vector<uint32_t> logical_map(GetCharCount(), 0);
+      std::vector<uint8_t> bidi_level(GetCharCount(), 0);
+      shaper_->ProcessBidirection(
+          u32_content.data(), static_cast<uint32_t>(u32_content.length()),
+          paragraph_style_.GetWriteDirection(), visual_map.data(),
+          logical_map.data(), bidi_level.data());
+      bidi_run_table_.Build(bidi_level.data(), GetCharCount());
+    }
 
     bool need_split = false;
     for (auto k = 0u; k + 1 < GetCharCount(); k++) {
@@ -130,13 +200,21 @@ void ParagraphImpl::FormatRunList() {
         must_split_run_pos[k] = true;
         need_split = true;
       }
-      // split text with different bidirection
-      if (IsRtlCharacter(k) != IsRtlCharacter(k + 1)) {
-        boundary_analyst_->UpgradeBoundaryType(Range::MakeLW(k, 1),
-                                               BoundaryType::kLineBreakable);
-        must_split_run_pos[k] = true;
-        need_split = true;
+    }
+    // split text with different bidirection
+    for (auto r = 0u; r + 1 < bidi_run_table_.GetRunCount(); r++) {
+      const auto& bidi_run = bidi_run_table_.GetRun(r);
+      if (bidi_run.level_ % 2 == bidi_run_table_.GetRun(r + 1).level_ % 2) {
+        continue;
       }
+      auto k = bidi_run.end_ - 1;
+      boundary_analyst_->UpgradeBoundaryType(Range::MakeLW(k, 1),
+                                             BoundaryType::kLineBreakable);
+      must_split_run_pos[k] = true;
+      need_split = true;
+    }
+    if (paragraph_style_.GetHyphenator() != nullptr) {
+      ProcessHyphenation(u32_content);
     }
 
     auto idx = 0u;
@@ -312,6 +390,16 @@ bool ParagraphImpl::IsFirstCharOfParagraph(uint32_t char_pos) const {
   return boundary_analyst_->GetBoundaryTypeBefore(char_pos) ==
          BoundaryType::kParagraph;
 }
+uint8_t ParagraphImpl::GetParagraphBidiLevel() const {
+  const auto direction = paragraph_style_.GetWriteDirection();
+  TTASSERT(direction != WriteDirection::kTTB &&
+           direction != WriteDirection::kBTT);
+  if (direction == WriteDirection::kAuto) {
+    // Follow the way of paragraph direction detection in Lynx
+    return GetCharCount() > 0 && IsRtlCharacter(0) ? 1 : 0;
+  }
+  return direction == WriteDirection::kRTL ? 1 : 0;
+}
 LayoutPosition ParagraphImpl::FindNextBoundary(const LayoutPosition& start,
                                                const BoundaryType& type) const {
   auto* run = GetRun(start.GetRunIdx());
@@ -388,40 +476,147 @@ BoundaryType ParagraphImpl::GetBoundaryType(
 void ParagraphImpl::ApplyStyleInRange(const Style& style, const CharPos start,
                                       const uint32_t len) const {
   style_manager_->ApplyStyleInRange(style, start, len);
+  InvalidateLayoutCaches();
 }
 float ParagraphImpl::GetMaxIntrinsicWidth() const {
   if (!formated_) return 0;
+  if (max_intrinsic_width_ < 0) UpdateIntrinsicWidths();
+  return max_intrinsic_width_;
+}
+float ParagraphImpl::GetMinIntrinsicWidth() const {
+  if (!formated_) return 0;
+  if (min_intrinsic_width_ < 0) UpdateIntrinsicWidths();
+  return min_intrinsic_width_;
+}
+/**
+ * @brief Computes both intrinsic widths in one pass over the char advances.
+ * The min-content width is the widest segment between two kLineBreakable
+ * boundaries without its trailing spaces, which hang outside of the line. The
+ * max-content width is the widest segment between two hard breaks.
+ */
+void ParagraphImpl::UpdateIntrinsicWidths() const {
+  float min_width = 0;
   float max_width = 0;
-  float tmp_width = 0;
-  uint32_t start_pos = 0;
-  auto next_hard_break_pos =
-      boundary_analyst_->FindNextBoundary(0, BoundaryType::kMustLineBreak);
-  auto iter = run_lst_.begin();
-  while (iter != run_lst_.end()) {
-    auto& run = *iter;
-    auto piece_start_pos = std::max(start_pos, run->GetStartCharPos());
-    auto piece_end_pos = std::min(next_hard_break_pos, run->GetEndCharPos());
-    if (piece_end_pos > piece_start_pos) {
-      tmp_width += run->GetWidth(piece_start_pos - run->GetStartCharPos(),
-                                 piece_end_pos - piece_start_pos);
-    }
-    if (piece_end_pos == next_hard_break_pos) {
-      max_width = std::fmax(max_width, tmp_width);
-      start_pos = next_hard_break_pos;
-      next_hard_break_pos = boundary_analyst_->FindNextBoundary(
-          next_hard_break_pos, BoundaryType::kMustLineBreak);
-      tmp_width = 0;
+  float word_width = 0;
+  float word_content_width = 0;
+  float line_width = 0;
+  for (const auto& run : run_lst_) {
+    if (run->IsGhostRun() || run->IsBlockRun()) continue;
+    for (auto k = 0u; k < run->GetCharCount(); k++) {
+      const auto char_pos = run->GetStartCharPos() + k;
+      const auto advance = run->GetCharAdvance(k);
+      word_width += advance;
+      line_width += advance;
+      if (!base::IsSpaceChar(content_.GetUnicode(char_pos))) {
+        word_content_width = word_width;
+      }
+      const auto boundary = boundary_analyst_->GetBoundaryType(char_pos);
+      if (boundary >= BoundaryType::kLineBreakable) {
+        min_width = std::max(min_width, word_content_width);
+        word_width = word_content_width = 0;
+      }
+      if (boundary >= BoundaryType::kMustLineBreak) {
+        max_width = std::max(max_width, line_width);
+        line_width = 0;
+      }
     }
-    if (run->GetEndCharPos() == piece_end_pos) {
-      ++iter;
+  }
+  min_intrinsic_width_ = std::max(min_width, word_content_width);
+  max_intrinsic_width_ = std::max(max_width, line_width);
+}
+bool ParagraphImpl::FindMeasuredSize(float width,
+                                     std::pair<float, float>* size) const {
+  if (!formated_ || measured_sizes_.empty() ||
+      !IsSameLayoutStyle(*measured_style_, paragraph_style_)) {
+    return false;
+  }
+  for (const auto& measured : measured_sizes_) {
+    if (FloatsEqual(measured.width_, width)) {
+      *size = measured.size_;
+      return true;
     }
   }
-  return max_width;
+  return false;
 }
-float ParagraphImpl::GetMinIntrinsicWidth() const {
-  if (!formated_) return 0;
-  TTASSERT(false);
-  return 0;
+void ParagraphImpl::AddMeasuredSize(float width,
+                                    const std::pair<float, float>& size) {
+  if (measured_style_ == nullptr) {
+    measured_style_ = std::make_unique<ParagraphStyle>(paragraph_style_);
+  } else if (!IsSameLayoutStyle(*measured_style_, paragraph_style_)) {
+    measured_sizes_.clear();
+    *measured_style_ = paragraph_style_;
+  }
+  // a host usually tries a few widths per frame, keep the latest ones
+  static constexpr uint32_t kMaxMeasuredSizeCount = 8;
+  if (measured_sizes_.size() >= kMaxMeasuredSizeCount) {
+    measured_sizes_.erase(measured_sizes_.begin());
+  }
+  measured_sizes_.push_back({width, size});
+}
+uint32_t ParagraphImpl::GetLayoutRevision() const {
+  // the style may have been changed through GetParagraphStyle()
+  if (revision_style_ == nullptr) {
+    revision_style_ = std::make_unique<ParagraphStyle>(paragraph_style_);
+  } else if (!IsSameLayoutStyle(*revision_style_, paragraph_style_)) {
+    *revision_style_ = paragraph_style_;
+    layout_revision_++;
+  }
+  return layout_revision_;
+}
+bool ParagraphImpl::IsSameLayoutStyle(const ParagraphStyle& lhs,
+                                      const ParagraphStyle& rhs) {
+  // the default style takes part in layout through its metrics only, the
+  // paint attributes are left out
+  const auto& ls = lhs.default_style_;
+  const auto& rs = rhs.default_style_;
+  if (!(ls.GetFontDescriptor() == rs.GetFontDescriptor()) ||
+      ls.GetTextSize() != rs.GetTextSize() ||
+      ls.GetTextScale() != rs.GetTextScale() ||
+      ls.GetBold() != rs.GetBold() || ls.GetItalic() != rs.GetItalic() ||
+      ls.GetVerticalAlignment() != rs.GetVerticalAlignment() ||
+      ls.GetWordSpacing() != rs.GetWordSpacing() ||
+      ls.GetLetterSpacing() != rs.GetLetterSpacing() ||
+      ls.GetWordBreak() != rs.GetWordBreak() ||
+      ls.GetBaselineOffset() != rs.GetBaselineOffset()) {
+    return false;
+  }
+  const auto& li = *lhs.indent_;
+  const auto& ri = *rhs.indent_;
+  if (std::tie(li.start_, li.start_chars_, li.end_, li.end_chars_,
+               li.first_line_, li.first_line_chars_, li.hanging_,
+               li.hanging_chars_) !=
+      std::tie(ri.start_, ri.start_chars_, ri.end_, ri.end_chars_,
+               ri.first_line_, ri.first_line_chars_, ri.hanging_,
+               ri.hanging_chars_)) {
+    return false;
+  }
+  const auto& lsp = *lhs.spacing_;
+  const auto& rsp = *rhs.spacing_;
+  if (std::tie(lsp.after_auto_spacing_, lsp.before_auto_spacing_,
+               lsp.after_px_, lsp.before_px_, lsp.after_line_percent_,
+               lsp.before_line_percent_, lsp.line_px_, lsp.line_percent_,
+               lsp.line_rule_, lsp.line_space_before_px_,
+               lsp.line_space_after_px_) !=
+      std::tie(rsp.after_auto_spacing_, rsp.before_auto_spacing_,
+               rsp.after_px_, rsp.before_px_, rsp.after_line_percent_,
+               rsp.before_line_percent_, rsp.line_px_, rsp.line_percent_,
+               rsp.line_rule_, rsp.line_space_before_px_,
+               rsp.line_space_after_px_)) {
+    return false;
+  }
+  return lhs.horizontal_alignment_ == rhs.horizontal_alignment_ &&
+         lhs.vertical_alignment_ == rhs.vertical_alignment_ &&
+         lhs.write_direction_ == rhs.write_direction_ &&
+         lhs.ellipsis_ == rhs.ellipsis_ &&
+         lhs.ellipsis_delegate_ == rhs.ellipsis_delegate_ &&
+         lhs.max_lines_ == rhs.max_lines_ &&
+         lhs.line_height_override_ == rhs.line_height_override_ &&
+         lhs.half_leading_ == rhs.half_leading_ &&
+         lhs.enable_text_bounds_ == rhs.enable_text_bounds_ &&
+         lhs.overflow_wrap_ == rhs.overflow_wrap_ &&
+         lhs.line_break_strategy_ == rhs.line_break_strategy_ &&
+         lhs.line_break_mode_ == rhs.line_break_mode_ &&
+         lhs.hyphenator_ == rhs.hyphenator_;
 }
 
 std::pair<uint32_t, uint32_t> ParagraphImpl::GetWordBoundary(
@@ -436,6 +631,52 @@ std::pair<uint32_t, uint32_t> ParagraphImpl::GetWordBoundary(
   return {start, end};
 }
 
+/**
+ * @brief Ask the hyphenator for break positions inside every word, a word is
+ * the content between two kLineBreakable boundaries without trailing spaces.
+ */
+void ParagraphImpl::ProcessHyphenation(const std::u32string& u32_content) {
+  const auto& hyphenator = paragraph_style_.GetHyphenator();
+  const auto char_count = static_cast<uint32_t>(u32_content.length());
+  std::unique_ptr<bool[]> breaks;
+  uint32_t breaks_capacity = 0;
+  auto word_start = 0u;
+  while (word_start < char_count) {
+    auto word_end = boundary_analyst_->FindNextBoundary(
+        word_start, BoundaryType::kLineBreakable);
+    if (word_end <= word_start || word_end > char_count) word_end = char_count;
+    auto next_word_start = word_end;
+    while (word_end > word_start &&
+           base::IsSpaceChar(u32_content[word_end - 1])) {
+      word_end--;
+    }
+    const auto length = word_end - word_start;
+    if (length > 1) {
+      if (length > breaks_capacity) {
+        breaks_capacity = length;
+        breaks = std::make_unique<bool[]>(breaks_capacity);
+      }
+      std::fill(breaks.get(), breaks.get() + length, false);
+      hyphenator->Hyphenate(u32_content.data() + word_start, length,
+                            breaks.get());
+      for (auto k = 1u; k < length; k++) {
+        if (breaks[k]) boundary_analyst_->SetHyphenBreakBefore(word_start + k);
+      }
+    }
+    word_start = next_word_start;
+  }
+}
+const std::vector<uint32_t>& ParagraphImpl::GetOptimalBreaks(
+    float first_line_width, float line_width) const {
+  if (!FloatsEqual(optimal_breaks_width_[0], first_line_width) ||
+      !FloatsEqual(optimal_breaks_width_[1], line_width)) {
+    optimal_breaks_ = OptimalLineBreaker::ComputeBreaks(
+        *this, first_line_width, line_width);
+    optimal_breaks_width_[0] = first_line_width;
+    optimal_breaks_width_[1] = line_width;
+  }
+  return optimal_breaks_;
+}
 RunDelegate* ParagraphImpl::GetRunDelegateForChar(uint32_t char_index) const {
   auto pos = CharPosToLayoutPosition(char_index);
   auto run = GetRun(pos.GetRunIdx());
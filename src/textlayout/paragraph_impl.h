@@ -17,6 +17,7 @@
 #include <utility>
 #include <vector>
 
+#include "src/textlayout/internal/bidi_run_table.h"
 #include "src/textlayout/layout_position.h"
 #include "src/textlayout/utils/tt_string.h"
 #include "src/textlayout/utils/tt_string_piece.h"
@@ -45,6 +46,7 @@ class ShaperSkShaper;
 class FontmgrCollection;
 class TTTextContext;
 class TextLineImpl;
+class OptimalLineBreaker;
 enum class LineBreakType : uint8_t;
 enum class RunType : uint8_t;
 enum class WriteDirection : uint8_t;
@@ -60,6 +62,7 @@ class ParagraphImpl : public Paragraph {
   friend RegionPosition;
   friend LayoutDrawer;
   friend ParagraphTest;
+  friend OptimalLineBreaker;
 
  public:
   ParagraphImpl();
@@ -75,6 +78,7 @@ class ParagraphImpl : public Paragraph {
   }
   void SetParagraphStyle(const ParagraphStyle* paragraph_style) override {
     paragraph_style_ = *paragraph_style;
+    InvalidateLayoutCaches();
   }
   using Paragraph::AddTextRun;
   void AddTextRun(const Style* style, const char* content,
@@ -82,6 +86,9 @@ class ParagraphImpl : public Paragraph {
     AddTextRun(style == nullptr ? paragraph_style_.GetDefaultStyle() : *style,
                content, length, false);
   }
+  void AddTextRuns(const char* content, uint32_t length,
+                   const TextSpan* spans, uint32_t span_count,
+                   const Style* const* styles, uint32_t style_count) override;
   void AddShapeRun(const Style* style, std::shared_ptr<RunDelegate> shape,
                    bool is_float) override {
     AddShapeRun(style == nullptr ? paragraph_style_.GetDefaultStyle() : *style,
@@ -126,14 +133,16 @@ class ParagraphImpl : public Paragraph {
   uint32_t LayoutPositionToCharPos(const LayoutPosition& pos) const;
   LayoutPosition CharPosToLayoutPosition(uint32_t char_pos) const;
   bool IsFirstCharOfParagraph(uint32_t char_pos) const;
-  uint32_t GetVisualOrder(uint32_t char_pos) const {
-    return char_pos < visual_map_.size() ? visual_map_[char_pos]
-                                         : visual_map_.back();
+  /**
+   * @brief Embedding level of the paragraph, 1 for a rtl paragraph. An auto
+   * direction follows the first character.
+   */
+  uint8_t GetParagraphBidiLevel() const;
+  uint8_t GetBidiLevel(CharPos pos) const {
+    return bidi_run_table_.GetLevel(pos);
   }
   bool IsRtlCharacter(CharPos pos) const {
-    auto level = pos < bidi_level_.size() ? bidi_level_[pos]
-                                          : bidi_level_[bidi_level_.size() - 1];
-    return level % 2 == 1;
+    return bidi_run_table_.IsRtl(pos);
   }
   LayoutPosition FindNextBoundary(const LayoutPosition& start,
                                   const BoundaryType& type) const;
@@ -144,6 +153,25 @@ class ParagraphImpl : public Paragraph {
   void SetShaper(TTShaper* shaper) { shaper_ = shaper; }
   void ClearLayout() { formated_ = false; }
   RunDelegate* GetRunDelegateForChar(uint32_t char_index) const;
+  /**
+   * @brief Line end positions chosen by OptimalLineBreaker, cached until the
+   * widths change or the paragraph is formatted again.
+   */
+  const std::vector<uint32_t>& GetOptimalBreaks(float first_line_width,
+                                                float line_width) const;
+  /**
+   * @brief Layouted {width, height} memoized by MeasureForWidth, keyed by the
+   * available width and the paragraph style the sizes were laid out with.
+   * @return whether a result was found, always false before formatting
+   */
+  bool FindMeasuredSize(float width, std::pair<float, float>* size) const;
+  void AddMeasuredSize(float width, const std::pair<float, float>& size);
+  /**
+   * @brief Changes whenever the content, the run styles or the layout
+   * attributes of the paragraph style change, so that callers can keep results
+   * derived from a layout of the paragraph.
+   */
+  uint32_t GetLayoutRevision() const;
 
  private:
   BaseRun* GetRun(uint32_t idx) const {
@@ -154,6 +182,15 @@ class ParagraphImpl : public Paragraph {
     return content_.GetCharCount();
   }
   bool SplitRun(uint32_t idx, uint32_t char_pos_in_run);
+  void ProcessHyphenation(const std::u32string& u32_content);
+  void UpdateIntrinsicWidths() const;
+  // the content or the styles changed
+  void InvalidateLayoutCaches() const {
+    measured_sizes_.clear();
+    layout_revision_++;
+  }
+  static bool IsSameLayoutStyle(const ParagraphStyle& lhs,
+                                const ParagraphStyle& rhs);
 
 #ifdef TTTEXT_DEBUG
   std::u32string GetContentWithGhost() const;
@@ -165,12 +202,25 @@ class ParagraphImpl : public Paragraph {
   TTString content_;
   std::unique_ptr<StyleManager> style_manager_;
   std::unique_ptr<BoundaryAnalyst> boundary_analyst_;
-  // even: ltr, odd: rtl
-  std::vector<uint8_t> bidi_level_;
-  std::vector<uint32_t> visual_map_;
-  std::vector<uint32_t> logical_map_;
+  // level runs of the paragraph, even: ltr, odd: rtl
+  BidiRunTable bidi_run_table_;
   std::vector<std::unique_ptr<BaseRun>> run_lst_;
   TTShaper* shaper_;
+  mutable std::vector<uint32_t> optimal_breaks_;
+  mutable float optimal_breaks_width_[2] = {-1, -1};
+  // min-content and max-content widths, negative until computed
+  mutable float min_intrinsic_width_ = -1;
+  mutable float max_intrinsic_width_ = -1;
+  struct MeasuredSize {
+    float width_;
+    std::pair<float, float> size_;
+  };
+  mutable std::vector<MeasuredSize> measured_sizes_;
+  // the style measured_sizes_ were laid out with
+  std::unique_ptr<ParagraphStyle> measured_style_;
+  mutable uint32_t layout_revision_ = 0;
+  // the style layout_revision_ was last returned with
+  mutable std::unique_ptr<ParagraphStyle> revision_style_;
 };
 }  // namespace tttext
 }  // namespace ttoffice
@@ -0,0 +1,230 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <textra/i_typeface_helper.h>
+#include <textra/recording_canvas_helper.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "src/textlayout/utils/little_endian.h"
+#include "src/textlayout/utils/log_util.h"
+
+namespace ttoffice {
+namespace tttext {
+RecordingCanvasHelper::RecordingCanvasHelper()
+    : result_(std::make_unique<FlatLayoutResult>()) {}
+RecordingCanvasHelper::~RecordingCanvasHelper() = default;
+
+std::unique_ptr<FlatLayoutResult> RecordingCanvasHelper::FinishRecording() {
+  auto result = std::move(result_);
+  result_ = std::make_unique<FlatLayoutResult>();
+  paint_index_.clear();
+  return result;
+}
+
+void RecordingCanvasHelper::Save() { AddOp(CanvasOp::kSave, nullptr, {}); }
+void RecordingCanvasHelper::Restore() {
+  AddOp(CanvasOp::kRestore, nullptr, {});
+}
+void RecordingCanvasHelper::Translate(float dx, float dy) {
+  AddOp(CanvasOp::kTranslate, nullptr, {dx, dy});
+}
+void RecordingCanvasHelper::Scale(float sx, float sy) {
+  AddOp(CanvasOp::kScale, nullptr, {sx, sy});
+}
+void RecordingCanvasHelper::Rotate(float degrees) {
+  AddOp(CanvasOp::kRotate, nullptr, {degrees});
+}
+void RecordingCanvasHelper::Skew(float sx, float sy) {
+  AddOp(CanvasOp::kSkew, nullptr, {sx, sy});
+}
+void RecordingCanvasHelper::ClipRect(float left, float top, float right,
+                                     float bottom, bool doAntiAlias) {
+  auto& op = AddOp(CanvasOp::kClipRect, nullptr, {left, top, right, bottom});
+  op.flags_ = doAntiAlias ? 1 : 0;
+}
+void RecordingCanvasHelper::Clear() { Drop(CanvasOp::kClear); }
+void RecordingCanvasHelper::ClearRect(float left, float top, float right,
+                                      float bottom) {
+  Drop(CanvasOp::kClearRect);
+}
+void RecordingCanvasHelper::FillRect(float left, float top, float right,
+                                     float bottom, uint32_t color) {
+  auto& op = AddOp(CanvasOp::kFillRect, nullptr, {left, top, right, bottom});
+  op.flags_ = color;
+}
+void RecordingCanvasHelper::DrawColor(uint32_t color) {
+  Drop(CanvasOp::kDrawColor);
+}
+void RecordingCanvasHelper::DrawLine(float x1, float y1, float x2, float y2,
+                                     Painter* painter) {
+  AddOp(CanvasOp::kDrawLine, painter, {x1, y1, x2, y2});
+}
+void RecordingCanvasHelper::DrawRect(float left, float top, float right,
+                                     float bottom, Painter* painter) {
+  AddOp(CanvasOp::kDrawRect, painter, {left, top, right, bottom});
+}
+void RecordingCanvasHelper::DrawOval(float left, float top, float right,
+                                     float bottom, Painter* painter) {
+  AddOp(CanvasOp::kDrawOval, painter, {left, top, right, bottom});
+}
+void RecordingCanvasHelper::DrawCircle(float x, float y, float radius,
+                                       Painter* painter) {
+  AddOp(CanvasOp::kDrawCircle, painter, {x, y, radius});
+}
+void RecordingCanvasHelper::DrawArc(float left, float top, float right,
+                                    float bottom, float startAngle,
+                                    float sweepAngle, bool useCenter,
+                                    Painter* painter) {
+  Drop(CanvasOp::kDrawArc);
+}
+void RecordingCanvasHelper::DrawPath(Path* path, Painter* painter) {
+  Drop(CanvasOp::kDrawPath);
+}
+void RecordingCanvasHelper::DrawArcTo(float start_x, float start_y,
+                                      float mid_x, float mid_y, float end_x,
+                                      float end_y, float radius,
+                                      Painter* painter) {
+  Drop(CanvasOp::kDrawArcTo);
+}
+void RecordingCanvasHelper::DrawText(const ITypefaceHelper* font,
+                                     const char* text, uint32_t text_bytes,
+                                     float x, float y, Painter* painter) {
+  auto& op = AddOp(CanvasOp::kDrawText, painter, {x, y});
+  op.typeface_id_ = AddTypeface(font);
+  op.data_start_ = AddString(text, text_bytes);
+  op.data_count_ = text != nullptr ? text_bytes : 0;
+}
+void RecordingCanvasHelper::DrawGlyphs(const ITypefaceHelper* font,
+                                       uint32_t glyph_count,
+                                       const uint16_t* glyphs,
+                                       const char* text, uint32_t text_bytes,
+                                       float origin_x, float origin_y,
+                                       float* x, float* y, Painter* painter) {
+  auto& op = AddOp(CanvasOp::kDrawGlyphs, painter, {origin_x, origin_y});
+  op.typeface_id_ = AddTypeface(font);
+  op.data_start_ = static_cast<uint32_t>(result_->glyphs_.size());
+  op.data_count_ = glyph_count;
+  op.flags_ = text_bytes;
+  result_->glyphs_.insert(result_->glyphs_.end(), glyphs,
+                          glyphs + glyph_count);
+  for (auto k = 0u; k < glyph_count; k++) {
+    result_->pos_x_.push_back(x != nullptr ? x[k] : 0);
+    result_->pos_y_.push_back(y != nullptr ? y[k] : 0);
+  }
+}
+void RecordingCanvasHelper::DrawRunDelegate(const RunDelegate* delegate,
+                                            float left, float top, float right,
+                                            float bottom, Painter* painter) {
+  Drop(CanvasOp::kDrawRunDelegate);
+}
+void RecordingCanvasHelper::DrawBackgroundDelegate(const RunDelegate* delegate,
+                                                   Painter* painter) {
+  Drop(CanvasOp::kDrawBackgroundDelegate);
+}
+void RecordingCanvasHelper::DrawImage(const char* src, float left, float top,
+                                      float right, float bottom,
+                                      Painter* painter) {
+  auto& op = AddOp(CanvasOp::kDrawImage, painter, {left, top, right, bottom});
+  op.data_count_ = src != nullptr ? static_cast<uint32_t>(strlen(src)) : 0;
+  op.data_start_ = AddString(src, op.data_count_);
+}
+void RecordingCanvasHelper::DrawImageRect(
+    const char* src, float src_left, float src_top, float src_right,
+    float src_bottom, float dst_left, float dst_top, float dst_right,
+    float dst_bottom, Painter* painter, bool srcRectPercent) {
+  Drop(CanvasOp::kDrawImageRect);
+}
+void RecordingCanvasHelper::DrawRoundRect(float left, float top, float right,
+                                          float bottom, float radius,
+                                          Painter* painter) {
+  AddOp(CanvasOp::kDrawRoundRect, painter, {left, top, right, bottom, radius});
+}
+
+FlatLayoutResult::Op& RecordingCanvasHelper::AddOp(
+    CanvasOp type, const Painter* painter,
+    std::initializer_list<float> values) {
+  TTASSERT(values.size() <= 5);
+  FlatLayoutResult::Op op{};
+  op.op_ = type;
+  op.paint_idx_ = AddPaint(painter);
+  std::copy(values.begin(), values.end(), op.values_);
+  result_->ops_.push_back(op);
+  return result_->ops_.back();
+}
+void RecordingCanvasHelper::Drop(CanvasOp type) {
+  LogUtil::W("RecordingCanvasHelper drops canvas op:%d",
+             static_cast<int>(type));
+  result_->dropped_op_count_++;
+}
+uint32_t RecordingCanvasHelper::AddString(const char* str, uint32_t length) {
+  auto start = static_cast<uint32_t>(result_->string_pool_.size());
+  if (str != nullptr) result_->string_pool_.append(str, length);
+  return start;
+}
+uint32_t RecordingCanvasHelper::AddTypeface(const ITypefaceHelper* font) {
+  if (font == nullptr) return 0;
+  auto id = font->GetUniqueId();
+  auto& typeface = result_->typefaces_[id];
+  if (typeface == nullptr) typeface = font->weak_from_this().lock();
+  return id;
+}
+uint32_t RecordingCanvasHelper::AddPaint(const Painter* painter) {
+  if (painter == nullptr) return FlatLayoutResult::kNoPaint;
+  std::string key;
+  little_endian::Append(&key, painter->GetColor());
+  little_endian::Append(&key, painter->GetStrokeWidth());
+  little_endian::Append(&key, painter->GetStrokeMiter());
+  little_endian::Append(&key, painter->GetTextSize());
+  little_endian::Append(&key, painter->GetFillStyle());
+  little_endian::Append(&key, painter->GetCap());
+  little_endian::Append(&key, painter->GetJoin());
+  little_endian::Append(&key, painter->IsBold());
+  little_endian::Append(&key, painter->IsItalic());
+  little_endian::Append(&key, painter->IsUnderLine());
+  for (const auto& shadow : painter->GetShadowList()) {
+    little_endian::Append(&key, shadow.color_.GetPlainColor());
+    little_endian::Append(&key, shadow.offset_[0]);
+    little_endian::Append(&key, shadow.offset_[1]);
+    little_endian::Append(&key, static_cast<float>(shadow.blur_radius_));
+  }
+  key.push_back('\0');
+  key.append(painter->GetFontFamily());
+  auto iter = paint_index_.find(key);
+  if (iter != paint_index_.end()) return iter->second;
+
+  FlatLayoutResult::Paint paint{};
+  paint.color_ = painter->GetColor();
+  paint.stroke_width_ = painter->GetStrokeWidth();
+  paint.stroke_miter_ = painter->GetStrokeMiter();
+  paint.text_size_ = painter->GetTextSize();
+  const auto& family = painter->GetFontFamily();
+  paint.font_family_length_ = static_cast<uint32_t>(family.length());
+  paint.font_family_start_ =
+      AddString(family.c_str(), paint.font_family_length_);
+  const auto& shadows = painter->GetShadowList();
+  paint.shadow_start_ = static_cast<uint32_t>(result_->shadows_.size());
+  paint.shadow_count_ = static_cast<uint32_t>(shadows.size());
+  for (const auto& shadow : shadows) {
+    result_->shadows_.push_back({shadow.color_.GetPlainColor(),
+                                 shadow.offset_[0], shadow.offset_[1],
+                                 static_cast<float>(shadow.blur_radius_)});
+  }
+  paint.fill_style_ = painter->GetFillStyle();
+  paint.cap_ = painter->GetCap();
+  paint.join_ = painter->GetJoin();
+  paint.bold_ = painter->IsBold();
+  paint.italic_ = painter->IsItalic();
+  paint.under_line_ = painter->IsUnderLine();
+  auto idx = static_cast<uint32_t>(result_->paints_.size());
+  result_->paints_.push_back(paint);
+  paint_index_.emplace(std::move(key), idx);
+  return idx;
+}
+}  // namespace tttext
+}  // namespace ttoffice
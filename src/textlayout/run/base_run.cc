@@ -39,8 +39,9 @@ const char** BaseRun::SpaceList() {
 }
 
 float BaseRun::GetWidth(uint32_t char_start_in_run, uint32_t char_count) const {
-  if (GetType() == RunType::kInlineObject ||
-      GetType() == RunType::kFloatObject) {
+  // a float is out of the text flow, it takes no room in its line
+  if (GetType() == RunType::kFloatObject) return 0;
+  if (GetType() == RunType::kInlineObject) {
     TTASSERT(delegate_ != nullptr);
     return delegate_->GetAdvance();
   }
@@ -56,27 +57,37 @@ float BaseRun::MeasureRunByWidth(uint32_t& break_pos_in_run,
                                  float max_width) const {
   TTASSERT(break_pos_in_run < GetCharCount());
   TTASSERT(shape_result_.Valid());
-  auto width = 0.f;
-  auto& idx = break_pos_in_run;
-  uint32_t prev_glyph_id = -1;
   auto letter_spacing = layout_style_.GetLetterSpacing();
-  while (idx < GetCharCount()) {
-    TTASSERT(idx < shape_result_.CharCount());
-    auto glyph_id = shape_result_.CharToGlyph(idx);
-    TTASSERT(glyph_id < shape_result_.GlyphCount());
-    if (glyph_id != prev_glyph_id) {
-      const auto ww = shape_result_.Advances(glyph_id)[0] + letter_spacing;
-      if (FloatsLarger(width + ww, max_width)) break;
-      width += ww;
-    }
-    idx++;
-    prev_glyph_id = glyph_id;
-  }
+  auto char_count =
+      shape_result_.FitCharCount(break_pos_in_run, letter_spacing, max_width);
+  if (char_count == 0) return 0;
+  auto width =
+      shape_result_.MeasureWidth(break_pos_in_run, char_count, letter_spacing);
+  break_pos_in_run += char_count;
   return width;
 }
+float BaseRun::GetCharAdvance(uint32_t char_idx_in_run) const {
+  if (IsObjectRun()) {
+    return char_idx_in_run == 0 ? GetWidth(0) : 0;
+  }
+  TTASSERT(char_idx_in_run < GetCharCount());
+  TTASSERT(shape_result_.Valid());
+  auto glyph_id = shape_result_.CharToGlyph(char_idx_in_run);
+  if (char_idx_in_run > 0 &&
+      shape_result_.CharToGlyph(char_idx_in_run - 1) == glyph_id) {
+    return 0;
+  }
+  const auto advance = shape_result_.Advances(glyph_id)[0];
+  return FloatsLarger(advance, 0)
+             ? advance + layout_style_.GetLetterSpacing()
+             : 0;
+}
 void BaseRun::Layout() {
-  if (run_type_ == RunType::kFloatObject ||
-      run_type_ == RunType::kInlineObject) {
+  if (run_type_ == RunType::kFloatObject) {
+    metrics_ = LayoutMetrics{0, 0};
+    return;
+  }
+  if (run_type_ == RunType::kInlineObject) {
     metrics_ = LayoutMetrics{delegate_->GetAscent(), delegate_->GetDescent()};
     return;
   }
@@ -138,32 +149,33 @@ void BaseRun::Layout() {
     TypefaceRef font = nullptr;
     RectF bounds;
     std::vector<GlyphID> glyphs;
+    std::vector<GlyphMetrics> glyph_metrics;
     glyphs.reserve(GetCharCount());
+    // vertical ink extent of the glyphs collected for font
+    auto add_bounds = [&]() {
+      if (glyphs.empty()) return;
+      glyph_metrics.resize(glyphs.size());
+      font->GetGlyphMetrics(glyphs.data(), static_cast<uint32_t>(glyphs.size()),
+                            layout_style_.GetTextSize(), glyph_metrics.data());
+      for (const auto& metrics : glyph_metrics) {
+        if (metrics.bounds_[1] < bounds.GetTop()) {
+          bounds.SetTop(metrics.bounds_[1]);
+        }
+        if (metrics.bounds_[3] > bounds.GetBottom()) {
+          bounds.SetBottom(metrics.bounds_[3]);
+        }
+      }
+      glyphs.clear();
+    };
     for (auto k = 0u; k < GetCharCount(); k++) {
       auto cur_font = shape_result_.FontByCharId(k);
       if (cur_font != font) {
-        if (!glyphs.empty()) {
-          float rect_ltrb[4] = {0, 0, 0, 0};
-          cur_font->GetWidthBounds(rect_ltrb, glyphs.data(),
-                                   static_cast<uint32_t>(glyphs.size()),
-                                   layout_style_.GetTextSize());
-          glyphs.clear();
-          if (rect_ltrb[1] < bounds.GetTop()) bounds.SetTop(rect_ltrb[1]);
-          if (rect_ltrb[3] > bounds.GetBottom()) bounds.SetBottom(rect_ltrb[3]);
-        }
+        add_bounds();
         font = cur_font;
       }
       glyphs.push_back(shape_result_.Glyphs(k));
     }
-    if (!glyphs.empty()) {
-      float rect_ltrb[4] = {0, 0, 0, 0};
-      font->GetWidthBounds(rect_ltrb, glyphs.data(),
-                           static_cast<uint32_t>(glyphs.size()),
-                           layout_style_.GetTextSize());
-      glyphs.clear();
-      if (rect_ltrb[1] < bounds.GetTop()) bounds.SetTop(rect_ltrb[1]);
-      if (rect_ltrb[3] > bounds.GetBottom()) bounds.SetBottom(rect_ltrb[3]);
-    }
+    add_bounds();
     auto diff = metrics_.GetHeight() - bounds.GetHeight();
     baseline_offset_ = metrics_.GetMaxAscent() + diff / 2 - bounds.GetTop();
   }
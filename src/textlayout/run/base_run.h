@@ -76,9 +76,6 @@ class BaseRun {
   uint32_t GetEndCharPos() const { return end_char_pos_; }
   uint32_t GetCharCount() const { return end_char_pos_ - start_char_pos_; }
   RunType GetType() const { return run_type_; }
-  uint32_t GetVisualOrderIndex() const {
-    return paragraph_->GetVisualOrder(GetStartCharPos());
-  }
   bool IsControlRun() const { return run_type_ >= RunType::kControlRun; }
   bool IsTextRun() const {
     return GetType() == RunType::kTextRun || GetType() == RunType::kSpaceRun ||
@@ -150,6 +147,11 @@ class BaseRun {
    * exceed max_width.
    */
   float MeasureRunByWidth(uint32_t& break_pos_in_run, float max_width) const;
+  /**
+   * Advance contributed by a single character, the whole cluster advance is
+   * given to its first character and the rest of the cluster gets zero.
+   */
+  float GetCharAdvance(uint32_t char_idx_in_run) const;
   const Style& GetLayoutStyle() const { return layout_style_; }
   const ShapeStyle& GetShapeStyle() const {
     return layout_style_.GetShapeStyle();
@@ -64,6 +64,13 @@ class ShapeResultPiece {
     return result_->MeasureWidth(start_char_pos_ + start_char, char_count,
                                  letter_spacing);
   }
+  uint32_t FitCharCount(uint32_t start_char, float letter_spacing,
+                        float max_width) const {
+    TTASSERT(start_char <= CharCount());
+    return result_->FitCharCount(start_char_pos_ + start_char,
+                                 CharCount() - start_char, letter_spacing,
+                                 max_width);
+  }
 
  private:
   std::shared_ptr<const ShapeResult> result_;
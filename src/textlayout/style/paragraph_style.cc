@@ -27,7 +27,8 @@ ParagraphStyle::ParagraphStyle()
       half_leading_(false),
       enable_text_bounds_(false),
       overflow_wrap_(OverflowWrap::kAnywhere),
-      line_break_strategy_(kLineBreakStrategyDefault) {}
+      line_break_strategy_(kLineBreakStrategyDefault),
+      line_break_mode_(LineBreakMode::kGreedy) {}
 ParagraphStyle::ParagraphStyle(const ParagraphStyle& paragraph_style)
     : ParagraphStyle() {
   *this = paragraph_style;
@@ -51,6 +52,8 @@ ParagraphStyle& ParagraphStyle::operator=(
   enable_text_bounds_ = paragraph_style.enable_text_bounds_;
   overflow_wrap_ = paragraph_style.overflow_wrap_;
   line_break_strategy_ = paragraph_style.line_break_strategy_;
+  line_break_mode_ = paragraph_style.line_break_mode_;
+  hyphenator_ = paragraph_style.hyphenator_;
   return *this;
 }
 float ParagraphStyle::GetStartIndentInPx() const { return indent_->start_; }
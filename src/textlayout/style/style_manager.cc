@@ -72,6 +72,23 @@ void AttributesRangeList::SetRangeValue(const Range& range, ValueType value) {
   }
 #endif
 }
+void AttributesRangeList::AppendRangeValue(const Range& range,
+                                           ValueType value) {
+  if (range.Empty()) return;
+  if (!range_list_.empty() &&
+      range_list_.back().first.GetEnd() > range.GetStart()) {
+    SetRangeValue(range, value);
+    return;
+  }
+  if (value == Undefined()) return;
+  if (merge_range_ && !range_list_.empty() &&
+      range_list_.back().second == value &&
+      range_list_.back().first.GetEnd() == range.GetStart()) {
+    range_list_.back().first.SetEnd(range.GetEnd());
+    return;
+  }
+  range_list_.emplace_back(range, value);
+}
 AttributesRangeList::ValueType AttributesRangeList::GetAttrValue(
     uint32_t idx) const {
   for (auto& range : range_list_) {
@@ -109,6 +126,17 @@ void StyleManager::ApplyStyleInRange(const Style& style, uint32_t start,
     style_list_[id].SetRangeValue(Range{start, end}, value);
   }
 }
+void StyleManager::AppendStyleInRange(const Style& style, uint32_t start,
+                                      uint32_t len) {
+  auto max_end = Range::MaxIndex();
+  auto end = len > max_end - start ? max_end : start + len;
+  for (int id = (int32_t)AttributeType::kStyleManagerAttrStart;
+       id < (int32_t)AttributeType::kStyleManagerAttrEnd; id++) {
+    if (!style.HasAttribute((AttributeType)id)) continue;
+    style_list_[id].AppendRangeValue(Range{start, end},
+                                     GetStyleValue(&style, (AttributeType)id));
+  }
+}
 const Style StyleManager::GetStyle(uint32_t idx) {
   Style ret(default_style_);
   for (int id = (int32_t)AttributeType::kStyleManagerAttrStart;
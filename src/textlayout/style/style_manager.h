@@ -62,6 +62,11 @@ class AttributesRangeList {
  public:
   void SetMergeRange(bool merge) { merge_range_ = merge; }
   void SetRangeValue(const Range& range, ValueType value);
+  /**
+   * @brief Same as SetRangeValue() in O(1) when range starts at or after the
+   * end of every range in the list, e.g. for content appended to a paragraph.
+   */
+  void AppendRangeValue(const Range& range, ValueType value);
   void ClearRangeValue(const Range& range) {
     SetRangeValue(range, Undefined());
   }
@@ -235,6 +240,10 @@ class StyleManager {
                : UnPackValue<LineType>(value);
   }
   void ApplyStyleInRange(const Style& style, uint32_t start, uint32_t len);
+  /**
+   * @brief ApplyStyleInRange() for a range appended after the styled content.
+   */
+  void AppendStyleInRange(const Style& style, uint32_t start, uint32_t len);
   AttributesRangeList::ValueType GetTypeValue(AttributeType type,
                                               uint32_t idx) {
     auto type_id = (AttrType)type;
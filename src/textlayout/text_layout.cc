@@ -28,6 +28,11 @@ LayoutResult TextLayout::LayoutEx(Paragraph* para, LayoutRegion* page,
   TTASSERT(page);
   return TextLayoutImpl::LayoutEx(para, page, context, shaper_.get());
 }
+std::pair<float, float> TextLayout::MeasureForWidth(Paragraph* para,
+                                                    float width) const {
+  TTASSERT(para);
+  return TextLayoutImpl::MeasureForWidth(para, width, shaper_.get());
+}
 
 }  // namespace tttext
 }  // namespace ttoffice
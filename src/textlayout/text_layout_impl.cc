@@ -7,9 +7,11 @@
 #include <textra/tttext_context.h>
 
 #include <algorithm>
+#include <cmath>
 #include <utility>
 #include <vector>
 
+#include "src/textlayout/internal/boundary_analyst.h"
 #include "src/textlayout/layout_measurer.h"
 #include "src/textlayout/style/style_manager.h"
 #include "src/textlayout/text_line_impl.h"
@@ -42,6 +44,7 @@ LayoutResult TextLayoutImpl::LayoutEx(Paragraph* i_para, LayoutRegion* page,
         FinishLineLayout(page, std::move(current_line), context, &result);
       }
     } else if (result == LayoutResult::kRelayoutLine) {
+      context.line_relayout_count_++;
       pos = current_line->GetStartLayoutPosition();
       current_line->ClearForRelayout();
       result = LayoutResult::kNormal;
@@ -51,6 +54,48 @@ LayoutResult TextLayoutImpl::LayoutEx(Paragraph* i_para, LayoutRegion* page,
   return result;
 }
 
+std::pair<float, float> TextLayoutImpl::MeasureForWidth(Paragraph* i_para,
+                                                        float width,
+                                                        TTShaper* shaper) {
+  auto* para = TTDYNAMIC_CAST<ParagraphImpl*>(i_para);
+  std::pair<float, float> size;
+  if (para->FindMeasuredSize(width, &size)) return size;
+  LayoutRegion region(width, LAYOUT_MAX_UNITS, LayoutMode::kDefinite,
+                      LayoutMode::kIndefinite);
+  TTTextContext context;
+  context.SetMeasureOnly(true);
+  LayoutEx(para, &region, context, shaper);
+  size = {region.GetLayoutedWidth(), region.GetLayoutedHeight()};
+  para->AddMeasuredSize(width, size);
+  return size;
+}
+
+std::unique_ptr<TextLineImpl> TextLayoutImpl::LayoutLine(
+    ParagraphImpl* para, LayoutRegion* page, const LayoutPosition& start,
+    float line_top, const TTTextContext& config) {
+  TTTextContext context;
+  context.SetLastLineCanOverflow(config.IsLastLineCanOverflow());
+  context.SetSkipSpacingBeforeFirstLine(config.IsSkipSpacingBeforeFirstLine());
+  auto& pos = context.GetPositionRef();
+  pos = start;
+  auto line = std::make_unique<TextLineImpl>(para, page, pos);
+  line->Initialize(line_top);
+  auto result = LayoutResult::kNormal;
+  while (pos.GetRunIdx() < para->GetRunCount() &&
+         result == LayoutResult::kNormal) {
+    pos = ProcessBreakableRunList(*para, pos, page, line.get(), context,
+                                  &result);
+    if (result == LayoutResult::kRelayoutLine) {
+      pos = line->GetStartLayoutPosition();
+      line->ClearForRelayout();
+      result = LayoutResult::kNormal;
+    }
+  }
+  line->SetLayouted();
+  line->CreateDrawerPiece();
+  line->ApplyAlignment();
+  return line;
+}
 std::unique_ptr<TextLineImpl> TextLayoutImpl::ProcessNewLine(
     ParagraphImpl* para, LayoutRegion* page, TTTextContext& context) {
   auto new_line =
@@ -65,10 +110,13 @@ float TextLayoutImpl::ProcessLineGap(LayoutRegion* page, TextLine* line,
   if (page->IsEmpty() && context.IsSkipSpacingBeforeFirstLine()) return 0;
   float last_line_spacing = 0;
   if (!page->IsEmpty()) {
-    last_line_spacing = page->GetLine(page->GetLineCount() - 1)
-                            ->GetParagraph()
-                            ->GetParagraphStyle()
-                            .GetLineSpaceAfterPx();
+    page->VisitLines(page->GetLineCount() - 1, page->GetLineCount(),
+                     [&last_line_spacing](uint32_t, TextLine* last_line) {
+                       last_line_spacing = last_line->GetParagraph()
+                                               ->GetParagraphStyle()
+                                               .GetLineSpaceAfterPx();
+                       return true;
+                     });
   }
   return line->GetParagraph()->GetParagraphStyle().GetLineSpaceBeforePx() +
          last_line_spacing;
@@ -79,8 +127,12 @@ void TextLayoutImpl::FinishLineLayout(LayoutRegion* page,
                                       LayoutResult* result) {
   line->SetLayouted();
   auto& pos = context.GetPositionRef();
-  line->CreateDrawerPiece();
-  line->ApplyAlignment();
+  if (context.IsMeasureOnly()) {
+    line->drawer_pending_ = true;
+  } else {
+    line->CreateDrawerPiece();
+    line->ApplyAlignment();
+  }
   /*
    * Extra inserted single-line images with no spacing (stick to top/bottom)
    * */
@@ -110,30 +162,78 @@ void TextLayoutImpl::FinishLineLayout(LayoutRegion* page,
   if (break_page) {
     page->SetFullFilled(true);
     *result = LayoutResult::kBreakPage;
-    auto* last_line = page->GetLine(page->GetLineCount() - 1);
-    if (last_line != nullptr) {
-      auto* last_line_paragraph = last_line->GetParagraph();
-      if (current_line != last_line ||
-          pos.GetRunIdx() != last_line_paragraph->GetRunCount()) {
-        last_line->StripByEllipsis(nullptr);
-        page->UpdateLayoutedSize(last_line, context);
-      }
-    }
+    page->VisitLines(
+        page->GetLineCount() - 1, page->GetLineCount(),
+        [&](uint32_t, TextLine* last_line) {
+          auto* last_line_paragraph = last_line->GetParagraph();
+          if (current_line != last_line ||
+              pos.GetRunIdx() != last_line_paragraph->GetRunCount()) {
+            last_line->StripByEllipsis(nullptr);
+            page->last_line_stripped_ = true;
+            page->UpdateLayoutedSize(last_line, context);
+          }
+          return true;
+        });
   } else {
     page->SetFullFilled(false);
   }
 }
+/**
+ * @brief Places the float run at position on the left of the first range of
+ * the line wide enough for it, at the line top.
+ *
+ * @param result kRelayoutLine if the float has been placed, the ranges of the
+ * line have to be split around it
+ */
 LayoutPosition TextLayoutImpl::ProcessSpecialRun(const ParagraphImpl& paragraph,
                                                  const LayoutPosition& position,
                                                  LayoutRegion* page,
-                                                 TextLine* line,
+                                                 TextLineImpl* line,
                                                  TTTextContext& context,
                                                  LayoutResult* result) {
   auto pos = position;
   auto* run = paragraph.GetRun(pos.GetRunIdx());
-  if (run == nullptr) return pos;
+  if (run == nullptr || run->GetType() != RunType::kFloatObject) return pos;
+  const auto* delegate = run->GetRunDelegate();
+  if (delegate == nullptr) return pos;
+  auto top = line->line_top_;
+  const auto ranges = page->GetRangeList(
+      &top, delegate->GetDescent() - delegate->GetAscent(),
+      line->GetStartIndent(), line->GetEndIndent());
+  TTASSERT(!ranges.empty());
+  auto left = ranges[0][0];
+  for (const auto& range : ranges) {
+    if (FloatsLargerOrEqual(range[1] - range[0], delegate->GetAdvance())) {
+      left = range[0];
+      break;
+    }
+  }
+  if (page->ProcessFloatObject(context, *run,
+                               static_cast<int>(std::ceil(left)),
+                               line->line_top_)
+          .second) {
+    *result = LayoutResult::kRelayoutLine;
+  }
   return pos;
 }
+/**
+ * @brief Places the float runs between start_pos and end_pos, which have just
+ * been added to the line.
+ * @return whether any of them has been placed, the line has to be laid out
+ * again around it. Placed floats are skipped when the line is laid out again.
+ */
+bool TextLayoutImpl::PlaceFloatRuns(const ParagraphImpl& paragraph,
+                                    const LayoutPosition& start_pos,
+                                    const LayoutPosition& end_pos,
+                                    LayoutRegion* page, TextLineImpl* line,
+                                    TTTextContext& context) {
+  auto result = LayoutResult::kNormal;
+  for (auto pos = start_pos; pos < end_pos; pos.NextRun()) {
+    if (pos.GetCharIdx() != 0) continue;
+    ProcessSpecialRun(paragraph, pos, page, line, context, &result);
+  }
+  return result == LayoutResult::kRelayoutLine;
+}
 LayoutPosition TextLayoutImpl::ProcessBreakableRunList(
     const ParagraphImpl& paragraph, const LayoutPosition& position,
     LayoutRegion* page, TextLineImpl* line, TTTextContext& context,
@@ -145,15 +245,26 @@ LayoutPosition TextLayoutImpl::ProcessBreakableRunList(
 }
 bool TextLayoutImpl::CheckLineNeedRelayout(LayoutRegion* region,
                                            TextLineImpl* line, float new_height,
-                                           float& next_line_top) {
+                                           float& next_line_top,
+                                           TTTextContext& context) {
   next_line_top = line->line_top_;
   std::vector<std::array<float, 2>> list;
   if (line->range_lst_.empty()) {
-    list = region->GetRangeList(&next_line_top, new_height,
+    // a line laid out again keeps the height which changed its ranges, so
+    // that the same taller run does not make it relayout again
+    line->range_height_ = std::max(line->range_height_, new_height);
+    context.range_list_query_count_++;
+    list = region->GetRangeList(&next_line_top, line->range_height_,
                                 line->GetStartIndent(), line->GetEndIndent());
     TTASSERT(!list.empty());
     line->SetRangeLst(list);
-  } else if (FloatsLarger(new_height, line->GetLineHeight())) {
+  } else if (FloatsLarger(new_height, line->range_height_)) {
+    // the line keeps its content unless the taller band reaches an exclusion
+    const bool may_change = region->RangeListMayChange(
+        line->line_top_, line->range_height_, new_height);
+    line->range_height_ = new_height;
+    if (!may_change) return false;
+    context.range_list_query_count_++;
     list = region->GetRangeList(&next_line_top, new_height,
                                 line->GetStartIndent(), line->GetEndIndent());
     TTASSERT(!list.empty());
@@ -176,7 +287,8 @@ LayoutPosition TextLayoutImpl::AddBreakableRunsToLine(
   auto metrics = LayoutMetrics(-line->GetMaxAscent(), line->GetMaxDescent());
   auto new_height = TryAddRun(metrics, run);
 
-  if (CheckLineNeedRelayout(region, line, new_height, next_line_top)) {
+  if (CheckLineNeedRelayout(region, line, new_height, next_line_top,
+                            context)) {
     *result = LayoutResult::kRelayoutLine;
     return position;
   }
@@ -191,17 +303,39 @@ LayoutPosition TextLayoutImpl::AddBreakableRunsToLine(
     greedy_break_pos = FindBreakPosInWord(paragraph, pos, &range_width, result);
     // break at default breakable position if not the last line, otherwise
     // break at any position.
-    bool is_last_line = region->GetLineCount() + 1 >=
+    bool is_last_line = region->GetLayoutLineIndex() + 1 >=
                         line->GetParagraph()->GetParagraphStyle().GetMaxLines();
     auto line_break_pos =
         is_last_line ? greedy_break_pos
                      : paragraph.FindPrevBoundary(greedy_break_pos,
                                                   BoundaryType::kLineBreakable);
+    if (!is_last_line && range_lst_size == 1 &&
+        paragraph.GetParagraphStyle().GetLineBreakMode() ==
+            LineBreakMode::kOptimal) {
+      auto optimal_break_pos =
+          FindOptimalBreakPos(paragraph, pos, greedy_break_pos, line);
+      if (optimal_break_pos > pos) {
+        // do not let the word breaking below refill the line greedily
+        line_break_pos = greedy_break_pos = optimal_break_pos;
+      }
+    }
     if (line_break_pos < pos) line_break_pos = pos;
+    if (!is_last_line && range_idx + 1 == range_lst_size &&
+        line_break_pos < greedy_break_pos &&
+        paragraph.boundary_analyst_->HasHyphenBreak()) {
+      auto hyphen_break_pos = FindHyphenBreakPos(
+          paragraph, line_break_pos, greedy_break_pos, range_width, line);
+      if (hyphen_break_pos > line_break_pos) {
+        line_break_pos = greedy_break_pos = hyphen_break_pos;
+      }
+    }
     if (line_break_pos > pos) {
       auto d_height = AddWordListToRunRange(range.get(), paragraph, pos,
                                             line_break_pos, &metrics);
-      if (CheckLineNeedRelayout(region, line, d_height, next_line_top)) {
+      if (PlaceFloatRuns(paragraph, pos, line_break_pos, region, line,
+                         context) ||
+          CheckLineNeedRelayout(region, line, d_height, next_line_top,
+                                context)) {
         *result = LayoutResult::kRelayoutLine;
         return position;
       }
@@ -231,9 +365,10 @@ LayoutPosition TextLayoutImpl::AddBreakableRunsToLine(
         FloatsLarger(region->GetPageWidth(),
                      line->GetCurrentRange()->GetRangeWidth() +
                          line->GetStartIndent() + line->GetEndIndent())) {
-      auto list =
-          region->GetRangeList(&next_line_top, line->GetLineHeight(),
-                               line->GetStartIndent(), line->GetEndIndent());
+      // jump to the first y where the available ranges get wider
+      next_line_top = line->line_top_;
+      region->GetRangeList(&next_line_top, line->GetLineHeight(),
+                           line->GetStartIndent(), line->GetEndIndent());
       if (FloatsLarger(next_line_top, region->GetPageHeight())) {
         *result = LayoutResult::kBreakPage;
       } else {
@@ -252,7 +387,9 @@ LayoutPosition TextLayoutImpl::AddBreakableRunsToLine(
   if (break_pos > pos) {
     auto d_height = AddWordListToRunRange(line->GetCurrentRange(), paragraph,
                                           pos, break_pos, &metrics);
-    if (CheckLineNeedRelayout(region, line, d_height, next_line_top)) {
+    if (PlaceFloatRuns(paragraph, pos, break_pos, region, line, context) ||
+        CheckLineNeedRelayout(region, line, d_height, next_line_top,
+                              context)) {
       *result = LayoutResult::kRelayoutLine;
       return position;
     }
@@ -262,6 +399,57 @@ LayoutPosition TextLayoutImpl::AddBreakableRunsToLine(
   *result = LayoutResult::kBreakLine;
   return break_pos;
 }
+LayoutPosition TextLayoutImpl::FindOptimalBreakPos(
+    const ParagraphImpl& paragraph, const LayoutPosition& position,
+    const LayoutPosition& greedy_break_pos, const TextLineImpl* line) {
+  const auto& paragraph_style = paragraph.GetParagraphStyle();
+  const auto full_width = line->GetCurrentRange()->GetRangeWidth() +
+                          line->GetStartIndent() + line->GetEndIndent();
+  const auto end_indent = paragraph_style.GetEndIndentInPx();
+  const auto& breaks = paragraph.GetOptimalBreaks(
+      full_width - paragraph_style.GetFirstLineIndentInPx() - end_indent,
+      full_width - paragraph_style.GetStartIndentInPx() - end_indent);
+  // the last optimal break which still fits into the line
+  const auto start_char = paragraph.LayoutPositionToCharPos(position);
+  const auto end_char = paragraph.LayoutPositionToCharPos(greedy_break_pos);
+  auto iter = std::upper_bound(breaks.begin(), breaks.end(), end_char);
+  if (iter == breaks.begin() || *(iter - 1) <= start_char) return position;
+  return paragraph.CharPosToLayoutPosition(*(iter - 1));
+}
+/**
+ * @brief Find the last hyphenation point between line_break_pos and
+ * greedy_break_pos where the line content plus a hyphen still fits.
+ *
+ * @param remain_width width left in the line after greedy_break_pos
+ * @return the hyphen break position, or line_break_pos if none fits. The
+ * hyphen run of the line is prepared for the returned position.
+ */
+LayoutPosition TextLayoutImpl::FindHyphenBreakPos(
+    const ParagraphImpl& paragraph, const LayoutPosition& line_break_pos,
+    const LayoutPosition& greedy_break_pos, float remain_width,
+    TextLineImpl* line) {
+  const auto lower = paragraph.LayoutPositionToCharPos(line_break_pos);
+  const auto greedy_char = paragraph.LayoutPositionToCharPos(greedy_break_pos);
+  const auto* analyst = paragraph.boundary_analyst_.get();
+  auto hyphen_char = analyst->FindPrevHyphenBreak(greedy_char, lower);
+  auto free_width = remain_width;
+  auto measured_char = greedy_char;
+  while (hyphen_char > lower) {
+    // give back the width of the chars behind the hyphen break
+    for (; measured_char > hyphen_char; measured_char--) {
+      const auto char_pos = paragraph.CharPosToLayoutPosition(measured_char - 1);
+      const auto* run = paragraph.GetRun(char_pos.GetRunIdx());
+      free_width += run->GetCharAdvance(char_pos.GetCharIdx());
+    }
+    const auto hyphen_width = line->CreateHyphenRun(hyphen_char);
+    if (FloatsLargerOrEqual(free_width, hyphen_width)) {
+      return paragraph.CharPosToLayoutPosition(hyphen_char);
+    }
+    hyphen_char = analyst->FindPrevHyphenBreak(hyphen_char - 1, lower);
+  }
+  line->ClearHyphenRun();
+  return line_break_pos;
+}
 float TextLayoutImpl::TryAddRun(LayoutMetrics line_metrics,
                                 const BaseRun* run) {
   auto paragraph = run->GetParagraph();
@@ -315,8 +503,7 @@ LayoutPosition TextLayoutImpl::FindBreakPosInWord(
   while (break_pos < end_pos) {
     const auto* break_run = paragraph.GetRun(break_pos.GetRunIdx());
     auto break_pos_in_run = break_pos.GetCharIdx();
-    if (break_run->GetCharCount() == 0 ||
-        break_run->GetType() == RunType::kInlineObject) {
+    if (break_run->GetCharCount() == 0 || break_run->IsObjectRun()) {
       TTASSERT(break_pos_in_run == 0);
       const auto width = break_run->GetWidth(0);
       if (FloatsLarger(width, *max_width)) {
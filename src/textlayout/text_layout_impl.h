@@ -8,6 +8,7 @@
 #include <textra/layout_definition.h>
 
 #include <memory>
+#include <utility>
 
 #include "src/textlayout/internal/line_range.h"
 #include "src/textlayout/run/base_run.h"
@@ -27,6 +28,21 @@ class TextLayoutImpl {
   static LayoutResult LayoutEx(Paragraph* para, LayoutRegion* page,
                                TTTextContext& context, TTShaper* shaper);
 
+  static std::pair<float, float> MeasureForWidth(Paragraph* para, float width,
+                                                 TTShaper* shaper);
+
+  /**
+   * @brief Lays out again a single line which has been laid out before at
+   * line_top, used to materialize the lines of a virtualized region.
+   * @param config the configurations of the context the line was laid out
+   * with, its layout state is not used
+   */
+  static std::unique_ptr<TextLineImpl> LayoutLine(ParagraphImpl* para,
+                                                  LayoutRegion* page,
+                                                  const LayoutPosition& start,
+                                                  float line_top,
+                                                  const TTTextContext& config);
+
   static std::unique_ptr<TextLineImpl> ProcessNewLine(ParagraphImpl* para,
                                                       LayoutRegion* page,
                                                       TTTextContext& context);
@@ -40,10 +56,17 @@ class TextLayoutImpl {
 
   static LayoutPosition ProcessSpecialRun(const ParagraphImpl& paragraph,
                                           const LayoutPosition& position,
-                                          LayoutRegion* page, TextLine* line,
+                                          LayoutRegion* page,
+                                          TextLineImpl* line,
                                           TTTextContext& context,
                                           LayoutResult* result);
 
+  static bool PlaceFloatRuns(const ParagraphImpl& paragraph,
+                             const LayoutPosition& start_pos,
+                             const LayoutPosition& end_pos,
+                             LayoutRegion* page, TextLineImpl* line,
+                             TTTextContext& context);
+
   static LayoutPosition ProcessBreakableRunList(const ParagraphImpl& paragraph,
                                                 const LayoutPosition& position,
                                                 LayoutRegion* page,
@@ -52,7 +75,8 @@ class TextLayoutImpl {
                                                 LayoutResult* result);
 
   static bool CheckLineNeedRelayout(LayoutRegion* region, TextLineImpl* line,
-                                    float new_height, float& next_line_top);
+                                    float new_height, float& next_line_top,
+                                    TTTextContext& context);
 
   static LayoutPosition AddBreakableRunsToLine(const ParagraphImpl& paragraph,
                                                const LayoutPosition& position,
@@ -61,6 +85,15 @@ class TextLayoutImpl {
                                                TTTextContext& context,
                                                LayoutResult* result);
 
+  static LayoutPosition FindOptimalBreakPos(
+      const ParagraphImpl& paragraph, const LayoutPosition& position,
+      const LayoutPosition& greedy_break_pos, const TextLineImpl* line);
+
+  static LayoutPosition FindHyphenBreakPos(
+      const ParagraphImpl& paragraph, const LayoutPosition& line_break_pos,
+      const LayoutPosition& greedy_break_pos, float remain_width,
+      TextLineImpl* line);
+
   static float TryAddRun(LayoutMetrics line_metrics, const BaseRun* run);
 
   static float AddWordListToRunRange(LineRange* range,
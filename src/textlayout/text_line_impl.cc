@@ -8,9 +8,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <utility>
 
+#include "src/textlayout/internal/bidi_run_table.h"
 #include "src/textlayout/internal/boundary_analyst.h"
+#include "src/textlayout/internal/line_glyph_cache.h"
 #include "src/textlayout/internal/line_range.h"
 #include "src/textlayout/internal/run_range.h"
 #include "src/textlayout/layout_measurer.h"
@@ -42,6 +45,7 @@ TextLineImpl::TextLineImpl(ParagraphImpl* paragraph, LayoutRegion* lp,
   }
 }
 TextLineImpl::~TextLineImpl() = default;
+void TextLineImpl::InvalidateGlyphCache() const { glyph_cache_ = nullptr; }
 void TextLineImpl::SetRangeLst(const std::vector<std::array<float, 2>>& lst) {
   range_lst_.clear();
   for (auto& range : lst) {
@@ -53,6 +57,7 @@ LayoutPosition TextLineImpl::UpdateLine(LayoutPosition pos, float max_ascent,
                                         float max_descent,
                                         float desired_height) {
   line_end_pos_ = pos;
+  InvalidateGlyphCache();
 
   if (-max_ascent > max_ascent_) max_ascent_ = -max_ascent;
   if (max_descent > max_descent_) max_descent_ = max_descent;
@@ -95,12 +100,14 @@ bool TextLineImpl::IsEmpty() const {
 float TextLineImpl::GetLineLeft() const {
   TTASSERT(IsLayouted());
   if (!IsLayouted() || range_lst_.empty()) return 0;
+  if (drawer_pending_) return GetAlignedContentExtent().first;
   return drawer_list_.empty() ? range_lst_[0]->GetContentLeft()
                               : drawer_list_[0]->GetLeft();
 }
 float TextLineImpl::GetLineRight() const {
   TTASSERT(IsLayouted());
   if (!IsLayouted() || range_lst_.empty()) return 0;
+  if (drawer_pending_) return GetAlignedContentExtent().second;
   return drawer_list_.empty() ? range_lst_.back()->GetContentRight()
                               : drawer_list_.back()->GetRight();
 }
@@ -111,7 +118,7 @@ CharPos TextLineImpl::GetEndCharPos() const {
   return paragraph_->LayoutPositionToCharPos(line_end_pos_);
 }
 void TextLineImpl::SplitToWordDrawer(const LineRange& line_range,
-                                     float word_spacing) {
+                                     float word_spacing) const {
   for (const auto& run_range : line_range.run_range_lst_) {
     if (run_range->GetRun()->IsGhostRun()) {
       drawer_list_.push_back(std::make_unique<DrawerPiece>(*run_range));
@@ -125,7 +132,7 @@ void TextLineImpl::SplitToWordDrawer(const LineRange& line_range,
         auto drawer = std::make_unique<DrawerPiece>(
             run, run_range->GetParent(), start_char - run->GetStartCharPos(),
             next_word_boundary - run->GetStartCharPos());
-        InsertDrawerPiece(std::move(drawer));
+        drawer_list_.emplace_back(std::move(drawer));
         start_char = next_word_boundary;
         next_word_boundary = paragraph_->boundary_analyst_->FindNextBoundary(
             start_char, BoundaryType::kWord);
@@ -134,36 +141,160 @@ void TextLineImpl::SplitToWordDrawer(const LineRange& line_range,
         auto drawer = std::make_unique<DrawerPiece>(
             run, run_range->GetParent(), start_char - run->GetStartCharPos(),
             end_char - run->GetStartCharPos());
-        InsertDrawerPiece(std::move(drawer));
+        drawer_list_.emplace_back(std::move(drawer));
       }
     }
   }
 }
-void TextLineImpl::CreateDrawerPiece() {
+void TextLineImpl::CreateDrawerPiece() const {
+  drawer_pending_ = false;
+  InvalidateGlyphCache();
   if (!drawer_list_.empty()) drawer_list_.clear();
   auto align = paragraph_->GetParagraphStyle().GetHorizontalAlign();
   for (const auto& line_range : range_lst_) {
+    auto start_idx = static_cast<uint32_t>(drawer_list_.size());
     if (align == ParagraphHorizontalAlignment::kJustify) {
       SplitToWordDrawer(*line_range, 0);
     } else {
       for (const auto& run_range : line_range->run_range_lst_) {
-        auto drawer_piece = std::make_unique<DrawerPiece>(*run_range);
-        InsertDrawerPiece(std::move(drawer_piece));
+        drawer_list_.emplace_back(std::make_unique<DrawerPiece>(*run_range));
       }
     }
+    if (hyphen_run_ != nullptr && line_range == range_lst_.back()) {
+      drawer_list_.emplace_back(std::make_unique<DrawerPiece>(
+          hyphen_run_.get(), line_range.get(), 0, hyphen_run_->GetCharCount()));
+    }
+    ReorderDrawerPiece(start_idx);
   }
 }
-void TextLineImpl::InsertDrawerPiece(
-    std::unique_ptr<DrawerPiece> drawer_piece) {
-  auto iter = std::lower_bound(
-      drawer_list_.begin(), drawer_list_.end(), drawer_piece,
-      [&](const std::unique_ptr<DrawerPiece>& dpa,
-          const std::unique_ptr<DrawerPiece>& dpb) {
-        return dpa->GetVisualOrderIndex() <= dpb->GetVisualOrderIndex();
-      });
-  drawer_list_.insert(iter, std::move(drawer_piece));
+void TextLineImpl::EnsureDrawerPiece() const {
+  if (!drawer_pending_) return;
+  CreateDrawerPiece();
+  AlignDrawerPiece(paragraph_->GetParagraphStyle().GetHorizontalAlign());
+}
+/**
+ * @brief Start offset and word spacing of a range holding content_width of
+ * content with gap_count gaps between its pieces.
+ */
+std::pair<float, float> TextLineImpl::AlignRange(
+    const LineRange& range, float content_width, uint32_t gap_count,
+    ParagraphHorizontalAlignment align) const {
+  const auto start = range.GetXMin();
+  const auto rest_space = std::max(0.f, range.GetRangeWidth() - content_width);
+  if (align == ParagraphHorizontalAlignment::kCenter) {
+    return {start + rest_space / 2, 0.f};
+  }
+  if (align == ParagraphHorizontalAlignment::kRight) {
+    return {start + rest_space, 0.f};
+  }
+  if (align == ParagraphHorizontalAlignment::kJustify && gap_count > 0 &&
+      line_end_pos_.GetRunIdx() != paragraph_->GetRunCount() &&
+      paragraph_->boundary_analyst_->GetBoundaryTypeBefore(
+          paragraph_->LayoutPositionToCharPos(line_end_pos_)) <
+          BoundaryType::kMustLineBreak) {
+    return {start, (range.GetRangeWidth() - content_width) /
+                       static_cast<float>(gap_count)};
+  }
+  return {start, 0.f};
+}
+/**
+ * @brief Horizontal extent of the line content as ApplyAlignment() would place
+ * it, computed from the line ranges without building the drawer pieces.
+ */
+std::pair<float, float> TextLineImpl::GetAlignedContentExtent() const {
+  const auto align = paragraph_->GetParagraphStyle().GetHorizontalAlign();
+  auto left = range_lst_[0]->GetContentLeft();
+  auto right = left;
+  auto found = false;
+  for (const auto& range : range_lst_) {
+    const auto has_hyphen =
+        hyphen_run_ != nullptr && range == range_lst_.back();
+    if (range->Empty() && !has_hyphen) continue;
+    auto width = range->GetContentWidth();
+    if (has_hyphen) width += hyphen_run_->GetWidth(0);
+    // only whether the range has gaps matters, word spacing stretches the
+    // pieces to the range width. The hyphen takes no word spacing.
+    auto gap_count = 0u;
+    if (align == ParagraphHorizontalAlignment::kJustify && !range->Empty()) {
+      gap_count = static_cast<uint32_t>(range->run_range_lst_.size()) - 1;
+      const auto& run_range = range->run_range_lst_[0];
+      if (gap_count == 0 && !run_range->GetRun()->IsGhostRun() &&
+          paragraph_->boundary_analyst_->FindNextBoundary(
+              run_range->GetStartCharPosInParagraph(), BoundaryType::kWord) <
+              run_range->GetEndCharPosInParagraph()) {
+        gap_count = 1;
+      }
+    }
+    const auto [start, word_spacing] =
+        AlignRange(*range, width, gap_count, align);
+    if (!found) left = start;
+    found = true;
+    right = start + width + word_spacing * static_cast<float>(gap_count);
+  }
+  return {left, right};
+}
+/**
+ * @brief Reorder the pieces appended after start_idx from logical to visual
+ * order, using the bidi level of each piece (UAX#9 rule L2). The whitespace
+ * ending the range is reset to the paragraph level first (rule L1), split off
+ * its piece when the piece also holds other chars.
+ */
+void TextLineImpl::ReorderDrawerPiece(uint32_t start_idx) const {
+  const auto para_level = paragraph_->GetParagraphBidiLevel();
+  auto trailing_start = static_cast<uint32_t>(drawer_list_.size());
+  while (trailing_start > start_idx) {
+    const auto& piece = drawer_list_[trailing_start - 1];
+    const auto* run = piece->GetRun();
+    if (!run->IsTextRun() || piece->GetCharCount() == 0) break;
+    const auto start_char = piece->GetStartCharPosInParagraph();
+    auto space_start = piece->GetEndCharPosInParagraph();
+    while (space_start > start_char &&
+           base::IsSpaceChar(paragraph_->content_.GetUnicode(space_start - 1))) {
+      space_start--;
+    }
+    if (space_start == start_char) {
+      trailing_start--;
+      continue;
+    }
+    if (space_start < piece->GetEndCharPosInParagraph() &&
+        paragraph_->GetBidiLevel(space_start) != para_level) {
+      const auto* parent = piece->GetParent();
+      const auto end_char = piece->GetEndCharPosInParagraph();
+      drawer_list_[trailing_start - 1] = std::make_unique<DrawerPiece>(
+          run, parent, start_char - run->GetStartCharPos(),
+          space_start - run->GetStartCharPos());
+      drawer_list_.insert(
+          drawer_list_.begin() + trailing_start,
+          std::make_unique<DrawerPiece>(run, parent,
+                                        space_start - run->GetStartCharPos(),
+                                        end_char - run->GetStartCharPos()));
+    }
+    break;
+  }
+  auto count = static_cast<uint32_t>(drawer_list_.size()) - start_idx;
+  if (count < 2) return;
+  std::vector<uint8_t> levels(count);
+  auto has_rtl = false;
+  for (auto k = 0u; k < count; k++) {
+    levels[k] = start_idx + k >= trailing_start
+                    ? para_level
+                    : paragraph_->GetBidiLevel(
+                          drawer_list_[start_idx + k]
+                              ->GetStartCharPosInParagraph());
+    has_rtl |= levels[k] % 2 == 1;
+  }
+  if (!has_rtl) return;
+  std::vector<uint32_t> visual_order(count);
+  BidiRunTable::ReorderByLevels(levels.data(), count, visual_order.data());
+  std::vector<std::unique_ptr<DrawerPiece>> visual_list(count);
+  for (auto k = 0u; k < count; k++) {
+    visual_list[k] = std::move(drawer_list_[start_idx + visual_order[k]]);
+  }
+  std::move(visual_list.begin(), visual_list.end(),
+            drawer_list_.begin() + start_idx);
 }
 bool TextLineImpl::StripContentByWidth(float space) {
+  InvalidateGlyphCache();
   auto& range = range_lst_.back();
   auto range_width = range->x_max_;
   if (range_width < space) return false;
@@ -206,22 +337,10 @@ bool TextLineImpl::StripContentByWidth(float space) {
 }
 
 void TextLineImpl::AppendGhostRun(std::unique_ptr<BaseRun> ghost_run) {
+  InvalidateGlyphCache();
   auto drawer_piece = std::make_unique<RunRange>(
       ghost_run.get(), range_lst_.back().get(), 0, ghost_run->GetCharCount());
-  // Invalid paragraph direction for now
-  WriteDirection para_dir = paragraph_->GetParagraphStyle().GetWriteDirection();
-  TTASSERT(para_dir != WriteDirection::kTTB &&
-           para_dir != WriteDirection::kBTT);
-  if (para_dir == WriteDirection::kAuto) {
-    // Follow the way of paragraph direction detection in Lynx
-    if (GetParagraph()->GetCharCount() > 0 &&
-        GetParagraph()->IsRtlCharacter(0)) {
-      para_dir = WriteDirection::kRTL;
-    } else {
-      para_dir = WriteDirection::kLTR;
-    }
-  }
-  if (para_dir == WriteDirection::kRTL) {
+  if (paragraph_->GetParagraphBidiLevel() % 2 == 1) {
     std::vector<std::unique_ptr<DrawerPiece>> drawer_list;
     drawer_list.emplace_back(std::move(drawer_piece));
     drawer_list.insert(std::end(drawer_list),
@@ -235,6 +354,23 @@ void TextLineImpl::AppendGhostRun(std::unique_ptr<BaseRun> ghost_run) {
   extra_contents_.emplace_back(std::move(ghost_run));
 }
 
+/**
+ * @brief Prepare the hyphen appended to this line when it breaks before
+ * break_pos, the hyphen takes the style of the char before the break.
+ * @return width of the hyphen
+ */
+float TextLineImpl::CreateHyphenRun(CharPos break_pos) {
+  TTASSERT(break_pos > 0);
+  InvalidateGlyphCache();
+  const auto pos = paragraph_->CharPosToLayoutPosition(break_pos - 1);
+  const auto* run = paragraph_->GetRun(pos.GetRunIdx());
+  static constexpr char32_t kHyphen[] = U"-";
+  hyphen_run_ = std::make_unique<GhostRun>(
+      paragraph_, run->GetLayoutStyle(), break_pos - 1, kHyphen, 1);
+  hyphen_run_->Layout();
+  return hyphen_run_->GetWidth(0);
+}
+
 void TextLineImpl::ModifyHorizontalAlignment(
     ParagraphHorizontalAlignment h_align) {
   if (h_align == ParagraphHorizontalAlignment::kJustify &&
@@ -250,35 +386,35 @@ void TextLineImpl::ApplyAlignment() {
 }
 
 void TextLineImpl::ApplyAlignment(ParagraphHorizontalAlignment h_align) {
-  const auto align = h_align;
+  EnsureDrawerPiece();
+  AlignDrawerPiece(h_align);
+}
+void TextLineImpl::AlignDrawerPiece(ParagraphHorizontalAlignment h_align) const {
+  InvalidateGlyphCache();
   auto drawer_iter_begin = drawer_list_.begin();
   while (drawer_iter_begin != drawer_list_.end()) {
     const auto* line_range = (*drawer_iter_begin)->GetParent();
     auto drawer_iter_end = drawer_iter_begin;
     float total_width = 0;
     auto drawer_count = 0;
+    auto hyphen_iter = drawer_list_.end();
     while (drawer_iter_end != drawer_list_.end() &&
            ((*drawer_iter_end)->GetParent() == line_range)) {
       total_width += (*drawer_iter_end)->GetWidthWithIndent();
+      if ((*drawer_iter_end)->GetRun() == hyphen_run_.get()) {
+        hyphen_iter = drawer_iter_end;
+      }
       ++drawer_iter_end;
       ++drawer_count;
     }
-    auto start_offset = line_range->GetXMin();
-    auto word_spacing = 0.f;
-    float rest_space = std::max(0.f, line_range->GetRangeWidth() - total_width);
-    if (align == ParagraphHorizontalAlignment::kCenter) {
-      start_offset += rest_space / 2;
-    } else if (align == ParagraphHorizontalAlignment::kRight) {
-      start_offset += rest_space;
-    } else if (align == ParagraphHorizontalAlignment::kJustify) {
-      if (line_end_pos_.GetRunIdx() != paragraph_->GetRunCount() &&
-          (paragraph_->boundary_analyst_->GetBoundaryTypeBefore(
-               paragraph_->LayoutPositionToCharPos(line_end_pos_)) <
-           BoundaryType::kMustLineBreak)) {
-        auto available_space = line_range->GetRangeWidth() - total_width;
-        word_spacing = available_space / static_cast<float>(drawer_count - 1);
-      }
-    }
+    // the hyphen sticks to the word it ends, it takes no word spacing
+    const auto has_hyphen = hyphen_iter != drawer_list_.end();
+    const auto hyphen_is_last =
+        has_hyphen && std::next(hyphen_iter) == drawer_iter_end;
+    auto gap_count = static_cast<uint32_t>(drawer_count - 1);
+    if (has_hyphen && gap_count > 0) gap_count--;
+    auto [start_offset, word_spacing] =
+        AlignRange(*line_range, total_width, gap_count, h_align);
     for (; drawer_iter_begin != drawer_iter_end; ++drawer_iter_begin) {
       auto& drawer = *drawer_iter_begin;
       drawer->SetXOffset(start_offset);
@@ -294,19 +430,28 @@ void TextLineImpl::ApplyAlignment(ParagraphHorizontalAlignment h_align) {
           LayoutMeasurer::CalcElementY(cva, GetContentTop(), GetContentBottom(),
                                        GetContentBaseline(), metrics);
       drawer->SetYOffsetInLine(y_offset);
-      if (drawer->GetRun()->GetType() == RunType::kInlineObject ||
-          drawer->GetRun()->GetType() == RunType::kFloatObject) {
+      // a float keeps the position it has been placed at
+      if (drawer->GetRun()->GetType() == RunType::kInlineObject) {
         auto y = GetLineTop() + y_offset;
         drawer->GetRun()->GetRunDelegate()->SetOffset(
             start_offset, y + metrics.GetMaxAscent());
       }
-      start_offset += drawer->GetWidthWithIndent() + word_spacing;
+      start_offset += drawer->GetWidthWithIndent();
+      // no spacing between the hyphen and its word, at the visual end of the
+      // range the hyphen follows the word, otherwise it precedes it
+      const auto next = std::next(drawer_iter_begin);
+      if (!(next == hyphen_iter && hyphen_is_last) &&
+          !(drawer_iter_begin == hyphen_iter && !hyphen_is_last)) {
+        start_offset += word_spacing;
+      }
     }
   }
 }
 
 void TextLineImpl::ClearForRelayout() {
+  InvalidateGlyphCache();
   range_lst_.clear();
+  hyphen_run_ = nullptr;
   empty_ = true;
   layouted_ = false;
   max_ascent_ = max_descent_ = 0;
@@ -322,6 +467,8 @@ void TextLineImpl::StripByEllipsis(const char32_t* ellipsis) {
   if (ellipsis == nullptr) {
     ellipsis = para_style.GetEllipsis().c_str();
   }
+  EnsureDrawerPiece();
+  InvalidateGlyphCache();
   auto ellipsis_len = base::U32Strlen(ellipsis);
   if ((ellipsis != nullptr && ellipsis_len > 0) ||
       para_style.GetEllipsisDelegate() != nullptr) {
@@ -391,6 +538,7 @@ void TextLineImpl::StripByEllipsis(const char32_t* ellipsis) {
 void TextLineImpl::GetBoundingRectByCharRange(float bounding_rect[4],
                                               CharPos start_char_pos,
                                               CharPos end_char_pos) const {
+  EnsureDrawerPiece();
   TTASSERT(!drawer_list_.empty());
   auto* left_p = bounding_rect;
   auto* top_p = bounding_rect + 1;
@@ -478,6 +626,7 @@ void TextLineImpl::GetBoundingRectByCharRange(float bounding_rect[4],
   *height_p = std::max(0.f, bottom - top);
 }
 uint32_t TextLineImpl::GetCharPosByCoordinateX(float x) const {
+  EnsureDrawerPiece();
   RunRange* prev_drawer = nullptr;
   float prev_right = 0;
   for (auto& drawer : drawer_list_) {
@@ -504,7 +653,74 @@ uint32_t TextLineImpl::GetCharPosByCoordinateX(float x) const {
   return GetCharCount();
 }
 
+void TextLineImpl::GetInkBoundingRect(float bounding_rect[4]) const {
+  EnsureDrawerPiece();
+  float left = GetLineLeft(), top = GetLineTop(), right = left, bottom = top;
+  bool empty = true;
+  std::vector<GlyphID> glyphs;
+  std::vector<GlyphMetrics> metrics;
+  for (const auto& drawer : drawer_list_) {
+    const auto* run = drawer->GetRun();
+    if (!run->IsTextRun() && !(run->IsGhostRun() && run->GetCharCount() > 0)) {
+      continue;
+    }
+    // glyphs are placed the same way as LayoutDrawer::DrawDrawerPiece()
+    const auto& result = run->shape_result_;
+    auto piece_start =
+        drawer->GetStartCharPosInParagraph() - run->GetStartCharPos();
+    auto piece_end =
+        drawer->GetEndCharPosInParagraph() - run->GetStartCharPos();
+    auto glyph_start = result.CharToGlyph(piece_start);
+    auto glyph_count = result.CharToGlyph(piece_end) - glyph_start;
+    StyleRange style_range;
+    paragraph_->style_manager_->GetStyleRange(
+        &style_range, drawer->GetStartCharPosInParagraph(),
+        Style::BaselineOffsetFlag());
+    const auto baseline = GetLineTop() + drawer->GetYOffsetInLine() +
+                          style_range.GetStyle().GetBaselineOffset() +
+                          run->baseline_offset_;
+    const auto font_size = run->GetLayoutStyle().GetTextSize();
+    const auto letter_spacing = run->GetLayoutStyle().GetLetterSpacing();
+    auto glyph_idx = [&](uint32_t idx) {
+      return glyph_start + (run->IsRtl() ? glyph_count - idx - 1 : idx);
+    };
+    float x = drawer->GetXOffset();
+    uint32_t k = 0;
+    while (k < glyph_count) {
+      // one metrics lookup for each span of glyphs sharing a font
+      const auto& font = result.Font(glyph_idx(k));
+      auto end = k;
+      glyphs.clear();
+      while (end < glyph_count && result.Font(glyph_idx(end)) == font) {
+        glyphs.push_back(result.Glyphs(glyph_idx(end)));
+        end++;
+      }
+      metrics.resize(glyphs.size());
+      font->GetGlyphMetrics(glyphs.data(), static_cast<uint32_t>(glyphs.size()),
+                            font_size, metrics.data());
+      for (auto m = 0u; m < metrics.size(); m++, k++) {
+        const auto& bounds = metrics[m].bounds_;
+        auto y = baseline - result.Positions(glyph_idx(k))[1];
+        if (bounds[2] > bounds[0] && bounds[3] > bounds[1]) {
+          left = empty ? x + bounds[0] : std::min(left, x + bounds[0]);
+          top = empty ? y + bounds[1] : std::min(top, y + bounds[1]);
+          right = empty ? x + bounds[2] : std::max(right, x + bounds[2]);
+          bottom = empty ? y + bounds[3] : std::max(bottom, y + bounds[3]);
+          empty = false;
+        }
+        auto adv = result.Advances(glyph_idx(k))[0];
+        x += adv;
+        if (FloatsLarger(adv, 0)) x += letter_spacing;
+      }
+    }
+  }
+  bounding_rect[0] = left;
+  bounding_rect[1] = top;
+  bounding_rect[2] = right - left;
+  bounding_rect[3] = bottom - top;
+}
 void TextLineImpl::UpdateXMax(float width) {
+  InvalidateGlyphCache();
   if (!IsLayouted() || range_lst_.empty()) return;
   range_lst_.back()->SetXMax(width);
 }
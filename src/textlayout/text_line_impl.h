@@ -8,6 +8,7 @@
 #include <textra/text_line.h>
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "src/textlayout/internal/run_range.h"
@@ -16,6 +17,7 @@
 namespace ttoffice {
 namespace tttext {
 enum class LineType : uint8_t;
+struct LineGlyphCache;
 using DrawerPiece = RunRange;
 class TextLineImpl : public TextLine {
   friend LayoutRegion;
@@ -32,9 +34,15 @@ class TextLineImpl : public TextLine {
 
  private:
   void SetRangeLst(const std::vector<std::array<float, 2>>& lst);
-  void SplitToWordDrawer(const LineRange& line_range, float word_spacing);
-  void CreateDrawerPiece();
-  void InsertDrawerPiece(std::unique_ptr<DrawerPiece> drawer_piece);
+  void SplitToWordDrawer(const LineRange& line_range,
+                         float word_spacing) const;
+  void CreateDrawerPiece() const;
+  void ReorderDrawerPiece(uint32_t start_idx) const;
+  void AlignDrawerPiece(ParagraphHorizontalAlignment h_align) const;
+  std::pair<float, float> AlignRange(const LineRange& range,
+                                     float content_width, uint32_t gap_count,
+                                     ParagraphHorizontalAlignment align) const;
+  std::pair<float, float> GetAlignedContentExtent() const;
 
  public:
   LayoutPosition UpdateLine(LayoutPosition pos, float max_ascent,
@@ -68,6 +76,21 @@ class TextLineImpl : public TextLine {
   void ModifyHorizontalAlignment(ParagraphHorizontalAlignment h_align) override;
   bool StripContentByWidth(float space);
   void AppendGhostRun(std::unique_ptr<BaseRun> ghost_run);
+  float CreateHyphenRun(CharPos break_pos);
+  void ClearHyphenRun() {
+    hyphen_run_ = nullptr;
+    InvalidateGlyphCache();
+  }
+  bool EndsWithHyphen() const { return hyphen_run_ != nullptr; }
+  /**
+   * @brief Builds the drawer pieces skipped by a measure-only layout.
+   */
+  void EnsureDrawerPiece() const;
+  /**
+   * @brief Drops the glyph runs LayoutDrawer cached for this line, called by
+   * everything that moves or replaces the drawer pieces.
+   */
+  void InvalidateGlyphCache() const;
   TTStringPiece GetText() const;
 
  public:
@@ -75,6 +98,7 @@ class TextLineImpl : public TextLine {
                                   CharPos start_char_pos,
                                   CharPos end_char_pos) const override;
   CharPos GetCharPosByCoordinateX(float x) const override;
+  void GetInkBoundingRect(float bounding_rect[4]) const override;
 
  private:
   ParagraphImpl* paragraph_;
@@ -83,8 +107,17 @@ class TextLineImpl : public TextLine {
   LayoutPosition line_end_pos_{0, 0};
   int current_available_range_index_ = -1;
   std::vector<std::unique_ptr<LineRange>> range_lst_;
-  std::vector<std::unique_ptr<DrawerPiece>> drawer_list_;
+  // height of the band range_lst_ was computed for
+  float range_height_ = 0;
+  // drawer pieces and glyph runs are built lazily from the line ranges
+  mutable std::vector<std::unique_ptr<DrawerPiece>> drawer_list_;
   std::vector<std::unique_ptr<BaseRun>> extra_contents_;
+  // hyphen drawn at the line end when the line breaks inside a word
+  std::unique_ptr<BaseRun> hyphen_run_;
+  // drawer pieces were skipped by a measure-only layout
+  mutable bool drawer_pending_ = false;
+  // glyph runs of the last full line draw, see LayoutDrawer::SetCacheGlyphRuns
+  mutable std::unique_ptr<LineGlyphCache> glyph_cache_;
 };
 }  // namespace tttext
 }  // namespace ttoffice
@@ -88,12 +88,15 @@ ShapeResultRef TTShaper::ShapeText(const char32_t* text, uint32_t length,
     OnShapeText(key, result.get());
     TTASSERT(result->GlyphCount() > 0);
 
+    auto has_control_char = false;
     for (auto k = 0u; k < length; k++) {
       if (text[k] < 32) {
         result->advances_[result->CharToGlyph(k)][0] = 0;
         result->advances_[result->CharToGlyph(k)][1] = 0;
+        has_control_char = true;
       }
     }
+    if (has_control_char) result->BuildAdvancePrefix();
     ShapeCache::GetInstance().AddToCache(key, result);
   }
   TTASSERT(result != nullptr);
@@ -131,27 +134,70 @@ void ShapeResult::AppendPlatformShapingResult(
       c2glyph_indices_[k] = c2glyph_indices_[k - 1];
     }
   }
+  BuildAdvancePrefix();
+}
+void ShapeResult::BuildAdvancePrefix() {
+  const auto char_count = CharCount();
+  advance_prefix_.assign(char_count + 1, 0);
+  spacing_prefix_.assign(char_count + 1, 0);
+  for (auto k = 0u; k < char_count; k++) {
+    advance_prefix_[k + 1] = advance_prefix_[k];
+    spacing_prefix_[k + 1] = spacing_prefix_[k];
+    auto glyph_id = CharToGlyph(k);
+    if (glyph_id >= GlyphCount() || (k > 0 && glyph_id == CharToGlyph(k - 1))) {
+      continue;
+    }
+    auto adv = Advances(glyph_id)[0];
+    if (FloatsLarger(adv, 0)) {
+      advance_prefix_[k + 1] += adv;
+      spacing_prefix_[k + 1]++;
+    }
+  }
 }
 float ShapeResult::MeasureWidth(uint32_t start_char, uint32_t char_count,
                                 float letter_spacing) const {
-  uint32_t k = 0;
-  float width = 0;
-  uint32_t prev_glyph_id = -1;
-  while (k < char_count) {
-    TTASSERT(k + start_char < CharCount());
-    auto glyph_id = CharToGlyph(k + start_char);
-    TTASSERT(glyph_id < GlyphCount());
-    k++;
-    if (glyph_id == prev_glyph_id) {
-      continue;
+  if (char_count == 0) return 0;
+  const auto end_char = start_char + char_count;
+  TTASSERT(end_char < advance_prefix_.size());
+  auto width = advance_prefix_[end_char] - advance_prefix_[start_char];
+  auto spacing_count = spacing_prefix_[end_char] - spacing_prefix_[start_char];
+  // the first glyph is started by a char before the range
+  auto glyph_id = CharToGlyph(start_char);
+  if (start_char > 0 && glyph_id == CharToGlyph(start_char - 1)) {
+    auto adv = Advances(glyph_id)[0];
+    if (FloatsLarger(adv, 0)) {
+      width += adv;
+      spacing_count++;
     }
-    auto adv = Advances(glyph_id);
-    if (FloatsLarger(adv[0], 0)) {
-      width += adv[0] + letter_spacing;
+  }
+  return static_cast<float>(width + letter_spacing * spacing_count);
+}
+uint32_t ShapeResult::FitCharCount(uint32_t start_char, uint32_t max_char_count,
+                                   float letter_spacing,
+                                   float max_width) const {
+  TTASSERT(start_char + max_char_count <= CharCount());
+  if (letter_spacing < 0) {
+    // the width is not monotonic, a longer range may fit again
+    for (auto count = 1u; count <= max_char_count; count++) {
+      if (FloatsLarger(MeasureWidth(start_char, count, letter_spacing),
+                       max_width)) {
+        return count - 1;
+      }
+    }
+    return max_char_count;
+  }
+  uint32_t low = 0;
+  uint32_t high = max_char_count;
+  while (low < high) {
+    auto mid = high - (high - low) / 2;
+    if (FloatsLarger(MeasureWidth(start_char, mid, letter_spacing),
+                     max_width)) {
+      high = mid - 1;
+    } else {
+      low = mid;
     }
-    prev_glyph_id = glyph_id;
   }
-  return width;
+  return low;
 }
 }  // namespace tttext
 }  // namespace ttoffice
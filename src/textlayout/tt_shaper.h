@@ -228,8 +228,24 @@ class ShapeResult {
     advances_.resize(glyph_count);
     position_.resize(glyph_count);
   }
+  /**
+   * @brief Width of chars [start_char, start_char + char_count), a glyph
+   * shared by several chars is counted once. Runs in constant time on the
+   * prefix table built after shaping.
+   */
   float MeasureWidth(uint32_t start_char, uint32_t char_count,
                      float letter_spacing) const;
+  /**
+   * @brief Number of chars from start_char that fit in max_width, stopping at
+   * the first char that overflows. Binary search unless a negative
+   * letter_spacing lets the width shrink.
+   * @return char count in [0, max_char_count]
+   */
+  uint32_t FitCharCount(uint32_t start_char, uint32_t max_char_count,
+                        float letter_spacing, float max_width) const;
+
+ private:
+  void BuildAdvancePrefix();
 
  private:
   bool is_rtl_ = false;
@@ -239,6 +255,10 @@ class ShapeResult {
   std::vector<std::array<float, 2>> position_;  // size equal to char count
   std::vector<uint32_t> c2glyph_indices_;       // size equal to char count
   std::vector<uint32_t> indices_;               // glyph id to char id map
+  // sum of the positive advances of the glyphs started by chars [0, k), and
+  // the number of those glyphs, each of them takes one letter spacing
+  std::vector<double> advance_prefix_;  // size equal to char count + 1
+  std::vector<uint32_t> spacing_prefix_;  // size equal to char count + 1
 };
 
 }  // namespace tttext
@@ -0,0 +1,57 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef SRC_TEXTLAYOUT_UTILS_LITTLE_ENDIAN_H_
+#define SRC_TEXTLAYOUT_UTILS_LITTLE_ENDIAN_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace ttoffice {
+namespace tttext {
+namespace little_endian {
+template <typename T>
+using Bits = typename std::conditional<
+    sizeof(T) == 1, uint8_t,
+    typename std::conditional<sizeof(T) == 2, uint16_t, uint32_t>::type>::type;
+
+/**
+ * @brief Appends a 8, 16 or 32 bits value to data in little-endian order, the
+ * output does not depend on the byte order of the host.
+ */
+template <typename T>
+void Append(std::string* data, T value) {
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4,
+                "only 8, 16 and 32 bits fields are serialized");
+  Bits<T> bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  for (auto k = 0u; k < sizeof(bits); k++) {
+    data->push_back(static_cast<char>((bits >> (k * 8)) & 0xFF));
+  }
+}
+/**
+ * @brief Reads a value written by Append() at *offset and moves the offset
+ * past it. The caller checks that enough bytes are left.
+ */
+template <typename T>
+T Read(const uint8_t* data, size_t* offset) {
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4,
+                "only 8, 16 and 32 bits fields are serialized");
+  Bits<T> bits = 0;
+  for (auto k = 0u; k < sizeof(bits); k++) {
+    bits |= static_cast<Bits<T>>(static_cast<Bits<T>>(data[*offset + k])
+                                 << (k * 8));
+  }
+  *offset += sizeof(bits);
+  T value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}  // namespace little_endian
+}  // namespace tttext
+}  // namespace ttoffice
+
+#endif  // SRC_TEXTLAYOUT_UTILS_LITTLE_ENDIAN_H_
@@ -77,6 +77,18 @@ inline bool CheckValidUTF8String(const char* str) {
   }
   return true;
 }
+inline bool CheckValidUTF8String(const char* str, uint32_t length) {
+  uint32_t idx = 0;
+  while (idx < length) {
+    auto count = Utf8CharBytes(str + idx);
+    if (count == 0 || count > length - idx) return false;
+    for (auto k = 1u; k < count; k++) {
+      if (!IsUtf8Char10x(str + idx + k)) return false;
+    }
+    idx += count;
+  }
+  return true;
+}
 inline bool CheckIsLineBreakChar(const char* s) {
   return *s == '\n' || *s == '\r';
 }
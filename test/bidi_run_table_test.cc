@@ -0,0 +1,50 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/textlayout/internal/bidi_run_table.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+using namespace ttoffice::tttext;
+TEST(BidiRunTableTest, BuildRuns) {
+  const std::vector<uint8_t> levels{0, 0, 1, 1, 1, 0, 0};
+  BidiRunTable table;
+  table.Build(levels.data(), static_cast<uint32_t>(levels.size()));
+  ASSERT_EQ(table.GetRunCount(), 3u);
+  EXPECT_EQ(table.GetRun(1).start_, 2u);
+  EXPECT_EQ(table.GetRun(1).end_, 5u);
+  EXPECT_FALSE(table.IsRtl(1));
+  EXPECT_TRUE(table.IsRtl(3));
+  // positions past the end fall back to the last run
+  EXPECT_FALSE(table.IsRtl(100));
+}
+
+TEST(BidiRunTableTest, ReorderLtrParagraph) {
+  const std::vector<uint8_t> levels{0, 0, 1, 1, 1, 0, 0};
+  std::vector<uint32_t> order(levels.size());
+  BidiRunTable::ReorderByLevels(levels.data(),
+                                static_cast<uint32_t>(levels.size()),
+                                order.data());
+  EXPECT_EQ(order, (std::vector<uint32_t>{0, 1, 4, 3, 2, 5, 6}));
+}
+
+TEST(BidiRunTableTest, ReorderRtlParagraph) {
+  // rtl paragraph with an embedded ltr number
+  const std::vector<uint8_t> levels{1, 1, 2, 2, 1};
+  std::vector<uint32_t> order(levels.size());
+  BidiRunTable::ReorderByLevels(levels.data(),
+                                static_cast<uint32_t>(levels.size()),
+                                order.data());
+  EXPECT_EQ(order, (std::vector<uint32_t>{4, 2, 3, 1, 0}));
+}
+
+TEST(BidiRunTableTest, ReorderByLevels) {
+  const std::vector<uint8_t> levels{0, 1, 2, 1, 0};
+  std::vector<uint32_t> order(levels.size());
+  BidiRunTable::ReorderByLevels(levels.data(),
+                                static_cast<uint32_t>(levels.size()),
+                                order.data());
+  EXPECT_EQ(order, (std::vector<uint32_t>{0, 3, 2, 1, 4}));
+}
@@ -0,0 +1,149 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <textra/flat_layout_result.h>
+#include <textra/layout_region.h>
+#include <textra/recording_canvas_helper.h>
+#include <textra/text_layout.h>
+#include <textra/tttext_context.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "mocks.h"
+#include "test_utils.h"
+
+using namespace ttoffice::tttext;
+using namespace ::testing;
+
+namespace {
+constexpr const char* kText = "Hello World!";
+
+std::unique_ptr<LayoutRegion> LayoutUnderlinedText(ParagraphImpl* para) {
+  Style style;
+  style.SetTextSize(1.f);
+  style.SetDecorationType(DecorationType::kUnderLine);
+  style.SetDecorationStyle(LineType::kSolid);
+  style.SetDecorationColor(TTColor(TTColor::BLACK()));
+  para->AddTextRun(&style, kText);
+  TTTextContext context;
+  auto region = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(para, region.get(), context);
+  return region;
+}
+}  // namespace
+
+TEST(FlatLayoutResultTest, CaptureAndDraw) {
+  ParagraphImpl para;
+  auto region = LayoutUnderlinedText(&para);
+  auto result = FlatLayoutResult::Create(region.get());
+  ASSERT_NE(result, nullptr);
+  ASSERT_EQ(result->GetLineCount(), region->GetLineCount());
+  const auto& line = result->GetLine(0);
+  EXPECT_FLOAT_EQ(line.top_, region->GetLine(0)->GetLineTop());
+  EXPECT_EQ(line.end_char_, region->GetLine(0)->GetEndCharPos());
+  EXPECT_EQ(result->GetGlyphs().size(), strlen(kText));
+  EXPECT_EQ(result->GetPositionsX().size(), result->GetGlyphs().size());
+
+  // the result is self contained, the paragraph is not touched any more
+  region.reset();
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(NotNull(), strlen(kText), _, nullptr, 0, _, _, _, _,
+                         NotNull()))
+      .Times(1);
+  EXPECT_CALL(canvas_helper, DrawLine(0, _, strlen(kText), _, NotNull()))
+      .Times(1);
+  result->Draw(&canvas_helper);
+}
+
+TEST(FlatLayoutResultTest, PaintsAreDeduplicated) {
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  for (auto k = 0; k < 8; k++) {
+    para.AddTextRun(&style, "ab ");
+  }
+  TTTextContext context;
+  LayoutRegion region(3.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, &region, context);
+  auto result = FlatLayoutResult::Create(&region);
+  EXPECT_GT(result->GetOps().size(), 1u);
+  EXPECT_EQ(result->GetPaints().size(), 1u);
+
+  // a replay creates one painter per paint
+  NiceMock<MockCanvasHelper> canvas_helper;
+  EXPECT_CALL(canvas_helper, CreatePainter())
+      .Times(2)
+      .WillRepeatedly(Invoke([]() { return std::make_unique<Painter>(); }));
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, _, _, _, _, _, _, _, _, NotNull()))
+      .Times(AtLeast(2));
+  result->Draw(&canvas_helper);
+  result->DrawLines(&canvas_helper, 0, result->GetLineCount());
+}
+
+TEST(FlatLayoutResultTest, CountsDroppedOps) {
+  RecordingCanvasHelper recorder;
+  Painter painter;
+  recorder.DrawRect(0, 0, 1, 1, &painter);
+  EXPECT_EQ(recorder.FinishRecording()->GetDroppedOpCount(), 0u);
+  recorder.DrawArc(0, 0, 1, 1, 0, 90, false, &painter);
+  recorder.DrawPath(nullptr, &painter);
+  recorder.DrawRect(0, 0, 1, 1, &painter);
+  auto result = recorder.FinishRecording();
+  EXPECT_EQ(result->GetOps().size(), 1u);
+  EXPECT_EQ(result->GetDroppedOpCount(), 2u);
+}
+
+TEST(FlatLayoutResultTest, SerializeRoundTrip) {
+  ParagraphImpl para;
+  auto region = LayoutUnderlinedText(&para);
+  auto result = FlatLayoutResult::Create(region.get());
+  auto data = result->Serialize();
+  const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+
+  auto copy = FlatLayoutResult::Deserialize(bytes, data.size());
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(copy->Serialize(), data);
+  EXPECT_EQ(copy->GetLineCount(), result->GetLineCount());
+  EXPECT_EQ(copy->GetGlyphs(), result->GetGlyphs());
+  EXPECT_FLOAT_EQ(copy->GetHeight(), result->GetHeight());
+
+  EXPECT_EQ(FlatLayoutResult::Deserialize(bytes, data.size() - 1), nullptr);
+  auto corrupted = data;
+  corrupted[0] = 'X';
+  EXPECT_EQ(FlatLayoutResult::Deserialize(
+                reinterpret_cast<const uint8_t*>(corrupted.data()),
+                corrupted.size()),
+            nullptr);
+
+  // typefaces are resolved by id after deserialization
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, _, _, _, _, _, _, _, _, _))
+      .Times(0);
+  copy->Draw(&canvas_helper);
+  Mock::VerifyAndClearExpectations(&canvas_helper);
+
+  const auto& op = *std::find_if(
+      copy->GetOps().begin(), copy->GetOps().end(),
+      [](const FlatLayoutResult::Op& op) {
+        return op.op_ == CanvasOp::kDrawGlyphs;
+      });
+  const auto* typeface = result->GetTypeface(op.typeface_id_);
+  ASSERT_NE(typeface, nullptr);
+  EXPECT_CALL(canvas_helper, DrawGlyphs(typeface, _, _, _, _, _, _, _, _, _))
+      .Times(1);
+  copy->Draw(&canvas_helper, [typeface](uint32_t) { return typeface; });
+}
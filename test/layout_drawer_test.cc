@@ -9,12 +9,23 @@
 #include <textra/text_layout.h>
 #include <textra/tttext_context.h>
 
+#include <algorithm>
+#include <optional>
+
 #include "mocks.h"
 #include "test_utils.h"
 
 using namespace ttoffice::tttext;
 using namespace ::testing;
 
+namespace {
+class MockTestShape : public TestShape {
+ public:
+  MockTestShape(float width, float height) : TestShape(width, height) {}
+  MOCK_METHOD(void, Draw, (ICanvasHelper*, float, float), (override));
+};
+}  // namespace
+
 TEST(LayoutDrawer, DrawTextLine) {
   // Arrange
   const char* text = "Hello World!";
@@ -44,12 +55,15 @@ TEST(LayoutDrawer, DrawTextLine) {
   drawer.DrawTextLine(text_line, 0, text_length);
   Mock::VerifyAndClearExpectations(&canvas_helper);
 
-  // TODO: Fix DrawTextLine(_, char_start_in_line, char_end_in_line) not working
-  // EXPECT_CALL(canvas_helper,
-  //             DrawGlyphs(_, 1, _, StrEq("H"), 1, _, _, _, _, _))
-  //     .Times(1);
-  // drawer.DrawTextLine(text_line, 0, 1);
-  // Mock::VerifyAndClearExpectations(&canvas_helper);
+  // only the glyphs of the char range are drawn
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, 1, _, nullptr, 0, _, _, _, _, _))
+      .Times(1);
+  drawer.DrawTextLine(text_line, 0, 1);
+  Mock::VerifyAndClearExpectations(&canvas_helper);
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, 5, _, nullptr, 0, _, _, _, _, _))
+      .Times(1);
+  drawer.DrawTextLine(text_line, 6, 11);
+  Mock::VerifyAndClearExpectations(&canvas_helper);
 }
 
 TEST(LayoutDrawer, DrawLayoutPage_Text) {
@@ -70,9 +84,10 @@ TEST(LayoutDrawer, DrawLayoutPage_Text) {
   // Assert
   NiceMock<MockCanvasHelper> canvas_helper;
   LayoutDrawer drawer(&canvas_helper);
-  EXPECT_CALL(canvas_helper, CreatePainter()).WillOnce(Invoke([]() {
-    return std::make_unique<Painter>();
-  }));
+  // one painter for the text style, one for the batched glyph run
+  EXPECT_CALL(canvas_helper, CreatePainter())
+      .Times(2)
+      .WillRepeatedly(Invoke([]() { return std::make_unique<Painter>(); }));
   EXPECT_CALL(canvas_helper,
               DrawGlyphs(_, text_length, _, nullptr, 0, _, _, _, _, _))
       .Times(1);
@@ -114,11 +129,6 @@ TEST(LayoutDrawer, DrawLayoutPage_RunDelegate) {
   const float width = 100.f;
   const float height = 100.f;
 
-  class MockTestShape : public TestShape {
-   public:
-    MockTestShape(float width, float height) : TestShape(width, height) {}
-    MOCK_METHOD(void, Draw, (ICanvasHelper*, float, float), (override));
-  };
   auto run_delegate = std::make_shared<NiceMock<MockTestShape>>(30.f, 10.f);
 
   ParagraphImpl para;
@@ -138,10 +148,338 @@ TEST(LayoutDrawer, DrawLayoutPage_RunDelegate) {
   // Assert
   NiceMock<MockCanvasHelper> canvas_helper;
   LayoutDrawer drawer(&canvas_helper);
-  auto painter = std::make_unique<Painter>();
   EXPECT_CALL(canvas_helper, CreatePainter())
-      .WillOnce(Return(ByMove(std::move(painter))));
+      .Times(2)
+      .WillRepeatedly(Invoke([]() { return std::make_unique<Painter>(); }));
   EXPECT_CALL(*run_delegate, Draw(&canvas_helper, _, _)).Times(1);
   // Act
   drawer.DrawLayoutPage(page.get());
 }
+
+TEST(LayoutDrawer, DrawLayoutPage_DisplayList) {
+  const char* text = "Hello World!";
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  para.AddTextRun(&style, text);
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  LayoutDrawer drawer(&canvas_helper);
+  drawer.SetUseDisplayList(true);
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(_, strlen(text), _, nullptr, 0, _, _, _, _, _))
+      .Times(2);
+  drawer.DrawLayoutPage(page.get());
+  auto display_list = page->GetDisplayList();
+  ASSERT_NE(display_list, nullptr);
+  // the second draw replays the cached display list
+  drawer.DrawLayoutPage(page.get());
+  EXPECT_EQ(page->GetDisplayList(), display_list);
+  Mock::VerifyAndClearExpectations(&canvas_helper);
+
+  page->InvalidateDisplayList();
+  EXPECT_EQ(page->GetDisplayList(), nullptr);
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, _, _, _, _, _, _, _, _, _))
+      .Times(1);
+  drawer.DrawLayoutPage(page.get(), 0, 100.f);
+  EXPECT_NE(page->GetDisplayList(), nullptr);
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_DisplayListPerListener) {
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  para.AddTextRun(&style, "Hello World!");
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  LayoutDrawer drawer(&canvas_helper);
+  drawer.SetUseDisplayList(true);
+  drawer.DrawLayoutPage(page.get());
+  auto display_list = page->GetDisplayList();
+  ASSERT_NE(display_list, nullptr);
+  // another listener resolves theme colors on its own
+  LayoutDrawerListener listener;
+  LayoutDrawer other_drawer(&canvas_helper);
+  other_drawer.SetUseDisplayList(true);
+  other_drawer.SetListener(&listener);
+  other_drawer.DrawLayoutPage(page.get());
+  ASSERT_NE(page->GetDisplayList(), nullptr);
+  EXPECT_NE(page->GetDisplayList(), display_list);
+  display_list = page->GetDisplayList();
+  other_drawer.DrawLayoutPage(page.get());
+  EXPECT_EQ(page->GetDisplayList(), display_list);
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_DisplayListSkipsRunDelegates) {
+  auto run_delegate = std::make_shared<NiceMock<MockTestShape>>(30.f, 10.f);
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  para.AddGhostShapeRun(&style, run_delegate);
+  para.AddTextRun(&style, "text");
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  LayoutDrawer drawer(&canvas_helper);
+  drawer.SetUseDisplayList(true);
+  // the delegate draws onto the canvas each time
+  EXPECT_CALL(*run_delegate, Draw(&canvas_helper, _, _)).Times(2);
+  drawer.DrawLayoutPage(page.get());
+  drawer.DrawLayoutPage(page.get());
+  EXPECT_EQ(page->GetDisplayList(), nullptr);
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_ReusesPainters) {
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  style.SetBackgroundColor(TTColor(TTColor::RED()));
+  style.SetDecorationType(DecorationType::kUnderLine);
+  style.SetDecorationStyle(LineType::kSolid);
+  style.SetDecorationColor(TTColor(TTColor::BLACK()));
+  para.AddTextRun(&style, "Hello World! Hello World! Hello World!");
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(10.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+  ASSERT_GT(page->GetLineCount(), 1u);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  LayoutDrawer drawer(&canvas_helper);
+  // backgrounds, text styles and decorations of every line share one
+  // painter, the batched glyph runs another one
+  EXPECT_CALL(canvas_helper, CreatePainter())
+      .Times(2)
+      .WillRepeatedly(Invoke([]() { return std::make_unique<Painter>(); }));
+  EXPECT_CALL(canvas_helper, DrawRect(_, _, _, _, NotNull()))
+      .Times(AtLeast(page->GetLineCount()));
+  drawer.DrawLayoutPage(page.get());
+  drawer.DrawLayoutPage(page.get());
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_BatchesGlyphRuns) {
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  para.AddTextRun(&style, "Hello ");
+  para.AddTextRun(&style, "World!");
+  Style red_style = style;
+  red_style.SetForegroundColor(TTColor(TTColor::RED()));
+  para.AddTextRun(&red_style, "Hi");
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+  ASSERT_EQ(page->GetLineCount(), 1u);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  LayoutDrawer drawer(&canvas_helper);
+  // the runs with the same paint are merged, the red one stays apart
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, 12, _, _, _, _, _, _, _, _))
+      .Times(1);
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(_, 2, _, _, _, _, _, _, _,
+                         Property(&Painter::GetColor, TTColor::RED())))
+      .Times(1);
+  drawer.DrawLayoutPage(page.get());
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_MergesContiguousGlyphRuns) {
+  auto max_run_glyphs = [](ParagraphHorizontalAlignment align) {
+    ParagraphImpl para;
+    Style style;
+    style.SetTextSize(1.f);
+    ParagraphStyle para_style;
+    para_style.SetDefaultStyle(style);
+    para_style.SetHorizontalAlign(align);
+    para.SetParagraphStyle(&para_style);
+    para.AddTextRun(&style, "ab ");
+    para.AddTextRun(&style, "cd ");
+    para.AddTextRun(&style, "efgh");
+    TTTextContext context;
+    auto page = std::make_unique<LayoutRegion>(8.f, 100.f);
+    TextLayout layout(TestUtils::getTestShaper());
+    layout.Layout(&para, page.get(), context);
+    EXPECT_EQ(page->GetLineCount(), 2u);
+
+    NiceMock<MockCanvasHelper> canvas_helper;
+    ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+      return std::make_unique<Painter>();
+    }));
+    uint32_t max_glyphs = 0;
+    ON_CALL(canvas_helper, DrawGlyphs)
+        .WillByDefault([&max_glyphs](const ITypefaceHelper*,
+                                     uint32_t glyph_count, const uint16_t*,
+                                     const char*, uint32_t, float, float,
+                                     float*, float*, Painter*) {
+          max_glyphs = std::max(max_glyphs, glyph_count);
+        });
+    LayoutDrawer drawer(&canvas_helper);
+    drawer.DrawLayoutPage(page.get());
+    return max_glyphs;
+  };
+  // the runs of the first line touch each other
+  EXPECT_EQ(max_run_glyphs(ParagraphHorizontalAlignment::kLeft), 6u);
+  // justify moves the second word away from the first one
+  EXPECT_EQ(max_run_glyphs(ParagraphHorizontalAlignment::kJustify), 4u);
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_CachesGlyphRuns) {
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  para.AddTextRun(&style, "Hello ");
+  para.AddTextRun(&style, "World!");
+  Style red_style = style;
+  red_style.SetForegroundColor(TTColor(TTColor::RED()));
+  para.AddTextRun(&red_style, "Hi");
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+  ASSERT_EQ(page->GetLineCount(), 1u);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  LayoutDrawer drawer(&canvas_helper);
+  drawer.SetCacheGlyphRuns(true);
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, 12, _, _, _, _, _, _, _, _))
+      .Times(2);
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(_, 2, _, _, _, _, _, _, _,
+                         Property(&Painter::GetColor, TTColor::RED())))
+      .Times(2);
+  drawer.DrawLayoutPage(page.get());
+  drawer.DrawLayoutPage(page.get());
+  Mock::VerifyAndClearExpectations(&canvas_helper);
+
+  // a color change of a whole cached run only recolors its painter, the
+  // cached runs are all drawn again
+  Style blue_style;
+  blue_style.SetForegroundColor(TTColor(TTColor::BLUE()));
+  para.ApplyStyleInRange(blue_style, 12, 2);
+  EXPECT_CALL(canvas_helper, CreatePainter()).Times(0);
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, 12, _, _, _, _, _, _, _, _))
+      .Times(1);
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(_, 2, _, _, _, _, _, _, _,
+                         Property(&Painter::GetColor, TTColor::BLUE())))
+      .Times(1);
+  drawer.DrawLayoutPage(page.get());
+  Mock::VerifyAndClearExpectations(&canvas_helper);
+
+  // a color change splitting a cached run draws the line again
+  para.ApplyStyleInRange(blue_style, 0, 3);
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(_, 3, _, _, _, _, _, _, _,
+                         Property(&Painter::GetColor, TTColor::BLUE())))
+      .Times(1);
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, 9, _, _, _, _, _, _, _, _))
+      .Times(1);
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(_, 2, _, _, _, _, _, _, _,
+                         Property(&Painter::GetColor, TTColor::BLUE())))
+      .Times(1);
+  drawer.DrawLayoutPage(page.get());
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_GlyphCacheOfAnotherDrawer) {
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  para.AddTextRun(&style, "Hello World!");
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+  ASSERT_EQ(page->GetLineCount(), 1u);
+
+  auto create_painter = []() { return std::make_unique<Painter>(); };
+  std::optional<NiceMock<MockCanvasHelper>> canvas_helper;
+  canvas_helper.emplace();
+  ON_CALL(*canvas_helper, CreatePainter())
+      .WillByDefault(Invoke(create_painter));
+  auto* first_canvas = &*canvas_helper;
+  {
+    LayoutDrawer drawer(first_canvas);
+    drawer.SetCacheGlyphRuns(true);
+    drawer.DrawLayoutPage(page.get());
+  }
+  // a canvas allocated where the first one was does not draw the painters of
+  // the first one
+  canvas_helper.reset();
+  canvas_helper.emplace();
+  ASSERT_EQ(&*canvas_helper, first_canvas);
+  ON_CALL(*canvas_helper, CreatePainter())
+      .WillByDefault(Invoke(create_painter));
+  EXPECT_CALL(*canvas_helper, CreatePainter()).Times(AtLeast(1));
+  EXPECT_CALL(*canvas_helper, DrawGlyphs(_, 12, _, _, _, _, _, _, _, _))
+      .Times(1);
+  LayoutDrawer drawer(&*canvas_helper);
+  drawer.SetCacheGlyphRuns(true);
+  drawer.DrawLayoutPage(page.get());
+}
+
+TEST(LayoutDrawer, DrawLayoutPage_ClipRect) {
+  ParagraphImpl para;
+  Style style;
+  style.SetTextSize(1.f);
+  const uint32_t colors[] = {TTColor::RED(), TTColor::GREEN(),
+                             TTColor::BLUE()};
+  for (auto color : colors) {
+    style.SetForegroundColor(TTColor(color));
+    para.AddTextRun(&style, "aaaaaaaaaa");
+  }
+  TTTextContext context;
+  auto page = std::make_unique<LayoutRegion>(100.f, 100.f);
+  TextLayout layout(TestUtils::getTestShaper());
+  layout.Layout(&para, page.get(), context);
+  ASSERT_EQ(page->GetLineCount(), 1u);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  LayoutDrawer drawer(&canvas_helper);
+  // only the piece crossing the clip is drawn
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, _, _, _, _, _, _, _, _, _))
+      .Times(0);
+  EXPECT_CALL(canvas_helper,
+              DrawGlyphs(_, 10, _, _, _, _, _, _, _,
+                         Property(&Painter::GetColor, TTColor::BLUE())))
+      .Times(1);
+  const float clip[] = {25.f, 0.f, 26.f, 100.f};
+  drawer.DrawLayoutPage(page.get(), clip);
+  Mock::VerifyAndClearExpectations(&canvas_helper);
+
+  // nothing is drawn for a clip below the lines
+  EXPECT_CALL(canvas_helper, DrawGlyphs(_, _, _, _, _, _, _, _, _, _))
+      .Times(0);
+  const float below[] = {0.f, 50.f, 100.f, 100.f};
+  drawer.DrawLayoutPage(page.get(), below);
+}
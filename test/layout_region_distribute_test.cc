@@ -0,0 +1,161 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+#include <textra/layout_region_distribute.h>
+#include <textra/paragraph_style.h>
+#include <textra/text_layout.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/textlayout/paragraph_impl.h"
+#include "test_utils.h"
+
+using namespace ttoffice::tttext;
+
+namespace {
+constexpr float kFontSize = 10.f;
+constexpr float kColumnWidth = 10 * kFontSize;
+
+class LayoutRegionDistributeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    layout_ = std::make_unique<TextLayout>(TestUtils::getTestShaper());
+    for (auto k = 0; k < 4; k++) {
+      auto paragraph = std::make_unique<ParagraphImpl>();
+      Style style;
+      style.SetTextSize(kFontSize);
+      paragraph->GetParagraphStyle().SetDefaultStyle(style);
+      std::string content;
+      for (auto w = 0; w < 8 + k * 4; w++) content += "word ";
+      paragraph->AddTextRun(&style, content.c_str());
+      paragraphs_.push_back(std::move(paragraph));
+    }
+  }
+  std::unique_ptr<LayoutRegionDistribute> CreateDistribute() const {
+    std::vector<Paragraph*> paragraphs;
+    for (auto& paragraph : paragraphs_) paragraphs.push_back(paragraph.get());
+    return std::make_unique<LayoutRegionDistribute>(layout_.get(),
+                                                    std::move(paragraphs));
+  }
+  // checks that every line starts where the previous one ended
+  void ExpectContinuousFlow(const LayoutRegionDistribute& distribute) const {
+    auto para_idx = 0u;
+    uint32_t char_pos = 0;
+    for (auto r = 0u; r < distribute.GetRegionCount(); r++) {
+      auto* region = distribute.GetRegion(r);
+      ASSERT_NE(region, nullptr);
+      for (auto k = 0u; k < region->GetLineCount(); k++) {
+        auto* line = region->GetLine(k);
+        if (line->GetParagraph() != paragraphs_[para_idx].get()) {
+          EXPECT_EQ(char_pos, paragraphs_[para_idx]->GetCharCount());
+          para_idx++;
+          char_pos = 0;
+        }
+        ASSERT_EQ(line->GetParagraph(), paragraphs_[para_idx].get());
+        EXPECT_EQ(line->GetStartCharPos(), char_pos);
+        char_pos = line->GetEndCharPos();
+      }
+    }
+    EXPECT_EQ(para_idx, paragraphs_.size() - 1);
+    EXPECT_EQ(char_pos, paragraphs_.back()->GetCharCount());
+  }
+
+  std::unique_ptr<TextLayout> layout_;
+  std::vector<std::unique_ptr<ParagraphImpl>> paragraphs_;
+};
+}  // namespace
+
+TEST_F(LayoutRegionDistributeTest, FlowsAcrossRegions) {
+  auto distribute = CreateDistribute();
+  distribute->AddRegion(kColumnWidth, 8 * kFontSize);
+  distribute->AddRegion(kColumnWidth, 8 * kFontSize);
+  EXPECT_FALSE(distribute->Layout());
+  EXPECT_TRUE(distribute->HasOverflow());
+
+  distribute->AddRegion(kColumnWidth, 100 * kFontSize);
+  EXPECT_TRUE(distribute->Layout());
+  EXPECT_FALSE(distribute->HasOverflow());
+  EXPECT_GT(distribute->GetRegion(0)->GetLineCount(), 0u);
+  EXPECT_GT(distribute->GetRegion(1)->GetLineCount(), 0u);
+  ExpectContinuousFlow(*distribute);
+}
+
+TEST_F(LayoutRegionDistributeTest, ResizeRegionKeepsUpstreamRegions) {
+  auto distribute = CreateDistribute();
+  for (auto k = 0; k < 4; k++) {
+    distribute->AddRegion(kColumnWidth, 6 * kFontSize);
+  }
+  distribute->Layout();
+  auto* first = distribute->GetRegion(0);
+  auto line_count = distribute->GetRegion(1)->GetLineCount();
+
+  EXPECT_TRUE(distribute->ResizeRegion(1, kColumnWidth, 40 * kFontSize));
+  EXPECT_EQ(distribute->GetRegion(0), first);
+  EXPECT_GT(distribute->GetRegion(1)->GetLineCount(), line_count);
+  ExpectContinuousFlow(*distribute);
+}
+
+TEST_F(LayoutRegionDistributeTest, BalanceColumns) {
+  auto distribute = CreateDistribute();
+  for (auto k = 0; k < 3; k++) {
+    distribute->AddRegion(kColumnWidth, 0);
+  }
+  const float max_height = 1000 * kFontSize;
+  auto height = distribute->BalanceColumns(max_height);
+  EXPECT_FALSE(distribute->HasOverflow());
+  ExpectContinuousFlow(*distribute);
+
+  // a single column holding everything
+  auto single = CreateDistribute();
+  single->AddRegion(kColumnWidth, max_height);
+  ASSERT_TRUE(single->Layout());
+  auto total_height = single->GetRegion(0)->GetLayoutedHeight();
+  EXPECT_LT(height, total_height);
+  EXPECT_GE(height * 3, total_height);
+  for (auto k = 0u; k < distribute->GetRegionCount(); k++) {
+    auto* region = distribute->GetRegion(k);
+    EXPECT_GT(region->GetLineCount(), 0u);
+    EXPECT_LE(region->GetLayoutedHeight(), height + 1e-3f);
+  }
+  // a bit lower and the content does not fit anymore
+  for (auto k = 0u; k < distribute->GetRegionCount(); k++) {
+    distribute->ResizeRegion(k, kColumnWidth, height - 1);
+  }
+  distribute->GetContext().SetLastLineCanOverflow(false);
+  EXPECT_FALSE(distribute->Layout());
+}
+
+TEST_F(LayoutRegionDistributeTest, BalanceColumnsAfterContentChange) {
+  auto distribute = CreateDistribute();
+  for (auto k = 0; k < 3; k++) {
+    distribute->AddRegion(kColumnWidth, 0);
+  }
+  const float max_height = 1000 * kFontSize;
+  const auto height = distribute->BalanceColumns(max_height);
+  ASSERT_LT(height, max_height);
+
+  // the lines measured for the previous content are not reused
+  Style style;
+  style.SetTextSize(kFontSize);
+  std::string content;
+  for (auto w = 0; w < 40; w++) content += "more ";
+  paragraphs_.back()->AddTextRun(&style, content.c_str());
+  paragraphs_.back()->ClearLayout();
+  const auto longer_height = distribute->BalanceColumns(max_height);
+  EXPECT_GT(longer_height, height);
+  EXPECT_LT(longer_height, max_height);
+  EXPECT_FALSE(distribute->HasOverflow());
+  ExpectContinuousFlow(*distribute);
+
+  // a style changed through the reference returned by GetParagraphStyle()
+  paragraphs_[0]->GetParagraphStyle().SetLineHeightInPxExact(3 * kFontSize);
+  const auto larger_height = distribute->BalanceColumns(max_height);
+  EXPECT_GT(larger_height, longer_height);
+  EXPECT_LT(larger_height, max_height);
+  EXPECT_FALSE(distribute->HasOverflow());
+}
@@ -8,7 +8,9 @@
 #include <textra/layout_region.h>
 #include <textra/tttext_context.h>
 
+#include <array>
 #include <memory>
+#include <vector>
 
 #include "text_line_impl.h"
 
@@ -61,3 +63,93 @@ TEST(LayoutRegionTest, AddLineNotifiesListener) {
   TTTextContext context;
   region->AddLine(std::move(line), context);
 }
+
+TEST(LayoutRegionTest, GetRangeListWithExclusions) {
+  LayoutRegion region(100.f, 100.f);
+  float top = 0;
+  auto list = region.GetRangeList(&top, 10.f, 0.f, 0.f);
+  ASSERT_EQ(list.size(), 1u);
+  EXPECT_FLOAT_EQ(list[0][0], 0.f);
+  EXPECT_FLOAT_EQ(list[0][1], 100.f);
+
+  region.AddExclusionRect(0.f, 0.f, 30.f, 20.f);
+  region.AddExclusionRect(60.f, 10.f, 10.f, 50.f);
+  using Ranges = std::vector<std::array<float, 2>>;
+  {
+    top = 0;
+    list = region.GetRangeList(&top, 10.f, 5.f, 5.f);
+    EXPECT_EQ(list, (Ranges{{30.f, 95.f}}));
+    EXPECT_FLOAT_EQ(top, 20.f);
+  }
+  {
+    top = 15;
+    list = region.GetRangeList(&top, 10.f, 0.f, 0.f);
+    EXPECT_EQ(list, (Ranges{{30.f, 60.f}, {70.f, 100.f}}));
+    EXPECT_FLOAT_EQ(top, 20.f);
+  }
+  {
+    top = 20;
+    list = region.GetRangeList(&top, 10.f, 0.f, 0.f);
+    EXPECT_EQ(list, (Ranges{{0.f, 60.f}, {70.f, 100.f}}));
+    EXPECT_FLOAT_EQ(top, 60.f);
+  }
+  {
+    top = 60;
+    list = region.GetRangeList(&top, 10.f, 0.f, 0.f);
+    EXPECT_EQ(list, (Ranges{{0.f, 100.f}}));
+  }
+}
+
+TEST(LayoutRegionTest, GetRangeListFullyCovered) {
+  LayoutRegion region(100.f, 100.f);
+  region.AddExclusionRect(0.f, 0.f, 40.f, 30.f);
+  region.AddExclusionRect(40.f, 5.f, 60.f, 10.f);
+  float top = 10;
+  auto list = region.GetRangeList(&top, 2.f, 0.f, 0.f);
+  ASSERT_EQ(list.size(), 1u);
+  EXPECT_FLOAT_EQ(list[0][1] - list[0][0], 0.f);
+  // the lowest bottom among the crossing exclusions
+  EXPECT_FLOAT_EQ(top, 15.f);
+}
+
+TEST(LayoutRegionTest, RangeListMayChange) {
+  LayoutRegion region(100.f, 100.f);
+  EXPECT_FALSE(region.RangeListMayChange(0.f, 10.f, 20.f));
+  region.AddExclusionRect(0.f, 5.f, 30.f, 20.f);
+  region.AddExclusionRect(60.f, 40.f, 10.f, 10.f);
+  // already crossed by the band before it grows
+  EXPECT_FALSE(region.RangeListMayChange(0.f, 10.f, 20.f));
+  EXPECT_TRUE(region.RangeListMayChange(0.f, 2.f, 10.f));
+  EXPECT_FALSE(region.RangeListMayChange(20.f, 10.f, 20.f));
+  EXPECT_TRUE(region.RangeListMayChange(20.f, 10.f, 30.f));
+}
+
+TEST(LayoutRegionTest, GetRangeListWithUnsortedExclusions) {
+  LayoutRegion region(200.f, 200.f);
+  // 2px wide strips, strip k covers [3k, 3k + 5), added out of top order
+  constexpr uint32_t kCount = 40;
+  for (auto n = 0u; n < kCount; n++) {
+    const auto k = n * 7 % kCount;
+    region.AddExclusionRect(10.f + k * 4.f, k * 3.f, 2.f, 5.f);
+  }
+  for (auto band_top = 0.f; band_top < kCount * 3.f; band_top += 2.5f) {
+    auto crossing = 0u;
+    for (auto k = 0u; k < kCount; k++) {
+      if (k * 3.f < band_top + 1.f && band_top < k * 3.f + 5.f) crossing++;
+    }
+    float top = band_top;
+    auto list = region.GetRangeList(&top, 1.f, 0.f, 0.f);
+    EXPECT_EQ(list.size(), crossing + 1) << band_top;
+  }
+}
+
+TEST(LayoutRegionTest, ResetKeepsExclusionRects) {
+  LayoutRegion region(100.f, 100.f);
+  region.AddExclusionRect(0.f, 0.f, 30.f, 20.f);
+  region.Reset();
+  float top = 0;
+  auto list = region.GetRangeList(&top, 10.f, 0.f, 0.f);
+  ASSERT_EQ(list.size(), 1u);
+  EXPECT_FLOAT_EQ(list[0][0], 30.f);
+  EXPECT_EQ(region.GetLineCount(), 0u);
+}
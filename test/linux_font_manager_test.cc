@@ -0,0 +1,213 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <textra/platform/linux/linux_font_manager.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mocks.h"
+#include "src/ports/platform/linux/font_index.h"
+
+using namespace ttoffice::tttext;
+using namespace ::testing;
+
+class LinuxFontManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const char* tmp = std::getenv("TMPDIR");
+    std::string dir = tmp != nullptr && tmp[0] != '\0' ? tmp : "/tmp";
+    while (dir.length() > 1 && dir.back() == '/') dir.pop_back();
+    dir += "/linux_font_manager_test.XXXXXX";
+    ASSERT_NE(mkdtemp(&dir[0]), nullptr);
+    temp_dir_ = dir;
+  }
+  void TearDown() override {
+    for (const auto& path : temp_files_) std::remove(path.c_str());
+    if (!temp_dir_.empty()) rmdir(temp_dir_.c_str());
+  }
+  // a path in the temp dir, removed by TearDown()
+  std::string TempPath(const std::string& name) {
+    temp_files_.push_back(temp_dir_ + "/" + name);
+    return temp_files_.back();
+  }
+  LinuxFontManager::TypefaceFactory MakeFactory() {
+    return [this](const std::string& path, int ttc_index) -> TypefaceRef {
+      created_.push_back(path + "#" + std::to_string(ttc_index));
+      return std::make_shared<NiceMock<MockTypefaceHelper>>(
+          static_cast<uint32_t>(created_.size()));
+    };
+  }
+  // Writes an index of one family with a face per style, the faces are taken
+  // from an index matching the size and modification time of their files, so
+  // the files don't need to be real fonts. Returns the path of the index.
+  std::string WriteIndex(
+      const std::string& family,
+      const std::vector<std::pair<std::string, FontStyle>>& faces) {
+    std::vector<FontFileRecord> files;
+    for (const auto& [name, style] : faces) {
+      FontFileRecord file;
+      file.path_ = TempPath(name + ".ttf");
+      auto* font = std::fopen(file.path_.c_str(), "wb");
+      EXPECT_NE(font, nullptr);
+      if (font == nullptr) return {};
+      std::fputs("not a font", font);
+      std::fclose(font);
+      struct stat st = {};
+      EXPECT_EQ(stat(file.path_.c_str(), &st), 0);
+      file.size_ = static_cast<uint64_t>(st.st_size);
+      file.mtime_ = static_cast<int64_t>(st.st_mtime);
+      FontFaceRecord face;
+      face.families_ = {family};
+      face.style_ = style;
+      face.coverage_ = {{'A', 'Z'}};
+      file.faces_.push_back(face);
+      files.push_back(file);
+    }
+    const auto index_path = TempPath("fonts.index");
+    const auto index = FontIndex::Serialize(files);
+    auto* file = std::fopen(index_path.c_str(), "wb");
+    EXPECT_NE(file, nullptr);
+    if (file == nullptr) return {};
+    std::fwrite(index.data(), 1, index.size(), file);
+    std::fclose(file);
+    return index_path;
+  }
+  bool LastCreatedContains(const char* str) const {
+    return !created_.empty() &&
+           created_.back().find(str) != std::string::npos;
+  }
+
+  std::vector<std::string> created_;
+  std::string temp_dir_;
+  std::vector<std::string> temp_files_;
+};
+
+TEST_F(LinuxFontManagerTest, MatchFromIndex) {
+  LinuxFontManager manager({FONT_ROOT}, MakeFactory());
+  ASSERT_GT(manager.GetFaceCount(), 0u);
+  // nothing is opened until a face is matched
+  EXPECT_TRUE(created_.empty());
+
+  auto inter = manager.matchFamilyStyle("Inter", FontStyle::Normal());
+  ASSERT_NE(inter, nullptr);
+  EXPECT_TRUE(LastCreatedContains("Inter"));
+  // family names are case insensitive and a face is created once
+  EXPECT_EQ(manager.matchFamilyStyle("INTER", FontStyle::Normal()), inter);
+  EXPECT_EQ(created_.size(), 1u);
+  EXPECT_EQ(manager.matchFamilyStyle("No Such Family", FontStyle::Normal()),
+            nullptr);
+
+  auto hebrew = manager.matchFamilyStyleCharacter("Inter", FontStyle::Normal(),
+                                                  nullptr, 0, 0x05D0);
+  ASSERT_NE(hebrew, nullptr);
+  EXPECT_TRUE(LastCreatedContains("Hebrew"));
+  // a character the requested family has stays in the family
+  EXPECT_EQ(manager.matchFamilyStyleCharacter("Inter", FontStyle::Normal(),
+                                              nullptr, 0, 'A'),
+            inter);
+  EXPECT_NE(manager.matchFamilyStyleCharacter(nullptr, FontStyle::Normal(),
+                                              nullptr, 0, 0x4E2D),
+            nullptr);
+  EXPECT_EQ(manager.matchFamilyStyleCharacter(nullptr, FontStyle::Normal(),
+                                              nullptr, 0, 0x10FFFF),
+            nullptr);
+}
+
+TEST_F(LinuxFontManagerTest, IndexIsStored) {
+  const std::string index_path = TempPath("fonts.index");
+  uint32_t face_count = 0;
+  {
+    LinuxFontManager manager({FONT_ROOT}, MakeFactory(), index_path);
+    face_count = manager.GetFaceCount();
+  }
+  auto index = FontFileMapping::Map(index_path);
+  ASSERT_NE(index, nullptr);
+  EXPECT_GT(index->GetSize(), 0u);
+  index = nullptr;
+
+  LinuxFontManager manager({FONT_ROOT}, MakeFactory(), index_path);
+  EXPECT_EQ(manager.GetFaceCount(), face_count);
+  EXPECT_NE(manager.matchFamilyStyle("inter", FontStyle::Bold()), nullptr);
+
+  // a corrupted index is rebuilt
+  auto* file = std::fopen(index_path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  std::fputs("not an index", file);
+  std::fclose(file);
+  LinuxFontManager rebuilt({FONT_ROOT}, MakeFactory(), index_path);
+  EXPECT_EQ(rebuilt.GetFaceCount(), face_count);
+}
+
+TEST_F(LinuxFontManagerTest, BoldPrefersHeavierFace) {
+  const auto index_path = WriteIndex(
+      "weights", {{"face400", FontStyle(FontStyle::kNormal_Weight,
+                                        FontStyle::kNormal_Width,
+                                        FontStyle::kUpright_Slant)},
+                  {"face900", FontStyle(FontStyle::kBlack_Weight,
+                                        FontStyle::kNormal_Width,
+                                        FontStyle::kUpright_Slant)}});
+  LinuxFontManager manager({temp_dir_}, MakeFactory(), index_path);
+  ASSERT_EQ(manager.GetFaceCount(), 2u);
+  // no 700 face: heavier faces come first, then lighter ones
+  EXPECT_NE(manager.matchFamilyStyle("weights", FontStyle::Bold()), nullptr);
+  EXPECT_TRUE(LastCreatedContains("face900"));
+  EXPECT_NE(manager.matchFamilyStyle("weights", FontStyle::Normal()), nullptr);
+  EXPECT_TRUE(LastCreatedContains("face400"));
+}
+
+TEST_F(LinuxFontManagerTest, SlantComesBeforeWeight) {
+  const auto index_path = WriteIndex(
+      "slants", {{"italic400", FontStyle(FontStyle::kNormal_Weight,
+                                         FontStyle::kNormal_Width,
+                                         FontStyle::kItalic_Slant)},
+                 {"upright700", FontStyle(FontStyle::kBold_Weight,
+                                          FontStyle::kNormal_Width,
+                                          FontStyle::kUpright_Slant)}});
+  LinuxFontManager manager({temp_dir_}, MakeFactory(), index_path);
+  ASSERT_EQ(manager.GetFaceCount(), 2u);
+  EXPECT_NE(manager.matchFamilyStyle("slants", FontStyle::Normal()), nullptr);
+  EXPECT_TRUE(LastCreatedContains("upright700"));
+  EXPECT_NE(manager.matchFamilyStyle("slants", FontStyle::Italic()), nullptr);
+  EXPECT_TRUE(LastCreatedContains("italic400"));
+}
+
+TEST_F(LinuxFontManagerTest, ExpandedPrefersExactWidth) {
+  const auto index_path = WriteIndex(
+      "widths", {{"width5", FontStyle(FontStyle::kNormal_Weight,
+                                      FontStyle::kNormal_Width,
+                                      FontStyle::kUpright_Slant)},
+                 {"width7", FontStyle(FontStyle::kNormal_Weight,
+                                      FontStyle::kExpanded_Width,
+                                      FontStyle::kUpright_Slant)},
+                 {"width8", FontStyle(FontStyle::kNormal_Weight,
+                                      FontStyle::kExtraExpanded_Width,
+                                      FontStyle::kUpright_Slant)}});
+  LinuxFontManager manager({temp_dir_}, MakeFactory(), index_path);
+  ASSERT_EQ(manager.GetFaceCount(), 3u);
+  const FontStyle expanded(FontStyle::kNormal_Weight,
+                           FontStyle::kExpanded_Width,
+                           FontStyle::kUpright_Slant);
+  EXPECT_NE(manager.matchFamilyStyle("widths", expanded), nullptr);
+  EXPECT_TRUE(LastCreatedContains("width7"));
+  // no 6 face: wider faces come first, then narrower ones
+  const FontStyle semi_expanded(FontStyle::kNormal_Weight,
+                                FontStyle::kSemiExpanded_Width,
+                                FontStyle::kUpright_Slant);
+  EXPECT_NE(manager.matchFamilyStyle("widths", semi_expanded), nullptr);
+  EXPECT_TRUE(LastCreatedContains("width7"));
+  const FontStyle ultra_expanded(FontStyle::kNormal_Weight,
+                                 FontStyle::kUltraExpanded_Width,
+                                 FontStyle::kUpright_Slant);
+  EXPECT_NE(manager.matchFamilyStyle("widths", ultra_expanded), nullptr);
+  EXPECT_TRUE(LastCreatedContains("width8"));
+}
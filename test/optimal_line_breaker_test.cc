@@ -0,0 +1,148 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/textlayout/internal/optimal_line_breaker.h"
+
+#include <gtest/gtest.h>
+#include <textra/paragraph_style.h>
+#include <textra/text_layout.h>
+#include <textra/tttext_context.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "src/textlayout/utils/u_8_string.h"
+#include "test_utils.h"
+
+using namespace ttoffice::tttext;
+
+namespace {
+constexpr float kFontSize = 16.f;
+
+struct BreakResult {
+  std::unique_ptr<ParagraphImpl> paragraph_;
+  std::unique_ptr<LayoutRegion> region_;
+  double elapsed_ms_ = 0;
+};
+
+std::string ReadCorpus(const std::string& name) {
+  std::string content;
+  auto* file = fopen((std::string(LINEBREAK_DATA_DIR) + name).c_str(), "r");
+  if (file == nullptr) return content;
+  fseek(file, 0, SEEK_END);
+  content.resize(ftell(file));
+  rewind(file);
+  fread(content.data(), 1, content.size(), file);
+  fclose(file);
+  return content;
+}
+
+BreakResult LayoutWithMode(const std::string& text, LineBreakMode mode,
+                           float width) {
+  BreakResult result;
+  result.paragraph_ = std::make_unique<ParagraphImpl>();
+  Style style;
+  style.SetTextSize(kFontSize);
+  result.paragraph_->GetParagraphStyle().SetDefaultStyle(style);
+  result.paragraph_->GetParagraphStyle().SetLineBreakMode(mode);
+  result.paragraph_->AddTextRun(&style, text.c_str());
+  TextLayout layout(TestUtils::getTestShaper());
+  result.region_ = std::make_unique<LayoutRegion>(
+      width, std::numeric_limits<float>::max());
+  TTTextContext context;
+  const auto start = std::chrono::steady_clock::now();
+  layout.LayoutEx(result.paragraph_.get(), result.region_.get(), context);
+  result.elapsed_ms_ = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  return result;
+}
+
+// Sum of squared free space of every line but the last one of each hard
+// break segment. The test shaper gives every character one em of advance.
+double Raggedness(const BreakResult& result, float width) {
+  const auto u32_content = result.paragraph_->GetContent().ToUTF32();
+  double raggedness = 0;
+  for (auto k = 0u; k < result.region_->GetLineCount(); k++) {
+    auto* line = result.region_->GetLine(k);
+    auto end = line->GetEndCharPos();
+    if (end >= u32_content.length() || u32_content[end - 1] == U'\n') continue;
+    while (end > line->GetStartCharPos() &&
+           ttoffice::base::IsSpaceChar(u32_content[end - 1])) {
+      end--;
+    }
+    const double slack = width - (end - line->GetStartCharPos()) * kFontSize;
+    raggedness += slack * slack;
+  }
+  return raggedness;
+}
+}  // namespace
+
+TEST(OptimalLineBreakerTest, SpreadsFreeSpace) {
+  const std::string text = "aaa bb cc ddddd";
+  const float width = 6 * kFontSize;
+  auto greedy = LayoutWithMode(text, LineBreakMode::kGreedy, width);
+  auto optimal = LayoutWithMode(text, LineBreakMode::kOptimal, width);
+  ASSERT_EQ(greedy.region_->GetLineCount(), 3u);
+  ASSERT_EQ(optimal.region_->GetLineCount(), 3u);
+  // greedy: "aaa bb " "cc " "ddddd", optimal: "aaa " "bb cc " "ddddd"
+  EXPECT_EQ(greedy.region_->GetLine(0)->GetEndCharPos(), 7u);
+  EXPECT_EQ(optimal.region_->GetLine(0)->GetEndCharPos(), 4u);
+  EXPECT_EQ(optimal.region_->GetLine(1)->GetEndCharPos(), 10u);
+  EXPECT_LT(Raggedness(optimal, width), Raggedness(greedy, width));
+}
+
+TEST(OptimalLineBreakerTest, BreaksEndAtParagraphEnd) {
+  const std::string text = "one two three\nfour five six seven";
+  auto result = LayoutWithMode(text, LineBreakMode::kOptimal, 8 * kFontSize);
+  const auto& breaks = result.paragraph_->GetOptimalBreaks(8 * kFontSize,
+                                                           8 * kFontSize);
+  ASSERT_FALSE(breaks.empty());
+  EXPECT_EQ(breaks.back(), result.paragraph_->GetCharCount());
+  // the hard break after "three" is always kept
+  EXPECT_NE(std::find(breaks.begin(), breaks.end(), 14u), breaks.end());
+}
+
+TEST(OptimalLineBreakerTest, LaysOutCorpora) {
+  for (const auto* name :
+       {"wiki_c++_en.txt", "wiki_c++_zh.txt", "wiki_c++_fa.txt"}) {
+    const auto text = ReadCorpus(name);
+    ASSERT_FALSE(text.empty()) << name;
+    for (const float width : {240.f, 400.f, 640.f}) {
+      auto greedy = LayoutWithMode(text, LineBreakMode::kGreedy, width);
+      auto optimal = LayoutWithMode(text, LineBreakMode::kOptimal, width);
+      const auto char_count = greedy.paragraph_->GetCharCount();
+      const auto* last_line = optimal.region_->GetLine(
+          optimal.region_->GetLineCount() - 1);
+      EXPECT_EQ(last_line->GetEndCharPos(), char_count) << name;
+      EXPECT_EQ(greedy.region_->GetLine(greedy.region_->GetLineCount() - 1)
+                    ->GetEndCharPos(),
+                char_count)
+          << name;
+    }
+  }
+}
+
+// Compares the time and the raggedness of both break modes, run it with
+// --gtest_also_run_disabled_tests --gtest_filter=*BenchmarkCorpora.
+TEST(OptimalLineBreakerTest, DISABLED_BenchmarkCorpora) {
+  for (const auto* name :
+       {"wiki_c++_en.txt", "wiki_c++_zh.txt", "wiki_c++_fa.txt"}) {
+    const auto text = ReadCorpus(name);
+    ASSERT_FALSE(text.empty()) << name;
+    for (const float width : {240.f, 400.f, 640.f}) {
+      auto greedy = LayoutWithMode(text, LineBreakMode::kGreedy, width);
+      auto optimal = LayoutWithMode(text, LineBreakMode::kOptimal, width);
+      printf("%s width:%.0f greedy: %u lines %.2fms raggedness %.0f | "
+             "optimal: %u lines %.2fms raggedness %.0f\n",
+             name, width, greedy.region_->GetLineCount(), greedy.elapsed_ms_,
+             Raggedness(greedy, width), optimal.region_->GetLineCount(),
+             optimal.elapsed_ms_, Raggedness(optimal, width));
+    }
+  }
+}
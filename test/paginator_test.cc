@@ -0,0 +1,147 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+#include <textra/paginator.h>
+#include <textra/paragraph_style.h>
+#include <textra/text_layout.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "src/textlayout/paragraph_impl.h"
+#include "test_utils.h"
+
+using namespace ttoffice::tttext;
+
+namespace {
+constexpr float kFontSize = 10.f;
+constexpr float kPageWidth = 10 * kFontSize;
+constexpr float kPageHeight = 5 * kFontSize;
+
+// paragraph, start char and end char of every line of a page
+using PageLines = std::vector<std::tuple<Paragraph*, uint32_t, uint32_t>>;
+
+class PaginatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    layout_ = std::make_unique<TextLayout>(TestUtils::getTestShaper());
+    for (auto k = 0; k < 6; k++) {
+      auto paragraph = std::make_unique<ParagraphImpl>();
+      Style style;
+      style.SetTextSize(kFontSize);
+      paragraph->GetParagraphStyle().SetDefaultStyle(style);
+      std::string content;
+      for (auto w = 0; w < 10 + k * 3; w++) content += "word ";
+      paragraph->AddTextRun(&style, content.c_str());
+      paragraphs_.push_back(std::move(paragraph));
+    }
+  }
+  std::unique_ptr<Paginator> CreatePaginator() const {
+    std::vector<Paragraph*> paragraphs;
+    for (auto& paragraph : paragraphs_) paragraphs.push_back(paragraph.get());
+    return std::make_unique<Paginator>(layout_.get(), std::move(paragraphs),
+                                       kPageWidth, kPageHeight);
+  }
+  static PageLines GetPageLines(const LayoutRegion& page) {
+    PageLines lines;
+    for (auto k = 0u; k < page.GetLineCount(); k++) {
+      auto* line = page.GetLine(k);
+      lines.emplace_back(line->GetParagraph(), line->GetStartCharPos(),
+                         line->GetEndCharPos());
+    }
+    return lines;
+  }
+
+  std::unique_ptr<TextLayout> layout_;
+  std::vector<std::unique_ptr<ParagraphImpl>> paragraphs_;
+};
+}  // namespace
+
+TEST_F(PaginatorTest, PagesCoverAllParagraphs) {
+  auto paginator = CreatePaginator();
+  std::vector<PageLines> pages;
+  while (paginator->HasNextPage()) {
+    auto page = paginator->NextPage();
+    ASSERT_NE(page, nullptr);
+    ASSERT_GT(page->GetLineCount(), 0u);
+    pages.push_back(GetPageLines(*page));
+  }
+  EXPECT_EQ(paginator->NextPage(), nullptr);
+  ASSERT_GT(pages.size(), 2u);
+  EXPECT_EQ(paginator->GetPageCheckpoints().size(), pages.size() + 1);
+
+  // every line starts where the previous one ended, across pages
+  auto para_idx = 0u;
+  uint32_t char_pos = 0;
+  for (auto& page : pages) {
+    for (auto& [paragraph, start, end] : page) {
+      if (paragraph != paragraphs_[para_idx].get()) {
+        EXPECT_EQ(char_pos, paragraphs_[para_idx]->GetCharCount());
+        para_idx++;
+        char_pos = 0;
+      }
+      ASSERT_EQ(paragraph, paragraphs_[para_idx].get());
+      EXPECT_EQ(start, char_pos);
+      char_pos = end;
+    }
+  }
+  EXPECT_EQ(para_idx, paragraphs_.size() - 1);
+  EXPECT_EQ(char_pos, paragraphs_.back()->GetCharCount());
+}
+
+TEST_F(PaginatorTest, CheckpointSerialization) {
+  PageCheckpoint checkpoint;
+  checkpoint.paragraph_idx_ = 3;
+  checkpoint.run_idx_ = 1;
+  checkpoint.char_idx_ = 42;
+  checkpoint.paragraph_space_ = 1.5f;
+  checkpoint.line_space_ = -2.25f;
+  auto data = checkpoint.Serialize();
+  PageCheckpoint restored;
+  ASSERT_TRUE(PageCheckpoint::Deserialize(data, &restored));
+  EXPECT_EQ(restored, checkpoint);
+
+  EXPECT_FALSE(PageCheckpoint::Deserialize(data.substr(1), &restored));
+  data[0] = 0;
+  EXPECT_FALSE(PageCheckpoint::Deserialize(data, &restored));
+}
+
+TEST_F(PaginatorTest, RandomAccess) {
+  auto sequential = CreatePaginator();
+  std::vector<PageLines> pages;
+  std::vector<std::string> checkpoints;
+  while (sequential->HasNextPage()) {
+    checkpoints.push_back(sequential->GetCheckpoint().Serialize());
+    pages.push_back(GetPageLines(*sequential->NextPage()));
+  }
+  ASSERT_GT(pages.size(), 3u);
+
+  // forward from the beginning, then back to an already known page
+  auto paginator = CreatePaginator();
+  auto page = paginator->LayoutPage(3);
+  ASSERT_NE(page, nullptr);
+  EXPECT_EQ(GetPageLines(*page), pages[3]);
+  page = paginator->LayoutPage(1);
+  ASSERT_NE(page, nullptr);
+  EXPECT_EQ(GetPageLines(*page), pages[1]);
+  EXPECT_EQ(paginator->GetPageIndex(), 2u);
+  EXPECT_EQ(paginator->LayoutPage(static_cast<uint32_t>(pages.size())),
+            nullptr);
+
+  // resume from a stored checkpoint without the pages before it
+  auto resumed = CreatePaginator();
+  PageCheckpoint checkpoint;
+  ASSERT_TRUE(PageCheckpoint::Deserialize(checkpoints[2], &checkpoint));
+  resumed->SeekTo(checkpoint, 2);
+  for (auto k = 2u; k < pages.size(); k++) {
+    auto next = resumed->NextPage();
+    ASSERT_NE(next, nullptr);
+    EXPECT_EQ(GetPageLines(*next), pages[k]);
+  }
+  EXPECT_FALSE(resumed->HasNextPage());
+}
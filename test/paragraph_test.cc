@@ -5,6 +5,9 @@
 #include <gtest/gtest.h>
 #include <textra/paragraph.h>
 
+#include <string>
+#include <vector>
+
 #include "src/textlayout/run/base_run.h"
 #include "test_utils.h"
 
@@ -45,6 +48,44 @@ TEST(ParagraphTest, AddTextRun_ValidInput) {
   EXPECT_EQ(paragraph->GetContentString(14, 4), "This");
 }
 
+TEST(ParagraphTest, AddTextRuns) {
+  const std::string text = "Hello, \u4e16\u754c! skipped tail";
+  Style bold;
+  bold.SetBold(true);
+  Style large;
+  large.SetTextSize(24);
+  const Style* styles[] = {nullptr, &bold, &large};
+  std::vector<Paragraph::TextSpan> spans = {
+      {0, 5, 1},    // "Hello"
+      {5, 2, 0},    // ", "
+      {7, 6, 2},    // two CJK chars
+      {13, 1, 1},   // "!"
+      {13, 1, 0},   // overlaps the previous span
+      {15, 3, 7},   // no such style
+      {15, 2, 0},   // "sk", the space before it is skipped
+      {30, 10, 0},  // out of the buffer
+  };
+  auto paragraph = Paragraph::Create();
+  paragraph->AddTextRuns(text.data(), static_cast<uint32_t>(text.size()),
+                         spans.data(), static_cast<uint32_t>(spans.size()),
+                         styles, 3);
+  EXPECT_EQ(paragraph->GetRunCount(), 5u);
+  EXPECT_EQ(paragraph->GetCharCount(), 12u);
+  EXPECT_EQ(paragraph->GetContentString(0, 12),
+            "Hello, \u4e16\u754c!sk");
+
+  // a span cutting a character in half is skipped
+  Paragraph::TextSpan half_char = {8, 2, 0};
+  paragraph->AddTextRuns(text.data(), static_cast<uint32_t>(text.size()),
+                         &half_char, 1, styles, 3);
+  EXPECT_EQ(paragraph->GetRunCount(), 5u);
+  // invalid UTF-8 is rejected as a whole
+  const char invalid[] = {'a', static_cast<char>(0xE4), 'b'};
+  Paragraph::TextSpan span = {0, 1, 0};
+  paragraph->AddTextRuns(invalid, 3, &span, 1, styles, 3);
+  EXPECT_EQ(paragraph->GetRunCount(), 5u);
+}
+
 TEST(ParagraphTest, SetParagraphStyle) {
   auto paragraph = Paragraph::Create();
   EXPECT_EQ(paragraph->GetParagraphStyle().GetWriteDirection(),
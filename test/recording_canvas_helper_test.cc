@@ -0,0 +1,61 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <textra/recording_canvas_helper.h>
+
+#include <memory>
+
+#include "mocks.h"
+
+using namespace ttoffice::tttext;
+using namespace ::testing;
+
+TEST(RecordingCanvasHelperTest, RecordAndReplay) {
+  RecordingCanvasHelper recorder;
+  auto painter = recorder.CreatePainter();
+  painter->SetColor(0xFF112233);
+  recorder.Save();
+  recorder.Translate(10, 20);
+  recorder.DrawRect(0, 0, 5, 5, painter.get());
+  recorder.DrawLine(0, 5, 5, 5, painter.get());
+  painter->SetColor(0xFF445566);
+  recorder.DrawRoundRect(0, 0, 5, 5, 2, painter.get());
+  recorder.FillRect(1, 2, 3, 4, 0xFF000000);
+  recorder.DrawImage("image.png", 0, 0, 8, 8, nullptr);
+  recorder.DrawPath(nullptr, painter.get());
+  recorder.Restore();
+  EXPECT_EQ(recorder.GetOpCount(), 8u);
+
+  auto display_list = recorder.FinishRecording();
+  EXPECT_EQ(recorder.GetOpCount(), 0u);
+  ASSERT_EQ(display_list->GetOps().size(), 8u);
+  // painter state is only stored once per distinct paint
+  EXPECT_EQ(display_list->GetPaints().size(), 2u);
+  EXPECT_EQ(display_list->GetOps()[2].paint_idx_,
+            display_list->GetOps()[3].paint_idx_);
+  EXPECT_EQ(display_list->GetOps()[5].paint_idx_, FlatLayoutResult::kNoPaint);
+
+  NiceMock<MockCanvasHelper> canvas_helper;
+  ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+    return std::make_unique<Painter>();
+  }));
+  InSequence sequence;
+  EXPECT_CALL(canvas_helper, Save()).Times(1);
+  EXPECT_CALL(canvas_helper, Translate(10, 20)).Times(1);
+  EXPECT_CALL(canvas_helper,
+              DrawRect(0, 0, 5, 5, Property(&Painter::GetColor, 0xFF112233)))
+      .Times(1);
+  EXPECT_CALL(canvas_helper, DrawLine(0, 5, 5, 5, NotNull())).Times(1);
+  EXPECT_CALL(canvas_helper, DrawRoundRect(0, 0, 5, 5, 2,
+                                           Property(&Painter::GetColor,
+                                                    0xFF445566)))
+      .Times(1);
+  EXPECT_CALL(canvas_helper, FillRect(1, 2, 3, 4, 0xFF000000)).Times(1);
+  EXPECT_CALL(canvas_helper, DrawImage(StrEq("image.png"), 0, 0, 8, 8, _))
+      .Times(1);
+  EXPECT_CALL(canvas_helper, Restore()).Times(1);
+  display_list->Draw(&canvas_helper);
+}
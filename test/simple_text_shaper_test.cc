@@ -0,0 +1,156 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "src/ports/shaper/skshaper/simple_text_shaper.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mocks.h"
+#include "src/textlayout/tt_shaper.h"
+
+using namespace ttoffice::tttext;
+using namespace ::testing;
+
+namespace {
+void AppendU16(std::vector<uint8_t>* data, uint16_t value) {
+  data->push_back(static_cast<uint8_t>(value >> 8));
+  data->push_back(static_cast<uint8_t>(value));
+}
+void AppendU32(std::vector<uint8_t>* data, uint32_t value) {
+  AppendU16(data, static_cast<uint16_t>(value >> 16));
+  AppendU16(data, static_cast<uint16_t>(value));
+}
+void AppendTag(std::vector<uint8_t>* data, const char* tag) {
+  data->insert(data->end(), tag, tag + 4);
+}
+// an sfnt with one GSUB table listing one feature
+std::vector<uint8_t> MakeFontWithGsubFeature(const char* feature) {
+  std::vector<uint8_t> data;
+  AppendU32(&data, 0x00010000);
+  AppendU16(&data, 1);
+  AppendU16(&data, 16);
+  AppendU16(&data, 0);
+  AppendU16(&data, 0);
+  AppendTag(&data, "GSUB");
+  AppendU32(&data, 0);
+  AppendU32(&data, 28);
+  AppendU32(&data, 18);
+  AppendU16(&data, 1);
+  AppendU16(&data, 0);
+  AppendU16(&data, 0);
+  AppendU16(&data, 10);
+  AppendU16(&data, 0);
+  AppendU16(&data, 1);
+  AppendTag(&data, feature);
+  AppendU16(&data, 0);
+  return data;
+}
+}  // namespace
+
+TEST(SimpleTextShaper, IsSimpleCodePoint) {
+  for (Unichar code_point : {U'A', U' ', U'é', U'Ж', U'Ω', U'中', U'あ',
+                             U'가', U'，', U'—'}) {
+    EXPECT_TRUE(SimpleTextShaper::IsSimpleCodePoint(code_point)) << code_point;
+  }
+  // controls, combining marks, format characters, complex scripts and emoji
+  for (Unichar code_point : {0x0A, 0x09, 0xAD, 0x0301, 0x0627, 0x05D0, 0x0915,
+                             0x0E01, 0x200D, 0x202E, 0x3099, 0xFE0F,
+                             0x1F600}) {
+    EXPECT_FALSE(SimpleTextShaper::IsSimpleCodePoint(code_point))
+        << code_point;
+  }
+}
+
+TEST(SimpleTextShaper, ShapesOneGlyphPerChar) {
+  auto typeface = std::make_shared<NiceMock<MockTypefaceHelper>>();
+  ON_CALL(*typeface, UnicharsToGlyphs)
+      .WillByDefault([](const Unichar* unichars, uint32_t count,
+                        GlyphID* glyphs) {
+        for (uint32_t k = 0; k < count; k++) {
+          glyphs[k] = static_cast<GlyphID>(unichars[k]);
+        }
+      });
+  ON_CALL(*typeface, GetHorizontalAdvances)
+      .WillByDefault([](GlyphID glyphs[], uint32_t count, float widths[],
+                        float font_size) {
+        for (uint32_t k = 0; k < count; k++) {
+          widths[k] = font_size * (glyphs[k] == ' ' ? 0.25f : 0.5f);
+        }
+      });
+  SimpleTextShaper shaper;
+  const std::u32string text = U"Hi 中";
+  ShapeResult result(text.size(), false);
+  ASSERT_TRUE(shaper.Shape(text.c_str(), text.size(), typeface, 16, &result));
+  ASSERT_EQ(result.GlyphCount(), text.size());
+  ASSERT_EQ(result.CharCount(), text.size());
+  for (uint32_t k = 0; k < text.size(); k++) {
+    EXPECT_EQ(result.Glyphs(k), static_cast<GlyphID>(text[k]));
+    EXPECT_EQ(result.CharToGlyph(k), k);
+    EXPECT_EQ(result.Font(k), typeface);
+  }
+  EXPECT_FLOAT_EQ(result.Advances(2)[0], 4);
+  EXPECT_FLOAT_EQ(result.MeasureWidth(0, text.size(), 0), 28);
+}
+
+TEST(SimpleTextShaper, LeavesComplexRunsToHarfBuzz) {
+  auto typeface = std::make_shared<NiceMock<MockTypefaceHelper>>();
+  ON_CALL(*typeface, UnicharsToGlyphs)
+      .WillByDefault([](const Unichar* unichars, uint32_t count,
+                        GlyphID* glyphs) {
+        for (uint32_t k = 0; k < count; k++) {
+          glyphs[k] = unichars[k] == U'x' ? 0 : 1;
+        }
+      });
+  SimpleTextShaper shaper;
+  ShapeResult result(4, false);
+  // a combining mark
+  EXPECT_FALSE(shaper.Shape(U"é", 2, typeface, 16, &result));
+  // a char the typeface does not map
+  EXPECT_FALSE(shaper.Shape(U"box", 3, typeface, 16, &result));
+  EXPECT_EQ(result.GlyphCount(), 0u);
+}
+
+TEST(SimpleTextShaper, RejectsTypefacesWithDefaultFeatures) {
+  const auto liga_font = MakeFontWithGsubFeature("liga");
+  NiceMock<MockTypefaceHelper> liga_typeface(1);
+  ON_CALL(liga_typeface, GetFontData).WillByDefault(Return(liga_font.data()));
+  ON_CALL(liga_typeface, GetFontDataSize)
+      .WillByDefault(Return(liga_font.size()));
+
+  const auto smcp_font = MakeFontWithGsubFeature("smcp");
+  NiceMock<MockTypefaceHelper> smcp_typeface(2);
+  ON_CALL(smcp_typeface, GetFontData).WillByDefault(Return(smcp_font.data()));
+  ON_CALL(smcp_typeface, GetFontDataSize)
+      .WillByDefault(Return(smcp_font.size()));
+
+  // localized forms depend on the language, alternates of variable fonts on
+  // the variation coordinates
+  const auto locl_font = MakeFontWithGsubFeature("locl");
+  NiceMock<MockTypefaceHelper> locl_typeface(3);
+  ON_CALL(locl_typeface, GetFontData).WillByDefault(Return(locl_font.data()));
+  ON_CALL(locl_typeface, GetFontDataSize)
+      .WillByDefault(Return(locl_font.size()));
+
+  const auto rvrn_font = MakeFontWithGsubFeature("rvrn");
+  NiceMock<MockTypefaceHelper> rvrn_typeface(4);
+  ON_CALL(rvrn_typeface, GetFontData).WillByDefault(Return(rvrn_font.data()));
+  ON_CALL(rvrn_typeface, GetFontDataSize)
+      .WillByDefault(Return(rvrn_font.size()));
+
+  SimpleTextShaper shaper;
+  EXPECT_FALSE(shaper.IsSimpleTypeface(liga_typeface));
+  EXPECT_FALSE(shaper.IsSimpleTypeface(locl_typeface));
+  EXPECT_FALSE(shaper.IsSimpleTypeface(rvrn_typeface));
+  // small caps are not enabled by default
+  EXPECT_TRUE(shaper.IsSimpleTypeface(smcp_typeface));
+
+  // the answer is cached by unique id
+  EXPECT_CALL(liga_typeface, GetFontData).Times(0);
+  EXPECT_FALSE(shaper.IsSimpleTypeface(liga_typeface));
+}
@@ -0,0 +1,235 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+#include <textra/fontmgr_collection.h>
+#include <textra/i_font_manager.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/ports/shaper/skshaper/sk_shaper.h"
+#include "test_utils.h"
+
+using namespace ttoffice::tttext;
+
+namespace {
+uint32_t ReadU32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+         (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+// offset of the table directory of face index, size if there is none
+size_t FaceOffset(const std::vector<uint8_t>& data, int index) {
+  if (data.size() < 12) return data.size();
+  if (ReadU32(data.data()) != 0x74746366) return 0;  // 'ttcf'
+  const size_t entry = 12 + static_cast<size_t>(index) * 4;
+  return entry + 4 <= data.size() ? ReadU32(data.data() + entry) : data.size();
+}
+
+/**
+ * A copy of the font of source whose table directories are salted, harfbuzz
+ * does not check table checksums, so the copy shapes like source while the
+ * faces cached by other tests for the same font are not shared with it.
+ */
+std::shared_ptr<const std::vector<uint8_t>> CopyFontData(
+    const TypefaceRef& source, uint32_t salt) {
+  const auto* begin = static_cast<const uint8_t*>(source->GetFontData());
+  auto data = std::make_shared<std::vector<uint8_t>>(
+      begin, begin + source->GetFontDataSize());
+  const uint32_t face_count =
+      data->size() >= 12 && ReadU32(data->data()) == 0x74746366
+          ? ReadU32(data->data() + 8)
+          : 1;
+  for (auto k = 0u; k < face_count; k++) {
+    const size_t record = FaceOffset(*data, static_cast<int>(k)) + 12;
+    if (record + 8 > data->size()) continue;
+    // the checksum of the first table
+    std::memcpy(data->data() + record + 4, &salt, sizeof(salt));
+  }
+  return data;
+}
+
+/**
+ * Serves font data from memory like most typefaces, or only table by table
+ * like a typeface whose font file is not loaded. Glyphs and metrics come from
+ * source.
+ */
+class FontDataTypeface : public ITypefaceHelper {
+ public:
+  FontDataTypeface(TypefaceRef source,
+                   std::shared_ptr<const std::vector<uint8_t>> data,
+                   uint32_t unique_id, int index, bool in_memory)
+      : ITypefaceHelper(unique_id),
+        source_(std::move(source)),
+        data_(std::move(data)),
+        index_(index),
+        in_memory_(in_memory) {}
+
+  float GetHorizontalAdvance(GlyphID glyph_id,
+                             float font_size) const override {
+    return source_->GetHorizontalAdvance(glyph_id, font_size);
+  }
+  void GetHorizontalAdvances(GlyphID glyph_ids[], uint32_t count,
+                             float widths[], float font_size) const override {
+    source_->GetHorizontalAdvances(glyph_ids, count, widths, font_size);
+  }
+  void GetWidthBound(float* rect_ltwh, GlyphID glyph_id,
+                     float font_size) const override {
+    source_->GetWidthBound(rect_ltwh, glyph_id, font_size);
+  }
+  void GetWidthBounds(float* rect_ltrb, GlyphID glyphs[], uint32_t glyph_count,
+                      float font_size) override {
+    source_->GetWidthBounds(rect_ltrb, glyphs, glyph_count, font_size);
+  }
+  const void* GetFontData() const override {
+    return in_memory_ ? data_->data() : nullptr;
+  }
+  size_t GetFontDataSize() const override {
+    return in_memory_ ? data_->size() : 0;
+  }
+  int GetFontIndex() const override { return index_; }
+  size_t GetTableData(uint32_t tag, size_t offset, size_t length,
+                      void* data) const override {
+    table_reads_++;
+    const size_t face_offset = FaceOffset(*data_, index_);
+    if (face_offset + 12 > data_->size()) return 0;
+    const auto* font = data_->data();
+    const size_t num_tables =
+        (font[face_offset + 4] << 8) | font[face_offset + 5];
+    for (auto k = 0u; k < num_tables; k++) {
+      const size_t record = face_offset + 12 + k * 16;
+      if (record + 16 > data_->size()) return 0;
+      if (ReadU32(font + record) != tag) continue;
+      const size_t table_offset = ReadU32(font + record + 8);
+      const size_t table_length = ReadU32(font + record + 12);
+      if (table_offset + table_length > data_->size()) return 0;
+      if (data == nullptr) return table_length;
+      if (offset >= table_length) return 0;
+      const size_t copied = std::min(length, table_length - offset);
+      std::memcpy(data, font + table_offset + offset, copied);
+      return copied;
+    }
+    return 0;
+  }
+  uint16_t UnicharToGlyph(Unichar codepoint,
+                          uint32_t variation_selector) const override {
+    return source_->UnicharToGlyph(codepoint, variation_selector);
+  }
+  void UnicharsToGlyphs(const Unichar* unichars, uint32_t count,
+                        GlyphID* glyphs) const override {
+    source_->UnicharsToGlyphs(unichars, count, glyphs);
+  }
+  uint32_t GetUnitsPerEm() const override { return source_->GetUnitsPerEm(); }
+  uint32_t GetTableReadCount() const { return table_reads_; }
+
+ protected:
+  void OnCreateFontInfo(FontInfo* info, float font_size) const override {
+    *info = source_->GetFontInfo(font_size);
+  }
+
+ private:
+  TypefaceRef source_;
+  std::shared_ptr<const std::vector<uint8_t>> data_;
+  int index_;
+  bool in_memory_;
+  mutable uint32_t table_reads_ = 0;
+};
+
+class GlyphCollector : public SkShaper::RunHandler {
+ public:
+  void beginLine() override {}
+  void runInfo(const RunInfo&) override {}
+  void commitRunInfo() override {}
+  Buffer runBuffer(const RunInfo& info) override {
+    const auto start = glyphs_.size();
+    glyphs_.resize(start + info.glyphCount);
+    advances_.resize(start + info.glyphCount);
+    return {glyphs_.data() + start, advances_.data() + start, nullptr};
+  }
+  void commitRunBuffer(const RunInfo&) override {}
+  void commitLine() override {}
+
+  std::vector<GlyphID> glyphs_;
+  std::vector<float> advances_;
+};
+
+std::vector<GlyphID> ShapeWithHarfBuzz(const TypefaceRef& typeface,
+                                       const std::u32string& text, bool rtl) {
+  auto shaper = SkShaper::MakeShapeDontWrapOrReorderForHB();
+  SkShaper::TrivialFontRunIterator font(Font(typeface, 16.f), text.length());
+  GlyphCollector collector;
+  shaper->shape(text.c_str(), text.length(), &font, !rtl, FLT_MAX,
+                &collector);
+  return collector.glyphs_;
+}
+
+TypefaceRef MatchTestFont(const char* family) {
+  return TestUtils::getFontmgrCollection()
+      .GetDefaultFontManager()
+      ->matchFamilyStyle(family, FontStyle::Normal());
+}
+}  // namespace
+
+// A cached HBFace keeps the typeface which created it alive, the use count of
+// a typeface tells whether shaping with it created a face.
+TEST(SkShaperHarfBuzz, FacesAreSharedByFontData) {
+  auto source = MatchTestFont("Inter");
+  ASSERT_NE(source, nullptr);
+  const std::u32string text = U"Hello";
+  // equal copies, the face is keyed on the content and not on the address
+  TypefaceRef first = std::make_shared<FontDataTypeface>(
+      source, CopyFontData(source, 0x49001), 0x49001, 0, true);
+  TypefaceRef second = std::make_shared<FontDataTypeface>(
+      source, CopyFontData(source, 0x49001), 0x49002, 0, true);
+  const auto first_glyphs = ShapeWithHarfBuzz(first, text, false);
+  EXPECT_EQ(first_glyphs.size(), text.length());
+  EXPECT_EQ(first.use_count(), 2);
+  EXPECT_EQ(ShapeWithHarfBuzz(second, text, false), first_glyphs);
+  EXPECT_EQ(second.use_count(), 1);
+}
+
+TEST(SkShaperHarfBuzz, CollectionFacesAreNotShared) {
+  auto source = MatchTestFont("NotoSansCJK");
+  ASSERT_NE(source, nullptr);
+  const auto data = CopyFontData(source, 0x49003);
+  ASSERT_GE(data->size(), 12u);
+  ASSERT_EQ(ReadU32(data->data()), 0x74746366u);
+  ASSERT_GE(ReadU32(data->data() + 8), 2u);
+  TypefaceRef first = std::make_shared<FontDataTypeface>(source, data, 0x49003,
+                                                         0, true);
+  TypefaceRef second = std::make_shared<FontDataTypeface>(source, data,
+                                                          0x49004, 1, true);
+  EXPECT_FALSE(ShapeWithHarfBuzz(first, U"中文", false).empty());
+  EXPECT_FALSE(ShapeWithHarfBuzz(second, U"中文", false).empty());
+  EXPECT_EQ(first.use_count(), 2);
+  EXPECT_EQ(second.use_count(), 2);
+}
+
+TEST(SkShaperHarfBuzz, TablesAreLoadedWithoutFontData) {
+  auto source = MatchTestFont("NotoKufiArabic");
+  ASSERT_NE(source, nullptr);
+  const auto data = CopyFontData(source, 0x49005);
+  const std::u32string text = U"سلام";
+  TypefaceRef in_memory = std::make_shared<FontDataTypeface>(
+      source, data, 0x49005, 0, true);
+  auto by_table = std::make_shared<FontDataTypeface>(source, data, 0x49006, 0,
+                                                     false);
+  const auto expected = ShapeWithHarfBuzz(in_memory, text, true);
+  const auto glyphs = ShapeWithHarfBuzz(by_table, text, true);
+  EXPECT_GT(by_table->GetTableReadCount(), 0u);
+  EXPECT_EQ(glyphs, expected);
+  // the joining forms come from GSUB, the nominal glyphs would be used if the
+  // tables were not loaded
+  std::vector<GlyphID> nominal;
+  for (auto iter = text.rbegin(); iter != text.rend(); ++iter) {
+    nominal.push_back(source->UnicharToGlyph(*iter, 0));
+  }
+  EXPECT_NE(glyphs, nominal);
+}
@@ -0,0 +1,49 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gtest/gtest.h>
+#include <textra/platform/skity/skity_shadow_cache.h>
+
+using namespace ttoffice::tttext;
+
+namespace {
+SkityShadowCache::Entry MakeEntry(size_t bytes) {
+  SkityShadowCache::Entry entry;
+  entry.bounds_ = skity::Rect::MakeLTRB(0, 0, 1, 1);
+  entry.bytes_ = bytes;
+  return entry;
+}
+}  // namespace
+
+TEST(SkityShadowCacheTest, FindAndInsert) {
+  SkityShadowCache cache(100);
+  EXPECT_EQ(cache.Find("a"), nullptr);
+  EXPECT_NE(cache.Insert("a", MakeEntry(40)), nullptr);
+  ASSERT_NE(cache.Find("a"), nullptr);
+  EXPECT_EQ(cache.Find("a")->bytes_, 40u);
+  // replacing an entry does not count its pixels twice
+  cache.Insert("a", MakeEntry(50));
+  EXPECT_EQ(cache.GetUsedBytes(), 50u);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+}
+
+TEST(SkityShadowCacheTest, EvictsLeastRecentlyUsed) {
+  SkityShadowCache cache(100);
+  cache.Insert("a", MakeEntry(40));
+  cache.Insert("b", MakeEntry(40));
+  // a becomes the most recently used entry, b goes first
+  EXPECT_NE(cache.Find("a"), nullptr);
+  cache.Insert("c", MakeEntry(40));
+  EXPECT_NE(cache.Find("a"), nullptr);
+  EXPECT_EQ(cache.Find("b"), nullptr);
+  EXPECT_NE(cache.Find("c"), nullptr);
+  EXPECT_EQ(cache.GetUsedBytes(), 80u);
+
+  cache.SetBudgetBytes(40);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+  EXPECT_NE(cache.Find("c"), nullptr);
+  // an entry larger than the budget is not kept
+  EXPECT_EQ(cache.Insert("d", MakeEntry(41)), nullptr);
+  EXPECT_EQ(cache.GetUsedBytes(), 0u);
+}
@@ -210,6 +210,21 @@ TEST(AttributesRangeListTest, SetRangeValue) {
   range_list.Clear();
 }
 
+TEST(AttributesRangeListTest, AppendRangeValue) {
+  AttributesRangeList range_list;
+  range_list.AppendRangeValue(Range{0, 2}, 3);
+  range_list.AppendRangeValue(Range{2, 4}, 3);
+  range_list.AppendRangeValue(Range{5, 6}, 4);
+  EXPECT_EQ(range_list.GetAttributeRange(1).first, (Range{0, 4}));
+  EXPECT_EQ(range_list.GetAttrValue(4), AttributesRangeList::Undefined());
+  EXPECT_EQ(range_list.GetAttrValue(5), 4u);
+  // a range which does not start after the list falls back to SetRangeValue
+  range_list.AppendRangeValue(Range{3, 6}, 5);
+  EXPECT_EQ(range_list.GetAttrValue(2), 3u);
+  EXPECT_EQ(range_list.GetAttrValue(3), 5u);
+  EXPECT_EQ(range_list.GetAttrValue(5), 5u);
+}
+
 TEST(StyleManager, CopyConstructor) {
   StyleManager original;
   TTColor color(TTColor::BLUE());
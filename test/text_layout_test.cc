@@ -3,6 +3,8 @@
 // LICENSE file in the root directory of this source tree.
 
 #include <gtest/gtest.h>
+#include <textra/i_hyphenator.h>
+#include <textra/layout_drawer.h>
 #include <textra/paragraph_style.h>
 #include <textra/text_layout.h>
 #include <textra/tttext_context.h>
@@ -13,15 +15,39 @@
 
 #include "mocks.h"
 #include "src/textlayout/style_attributes.h"
+#include "src/textlayout/text_line_impl.h"
 #include "test_utils.h"
 
 using namespace ::testing;
 
 namespace ttoffice {
 namespace tttext {
+// Resolves uppercase letters as rtl and lowercase letters as ltr, other chars
+// take the level of the char before them.
+class PseudoBidiMockShaper : public MockTTShaper {
+ public:
+  using MockTTShaper::MockTTShaper;
+  void ProcessBidirection(const char32_t* text, uint32_t length,
+                          WriteDirection write_direction, uint32_t* visual_map,
+                          uint32_t* logical_map, uint8_t* dir_vec) override {
+    const uint8_t para_level = write_direction == WriteDirection::kRTL ? 1 : 0;
+    for (auto k = 0u; k < length; k++) {
+      visual_map[k] = logical_map[k] = k;
+      if (text[k] >= U'A' && text[k] <= U'Z') {
+        dir_vec[k] = 1;
+      } else if (text[k] >= U'a' && text[k] <= U'z') {
+        dir_vec[k] = para_level == 1 ? 2 : 0;
+      } else {
+        dir_vec[k] = k > 0 ? dir_vec[k - 1] : para_level;
+      }
+    }
+  }
+};
+
 class TextLayoutTest : public ::testing::Test {
  public:
-  std::unique_ptr<MockTTShaper> GetFixedSizeMockShaper() {
+  template <typename Shaper = MockTTShaper>
+  std::unique_ptr<Shaper> GetFixedSizeMockShaper() {
     // FontInfo always returns -0.75 ascent and 0.25 descent, multiplied by
     // font_size
     auto mock_typeface = std::make_shared<NiceMock<MockTypefaceHelper>>();
@@ -32,7 +58,7 @@ class TextLayoutTest : public ::testing::Test {
 
     auto test_fontmgr = std::make_shared<TestFontMgr>(
         std::vector<std::shared_ptr<ITypefaceHelper>>{mock_typeface});
-    auto mock_shaper = std::make_unique<NiceMock<MockTTShaper>>(
+    auto mock_shaper = std::make_unique<NiceMock<Shaper>>(
         FontmgrCollection{test_fontmgr});
     ON_CALL(*mock_shaper, OnShapeText(_, _))
         .WillByDefault(
@@ -645,5 +671,483 @@ TEST_F(TextLayoutTest, ParagraphStyle_OverflowWrap) {
     }
   }
 }
+
+TEST_F(TextLayoutTest, ParagraphStyle_Hyphenator) {
+  // Allows a hyphen every two characters, keeping two characters at each side
+  class EvenHyphenator : public IHyphenator {
+   public:
+    void Hyphenate(const char32_t*, uint32_t length,
+                   bool* breaks) const override {
+      for (auto k = 2u; k + 2 <= length; k += 2) breaks[k] = true;
+    }
+  };
+  const char* content = "ab hyphenation";
+  const float page_width = 8.0f;
+
+  auto layout_helper = [this, content](
+                           std::shared_ptr<IHyphenator> hyphenator,
+                           float width = 8.0f,
+                           ParagraphHorizontalAlignment align =
+                               ParagraphHorizontalAlignment::kLeft) {
+    auto para = std::make_unique<ParagraphImpl>();
+    Style style;
+    style.SetTextSize(1.f);
+    ParagraphStyle para_style;
+    para_style.SetDefaultStyle(style);
+    para_style.SetHyphenator(std::move(hyphenator));
+    para_style.SetHorizontalAlign(align);
+    para->SetParagraphStyle(&para_style);
+    para->AddTextRun(nullptr, content);
+
+    TTTextContext context;
+    TextLayout layout(GetFixedSizeMockShaper());
+    auto region = std::make_unique<LayoutRegion>(width, 20.f);
+    layout.Layout(para.get(), region.get(), context);
+    return std::make_pair(std::move(para), std::move(region));
+  };
+
+  {
+    // Without hyphenator the long word moves to the next line
+    auto [_, region] = layout_helper(nullptr);
+    ASSERT_GT(region->GetLineCount(), 1u);
+    EXPECT_EQ(region->GetLine(0)->GetEndCharPos(), 3u);
+  }
+
+  {
+    // "ab hyph-" fits in the first line, "enation" goes to the second one
+    auto [_, region] = layout_helper(std::make_shared<EvenHyphenator>());
+    ASSERT_EQ(region->GetLineCount(), 2u);
+    auto* first_line = static_cast<TextLineImpl*>(region->GetLine(0));
+    EXPECT_EQ(first_line->GetEndCharPos(), 7u);
+    EXPECT_TRUE(first_line->EndsWithHyphen());
+    EXPECT_LE(first_line->GetLineRight(), page_width);
+    auto* last_line = static_cast<TextLineImpl*>(region->GetLine(1));
+    EXPECT_EQ(last_line->GetStartCharPos(), 7u);
+    EXPECT_FALSE(last_line->EndsWithHyphen());
+  }
+
+  {
+    // Justified, the free space goes between the words, not before the hyphen
+    const float justify_width = 9.0f;
+    auto [_, region] =
+        layout_helper(std::make_shared<EvenHyphenator>(), justify_width,
+                      ParagraphHorizontalAlignment::kJustify);
+    ASSERT_EQ(region->GetLineCount(), 2u);
+    auto* first_line = region->GetLine(0);
+    EXPECT_EQ(first_line->GetEndCharPos(), 7u);
+    float rect[4];
+    first_line->GetCharBoundingRect(rect, 6);
+    EXPECT_FLOAT_EQ(rect[0] + rect[2], justify_width - 1.f);
+    EXPECT_FLOAT_EQ(first_line->GetLineRight(), justify_width);
+  }
+}
+
+TEST_F(TextLayoutTest, LayoutAroundExclusions) {
+  auto layout_helper = [this](float exclusion_width) {
+    auto para = std::make_unique<ParagraphImpl>();
+    Style style;
+    style.SetTextSize(1.f);
+    ParagraphStyle para_style;
+    para_style.SetDefaultStyle(style);
+    para->SetParagraphStyle(&para_style);
+    para->AddTextRun(nullptr, "ab cd");
+
+    TTTextContext context;
+    TextLayout layout(GetFixedSizeMockShaper());
+    auto region = std::make_unique<LayoutRegion>(10.f, 20.f);
+    region->AddExclusionRect(0.f, 0.f, exclusion_width, 3.f);
+    layout.Layout(para.get(), region.get(), context);
+    return std::make_pair(std::move(para), std::move(region));
+  };
+
+  {
+    // The line flows on the right of the exclusion
+    auto [_, region] = layout_helper(4.f);
+    ASSERT_EQ(region->GetLineCount(), 1u);
+    EXPECT_FLOAT_EQ(region->GetLine(0)->GetLineTop(), 0.f);
+    EXPECT_FLOAT_EQ(region->GetLine(0)->GetLineLeft(), 4.f);
+  }
+
+  {
+    // No room next to the exclusion, the line moves right below it
+    auto [_, region] = layout_helper(10.f);
+    ASSERT_EQ(region->GetLineCount(), 1u);
+    EXPECT_FLOAT_EQ(region->GetLine(0)->GetLineTop(), 3.f);
+    EXPECT_FLOAT_EQ(region->GetLine(0)->GetLineLeft(), 0.f);
+  }
+}
+
+TEST_F(TextLayoutTest, FloatRunExcludesFollowingLines) {
+  auto para = std::make_unique<ParagraphImpl>();
+  Style style;
+  style.SetTextSize(1.f);
+  ParagraphStyle para_style;
+  para_style.SetDefaultStyle(style);
+  para->SetParagraphStyle(&para_style);
+  // a 3x2 float ahead of the text
+  auto float_shape = std::make_shared<TestShape>(3.f, 2.f);
+  para->AddShapeRun(style, float_shape, true, true);
+  para->AddTextRun(nullptr, "aaaa bbbb cccc dddd");
+
+  TextLayout layout(GetFixedSizeMockShaper());
+  auto region = std::make_unique<LayoutRegion>(10.f, 20.f);
+  auto layout_and_check = [&]() {
+    TTTextContext context;
+    layout.Layout(para.get(), region.get(), context);
+    EXPECT_FLOAT_EQ(float_shape->GetXOffset(), 0.f);
+    EXPECT_FLOAT_EQ(float_shape->GetYOffset(), 0.f);
+    ASSERT_EQ(region->GetLineCount(), 3u);
+    // the two lines next to the float are 7 wide and start on its right
+    auto char_x = [&region](uint32_t line_idx, uint32_t char_pos) {
+      float rect[4];
+      region->GetLine(line_idx)->GetCharBoundingRect(rect, char_pos);
+      return rect[0];
+    };
+    EXPECT_EQ(region->GetLine(0)->GetEndCharPos(), 6u);
+    EXPECT_FLOAT_EQ(char_x(0, 1), 3.f);
+    EXPECT_EQ(region->GetLine(1)->GetEndCharPos(), 11u);
+    EXPECT_FLOAT_EQ(char_x(1, 6), 3.f);
+    // the line below it gets the full width back
+    EXPECT_EQ(region->GetLine(2)->GetEndCharPos(), 20u);
+    EXPECT_FLOAT_EQ(char_x(2, 11), 0.f);
+  };
+  layout_and_check();
+
+  // the float placed by the first layout does not push itself aside
+  region->Reset();
+  layout_and_check();
+}
+
+TEST_F(TextLayoutTest, MeasureOnlyLayout) {
+  auto layout_helper = [this](ParagraphHorizontalAlignment align,
+                              bool measure_only) {
+    auto para = std::make_unique<ParagraphImpl>();
+    Style style;
+    style.SetTextSize(1.f);
+    ParagraphStyle para_style;
+    para_style.SetDefaultStyle(style);
+    para_style.SetHorizontalAlign(align);
+    para->SetParagraphStyle(&para_style);
+    para->AddTextRun(nullptr, "ab cd efg h ijklmn");
+
+    TTTextContext context;
+    context.SetMeasureOnly(measure_only);
+    TextLayout layout(GetFixedSizeMockShaper());
+    auto region = std::make_unique<LayoutRegion>(7.f, 20.f);
+    layout.Layout(para.get(), region.get(), context);
+    return std::make_pair(std::move(para), std::move(region));
+  };
+
+  for (auto align :
+       {ParagraphHorizontalAlignment::kLeft,
+        ParagraphHorizontalAlignment::kCenter,
+        ParagraphHorizontalAlignment::kRight,
+        ParagraphHorizontalAlignment::kJustify}) {
+    auto [para, region] = layout_helper(align, false);
+    auto [measured_para, measured_region] = layout_helper(align, true);
+    ASSERT_EQ(measured_region->GetLineCount(), region->GetLineCount());
+    EXPECT_FLOAT_EQ(measured_region->GetLayoutedWidth(),
+                    region->GetLayoutedWidth());
+    EXPECT_FLOAT_EQ(measured_region->GetLayoutedHeight(),
+                    region->GetLayoutedHeight());
+    for (auto k = 0u; k < region->GetLineCount(); k++) {
+      auto* line = region->GetLine(k);
+      auto* measured_line = measured_region->GetLine(k);
+      EXPECT_EQ(measured_line->GetEndCharPos(), line->GetEndCharPos());
+      EXPECT_FLOAT_EQ(measured_line->GetLineLeft(), line->GetLineLeft());
+      EXPECT_FLOAT_EQ(measured_line->GetLineRight(), line->GetLineRight());
+      // hit testing builds the skipped drawer pieces
+      float rect[4];
+      float measured_rect[4];
+      line->GetBoundingRectForLine(rect);
+      measured_line->GetBoundingRectForLine(measured_rect);
+      for (auto i = 0u; i < 4; i++) {
+        EXPECT_FLOAT_EQ(measured_rect[i], rect[i]);
+      }
+    }
+  }
+}
+
+TEST_F(TextLayoutTest, IntrinsicWidths) {
+  auto para = std::make_unique<ParagraphImpl>();
+  Style style;
+  style.SetTextSize(1.f);
+  ParagraphStyle para_style;
+  para_style.SetDefaultStyle(style);
+  para->SetParagraphStyle(&para_style);
+  para->AddTextRun(nullptr, "ab cdef  g\nhijklmnop");
+  EXPECT_FLOAT_EQ(para->GetMinIntrinsicWidth(), 0.f);
+  EXPECT_FLOAT_EQ(para->GetMaxIntrinsicWidth(), 0.f);
+
+  TTTextContext context;
+  TextLayout layout(GetFixedSizeMockShaper());
+  LayoutRegion region(100.f, 100.f);
+  layout.Layout(para.get(), &region, context);
+  // the widest word
+  EXPECT_FLOAT_EQ(para->GetMinIntrinsicWidth(), 9.f);
+  // the widest hard-break segment, with its spaces
+  EXPECT_FLOAT_EQ(para->GetMaxIntrinsicWidth(), 10.f);
+}
+
+TEST_F(TextLayoutTest, MeasureForWidth) {
+  auto para = std::make_unique<ParagraphImpl>();
+  Style style;
+  style.SetTextSize(1.f);
+  ParagraphStyle para_style;
+  para_style.SetDefaultStyle(style);
+  para->SetParagraphStyle(&para_style);
+  para->AddTextRun(nullptr, "ab cd efg h ijklmn");
+  TextLayout layout(GetFixedSizeMockShaper());
+
+  for (const float width : {7.f, 12.f, 7.f}) {
+    TTTextContext context;
+    LayoutRegion region(width, 100.f);
+    layout.Layout(para.get(), &region, context);
+    const auto size = layout.MeasureForWidth(para.get(), width);
+    EXPECT_FLOAT_EQ(size.first, region.GetLayoutedWidth());
+    EXPECT_FLOAT_EQ(size.second, region.GetLayoutedHeight());
+    // memoized result
+    EXPECT_EQ(layout.MeasureForWidth(para.get(), width), size);
+  }
+
+  // layout and draw in between keep the memoized sizes
+  const auto size = layout.MeasureForWidth(para.get(), 7.f);
+  {
+    TTTextContext context;
+    LayoutRegion region(7.f, 100.f);
+    layout.Layout(para.get(), &region, context);
+    NiceMock<MockCanvasHelper> canvas_helper;
+    ON_CALL(canvas_helper, CreatePainter()).WillByDefault(Invoke([]() {
+      return std::make_unique<Painter>();
+    }));
+    LayoutDrawer drawer(&canvas_helper);
+    drawer.DrawLayoutPage(&region);
+  }
+  std::pair<float, float> memoized;
+  ASSERT_TRUE(para->FindMeasuredSize(7.f, &memoized));
+  EXPECT_EQ(memoized, size);
+
+  // changing the style through GetParagraphStyle() drops the memoized sizes
+  para->GetParagraphStyle().SetMaxLines(1);
+  const auto one_line_size = layout.MeasureForWidth(para.get(), 7.f);
+  EXPECT_LT(one_line_size.second, size.second);
+  para->GetParagraphStyle().SetMaxLines(100);
+  EXPECT_EQ(layout.MeasureForWidth(para.get(), 7.f), size);
+  para->GetParagraphStyle().SetLineHeightInPxExact(3.f);
+  const auto tall_size = layout.MeasureForWidth(para.get(), 7.f);
+  EXPECT_FLOAT_EQ(tall_size.second, size.second * 3);
+}
+TEST_F(TextLayoutTest, InkBoundingRect) {
+  auto mock_typeface = std::make_shared<NiceMock<MockTypefaceHelper>>();
+  ON_CALL(*mock_typeface, OnCreateFontInfo(_, _))
+      .WillByDefault(Invoke([](FontInfo* info, float font_size) {
+        *info = FontInfo(-0.75 * font_size, 0.25 * font_size, font_size);
+      }));
+  ON_CALL(*mock_typeface, GetHorizontalAdvances(_, _, _, _))
+      .WillByDefault(Invoke([](GlyphID glyph_ids[], uint32_t count,
+                               float widths[], float font_size) {
+        for (auto k = 0u; k < count; k++) widths[k] = font_size;
+      }));
+  // glyph 1 has no ink, the others reach below the baseline
+  ON_CALL(*mock_typeface, GetWidthBound(_, _, _))
+      .WillByDefault(
+          Invoke([](float* rect_ltwh, GlyphID glyph_id, float font_size) {
+            if (glyph_id == 1) return;
+            rect_ltwh[0] = 0.1f * font_size;
+            rect_ltwh[1] = -0.5f * font_size;
+            rect_ltwh[2] = 0.8f * font_size;
+            rect_ltwh[3] = 0.6f * font_size;
+          }));
+  auto test_fontmgr = std::make_shared<TestFontMgr>(
+      std::vector<std::shared_ptr<ITypefaceHelper>>{mock_typeface});
+  auto shaper = std::make_unique<NiceMock<MockTTShaper>>(
+      FontmgrCollection{test_fontmgr});
+  ON_CALL(*shaper, OnShapeText(_, _))
+      .WillByDefault(
+          Invoke([mock_typeface](const ShapeKey& key, ShapeResult* result) {
+            const size_t char_count = key.text_.size();
+            TestShapingResultReader reader(char_count);
+            for (size_t i = 0; i < char_count; ++i) {
+              reader.glyphs_[i] = i;
+              const float font_size = key.style_.GetFontSize();
+              reader.advances_[i] = {font_size, font_size};
+            }
+            reader.font_ = mock_typeface;
+            result->AppendPlatformShapingResult(reader);
+          }));
+  TextLayout layout(std::move(shaper));
+
+  for (auto align : {ParagraphHorizontalAlignment::kLeft,
+                     ParagraphHorizontalAlignment::kRight}) {
+    auto para = std::make_unique<ParagraphImpl>();
+    Style style;
+    style.SetTextSize(2.f);
+    ParagraphStyle para_style;
+    para_style.SetDefaultStyle(style);
+    para_style.SetHorizontalAlign(align);
+    para->SetParagraphStyle(&para_style);
+    para->AddTextRun(nullptr, "abc");
+    TTTextContext context;
+    LayoutRegion region(100.f, 100.f);
+    layout.Layout(para.get(), &region, context);
+    ASSERT_EQ(region.GetLineCount(), 1u);
+
+    float rect[4];
+    region.GetLine(0)->GetInkBoundingRect(rect);
+    // the ink of the first and the last glyph, around the baseline at 1.5
+    const float left =
+        align == ParagraphHorizontalAlignment::kLeft ? 0.2f : 94.2f;
+    EXPECT_NEAR(rect[0], left, 1e-4);
+    EXPECT_NEAR(rect[1], 0.5f, 1e-4);
+    EXPECT_NEAR(rect[2], 5.6f, 1e-4);
+    EXPECT_NEAR(rect[3], 1.2f, 1e-4);
+  }
+}
+
+TEST_F(TextLayoutTest, VirtualizedRegion) {
+  auto para = std::make_unique<ParagraphImpl>();
+  Style style;
+  style.SetTextSize(1.f);
+  ParagraphStyle para_style;
+  para_style.SetDefaultStyle(style);
+  para_style.SetHorizontalAlign(ParagraphHorizontalAlignment::kJustify);
+  para->SetParagraphStyle(&para_style);
+  para->AddTextRun(nullptr,
+                   "ab cd efg h ijklmn op qrs tu vwx yz ab cd efg h ijklmn op "
+                   "qrs tu vwx yz ab cd efg h ijklmn");
+
+  TextLayout layout(GetFixedSizeMockShaper());
+  TTTextContext context;
+  auto region = std::make_unique<LayoutRegion>(7.f, 100.f);
+  layout.Layout(para.get(), region.get(), context);
+  context.Reset();
+  auto virtualized = std::make_unique<LayoutRegion>(7.f, 100.f);
+  virtualized->SetMaxMaterializedLines(3);
+  layout.Layout(para.get(), virtualized.get(), context);
+
+  ASSERT_GT(region->GetLineCount(), 6u);
+  ASSERT_EQ(virtualized->GetLineCount(), region->GetLineCount());
+  EXPECT_FLOAT_EQ(virtualized->GetLayoutedHeight(),
+                  region->GetLayoutedHeight());
+  auto expect_same_line = [](TextLine* virtualized_line, TextLine* line) {
+    ASSERT_NE(virtualized_line, nullptr);
+    EXPECT_EQ(virtualized_line->GetStartCharPos(), line->GetStartCharPos());
+    EXPECT_EQ(virtualized_line->GetEndCharPos(), line->GetEndCharPos());
+    EXPECT_FLOAT_EQ(virtualized_line->GetLineTop(), line->GetLineTop());
+    EXPECT_FLOAT_EQ(virtualized_line->GetLineHeight(), line->GetLineHeight());
+    EXPECT_FLOAT_EQ(virtualized_line->GetLineLeft(), line->GetLineLeft());
+    EXPECT_FLOAT_EQ(virtualized_line->GetLineRight(), line->GetLineRight());
+  };
+  // visit the lines twice so that released lines are laid out again
+  for (auto pass = 0; pass < 2; pass++) {
+    uint32_t visited = 0;
+    virtualized->VisitLines(0, virtualized->GetLineCount(),
+                            [&](uint32_t idx, TextLine* virtualized_line) {
+                              EXPECT_EQ(idx, visited++);
+                              expect_same_line(virtualized_line,
+                                               region->GetLine(idx));
+                              return true;
+                            });
+    EXPECT_EQ(visited, region->GetLineCount());
+  }
+  // lines returned by GetLine() stay valid while no more than
+  // GetMaxMaterializedLines() other lines are accessed
+  std::vector<TextLine*> lines;
+  for (auto k = 0u; k < 3; k++) {
+    lines.push_back(virtualized->GetLine(k));
+    expect_same_line(lines[k], region->GetLine(k));
+  }
+  for (auto k = 0u; k < 3; k++) {
+    EXPECT_EQ(virtualized->GetLine(k), lines[k]);
+  }
+  // a visited line is the one GetLine() returns during its visit, and stays
+  // alive whatever lines the visit accesses
+  virtualized->VisitLines(
+      0, virtualized->GetLineCount(),
+      [&](uint32_t idx, TextLine* virtualized_line) {
+        EXPECT_EQ(virtualized->GetLine(idx), virtualized_line);
+        for (auto k = 0u; k < virtualized->GetLineCount(); k++) {
+          virtualized->GetLine(k);
+        }
+        expect_same_line(virtualized_line, region->GetLine(idx));
+        return idx < 2;
+      });
+  for (auto k = 0u; k < region->GetLineCount(); k++) {
+    expect_same_line(virtualized->GetLine(k), region->GetLine(k));
+  }
+  auto* line = region->GetLine(4);
+  EXPECT_EQ(virtualized->FindLineIndexByY(line->GetLineTop()), 4u);
+  EXPECT_EQ(region->FindLineIndexByY(line->GetLineTop()), 4u);
+  EXPECT_EQ(virtualized->FindLineIndexByY(region->GetLayoutedHeight()),
+            region->GetLineCount());
+}
+
+TEST_F(TextLayoutTest, TallerRunKeepsLine) {
+  auto layout_helper = [this](float exclusion_top) {
+    auto para = std::make_unique<ParagraphImpl>();
+    Style style;
+    style.SetTextSize(1.f);
+    para->AddTextRun(&style, "ab ");
+    style.SetTextSize(4.f);
+    para->AddTextRun(&style, "CD");
+    style.SetTextSize(1.f);
+    para->AddTextRun(&style, " ef");
+
+    TTTextContext context;
+    TextLayout layout(GetFixedSizeMockShaper());
+    auto region = std::make_unique<LayoutRegion>(20.f, 20.f);
+    if (exclusion_top >= 0) {
+      region->AddExclusionRect(15.f, exclusion_top, 5.f, 1.f);
+    }
+    layout.Layout(para.get(), region.get(), context);
+    EXPECT_EQ(region->GetLineCount(), 1u);
+    EXPECT_FLOAT_EQ(region->GetLine(0)->GetLineHeight(), 4.f);
+    return std::make_pair(context.GetLineRelayoutCount(),
+                          context.GetRangeListQueryCount());
+  };
+
+  // nothing to flow around, the taller run does not query the ranges again
+  EXPECT_EQ(layout_helper(-1), std::make_pair(0u, 1u));
+  // the exclusion is below the grown line
+  EXPECT_EQ(layout_helper(10.f), std::make_pair(0u, 1u));
+  // the grown line crosses the exclusion and is laid out again
+  EXPECT_EQ(layout_helper(2.f), std::make_pair(1u, 3u));
+}
+
+TEST_F(TextLayoutTest, WrappedMixedDirectionLine) {
+  auto para = std::make_unique<ParagraphImpl>();
+  Style style;
+  style.SetTextSize(1.f);
+  ParagraphStyle para_style;
+  para_style.SetDefaultStyle(style);
+  para_style.SetWriteDirection(WriteDirection::kRTL);
+  para->SetParagraphStyle(&para_style);
+  // levels: A B _ 1, c d _ 2, E F 1
+  para->AddTextRun(nullptr, "AB cd EF");
+
+  TextLayout layout(GetFixedSizeMockShaper<PseudoBidiMockShaper>());
+  TTTextContext context;
+  auto region = std::make_unique<LayoutRegion>(6.f, 10.f);
+  layout.Layout(para.get(), region.get(), context);
+  ASSERT_EQ(region->GetLineCount(), 2u);
+  auto* line = region->GetLine(0);
+  EXPECT_EQ(line->GetStartCharPos(), 0u);
+  EXPECT_EQ(line->GetEndCharPos(), 6u);
+  EXPECT_EQ(region->GetLine(1)->GetStartCharPos(), 6u);
+
+  auto char_x = [line](uint32_t char_pos) {
+    float rect[4];
+    line->GetCharBoundingRect(rect, char_pos);
+    return rect[0];
+  };
+  // the space ending the line is reset to the paragraph level (L1) and goes
+  // to the visual end of the rtl line, then "cd" and "AB " are reversed (L2)
+  const auto line_left = char_x(5);
+  EXPECT_FLOAT_EQ(char_x(3) - line_left, 1.f);
+  EXPECT_FLOAT_EQ(char_x(4) - line_left, 2.f);
+  EXPECT_FLOAT_EQ(char_x(0) - line_left, 3.f);
+  EXPECT_FLOAT_EQ(char_x(2) - line_left, 5.f);
+}
+
 }  // namespace tttext
 }  // namespace ttoffice
@@ -174,6 +174,68 @@ TEST(ShapeResult, MeasureWidth) {
   }
 }
 
+TEST(ShapeResult, MeasureWidthWithSharedGlyph) {
+  // 5 chars, 3 glyphs: chars 1 and 2 form one cluster, char 4 is a mark
+  // without advance
+  class ClusterReader final : public PlatformShapingResultReader {
+   public:
+    uint32_t GlyphCount() const override { return 4; }
+    uint32_t TextCount() const override { return 5; }
+    GlyphID ReadGlyphID(uint32_t idx) const override { return idx + 1; }
+    float ReadAdvanceX(uint32_t idx) const override {
+      return std::array<float, 4>{5.f, 10.f, 15.f, 0.f}[idx];
+    }
+    uint32_t ReadIndices(uint32_t idx) const override {
+      return std::array<uint32_t, 4>{0, 1, 3, 4}[idx];
+    }
+    TypefaceRef ReadFontId(uint32_t idx) const override { return nullptr; }
+  };
+  ShapeResult result(5, false);
+  result.AppendPlatformShapingResult(ClusterReader());
+  ASSERT_EQ(result.CharCount(), 5u);
+  EXPECT_FLOAT_EQ(result.MeasureWidth(0, 5, 0.f), 30.f);
+  EXPECT_FLOAT_EQ(result.MeasureWidth(0, 5, 1.f), 33.f);
+  EXPECT_FLOAT_EQ(result.MeasureWidth(1, 2, 1.f), 11.f);
+  // a range starting inside a cluster still counts the shared glyph
+  EXPECT_FLOAT_EQ(result.MeasureWidth(2, 1, 1.f), 11.f);
+  EXPECT_FLOAT_EQ(result.MeasureWidth(2, 2, 1.f), 27.f);
+  EXPECT_FLOAT_EQ(result.MeasureWidth(4, 1, 1.f), 0.f);
+}
+
+TEST(ShapeResult, FitCharCount) {
+  TestShapingResultReader shaping_result(4);
+  shaping_result.glyphs_ = {1, 2, 3, 4};
+  shaping_result.advances_ = {
+      {5.f, 0.f}, {10.f, 0.f}, {15.f, 0.f}, {20.f, 0.f}};
+  ShapeResult result(4, false);
+  result.AppendPlatformShapingResult(shaping_result);
+
+  EXPECT_EQ(result.FitCharCount(0, 4, 0.f, 4.f), 0u);
+  EXPECT_EQ(result.FitCharCount(0, 4, 0.f, 5.f), 1u);
+  EXPECT_EQ(result.FitCharCount(0, 4, 0.f, 29.f), 2u);
+  EXPECT_EQ(result.FitCharCount(0, 4, 0.f, 30.f), 3u);
+  EXPECT_EQ(result.FitCharCount(0, 4, 0.f, 100.f), 4u);
+  EXPECT_EQ(result.FitCharCount(0, 2, 0.f, 100.f), 2u);
+  EXPECT_EQ(result.FitCharCount(1, 3, 0.f, 25.f), 2u);
+  EXPECT_EQ(result.FitCharCount(1, 3, 1.f, 25.f), 1u);
+}
+
+TEST(ShapeResult, FitCharCountNegativeSpacing) {
+  TestShapingResultReader shaping_result(5);
+  shaping_result.glyphs_ = {1, 2, 3, 4, 5};
+  shaping_result.advances_ = {
+      {2.f, 0.f}, {20.f, 0.f}, {2.f, 0.f}, {2.f, 0.f}, {2.f, 0.f}};
+  ShapeResult result(5, false);
+  result.AppendPlatformShapingResult(shaping_result);
+
+  // widths -3, 12, 9, 6, 3: the second char overflows, the longer ranges
+  // that fit again after it are not taken
+  EXPECT_EQ(result.FitCharCount(0, 5, -5.f, 10.f), 1u);
+  EXPECT_EQ(result.FitCharCount(0, 5, -5.f, 12.f), 5u);
+  EXPECT_EQ(result.FitCharCount(1, 4, -5.f, 14.f), 0u);
+  EXPECT_EQ(result.FitCharCount(1, 4, -5.f, 15.f), 4u);
+}
+
 TEST(TTShaper, Constructor) {
   FontmgrCollection expected = TestUtils::getFontmgrCollection();
   TestShaper shaper(expected);
@@ -0,0 +1,92 @@
+// Copyright 2025 The Lynx Authors. All rights reserved.
+// Licensed under the Apache License Version 2.0 that can be found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <textra/i_typeface_helper.h>
+
+#include <vector>
+
+#include "mocks.h"
+
+using namespace ttoffice::tttext;
+using namespace ::testing;
+
+TEST(TypefaceHelperTest, GlyphMetricsAreCached) {
+  NiceMock<MockTypefaceHelper> typeface;
+  ON_CALL(typeface, GetHorizontalAdvances(_, _, _, _))
+      .WillByDefault(Invoke([](GlyphID glyph_ids[], uint32_t count,
+                               float widths[], float font_size) {
+        for (auto k = 0u; k < count; k++) widths[k] = glyph_ids[k] * font_size;
+      }));
+  ON_CALL(typeface, GetWidthBound(_, _, _))
+      .WillByDefault(
+          Invoke([](float* rect_ltwh, GlyphID glyph_id, float font_size) {
+            rect_ltwh[0] = 0;
+            rect_ltwh[1] = -font_size;
+            rect_ltwh[2] = glyph_id;
+            rect_ltwh[3] = font_size;
+          }));
+
+  const GlyphID glyphs[] = {1, 2};
+  GlyphMetrics metrics[2];
+  // the missing glyphs are fetched in one batch
+  EXPECT_CALL(typeface, GetHorizontalAdvances(_, 2, _, 10.f)).Times(1);
+  EXPECT_CALL(typeface, GetWidthBound(_, _, 10.f)).Times(2);
+  typeface.GetGlyphMetrics(glyphs, 2, 10.f, metrics);
+  EXPECT_FLOAT_EQ(metrics[1].advance_, 20.f);
+  EXPECT_FLOAT_EQ(metrics[1].bounds_[1], -10.f);
+  EXPECT_FLOAT_EQ(metrics[1].bounds_[2], 2.f);
+  EXPECT_FLOAT_EQ(metrics[1].bounds_[3], 0.f);
+  Mock::VerifyAndClearExpectations(&typeface);
+
+  // cached glyphs are not fetched again, other sizes are cached apart
+  const GlyphID more_glyphs[] = {2, 3};
+  EXPECT_CALL(typeface, GetHorizontalAdvances(_, 1, _, 10.f)).Times(1);
+  EXPECT_CALL(typeface, GetWidthBound(_, 3, 10.f)).Times(1);
+  typeface.GetGlyphMetrics(more_glyphs, 2, 10.f, metrics);
+  EXPECT_FLOAT_EQ(metrics[0].advance_, 20.f);
+  EXPECT_FLOAT_EQ(metrics[1].advance_, 30.f);
+  EXPECT_CALL(typeface, GetHorizontalAdvances(_, 2, _, 12.f)).Times(1);
+  EXPECT_CALL(typeface, GetWidthBound(_, _, 12.f)).Times(2);
+  typeface.GetGlyphMetrics(more_glyphs, 2, 12.f, metrics);
+}
+
+TEST(TypefaceHelperTest, GlyphMetricsKeepRecentSizes) {
+  NiceMock<MockTypefaceHelper> typeface;
+  const GlyphID glyph = 1;
+  GlyphMetrics metrics;
+  // a font size animation
+  for (auto k = 0; k < 100; k++) {
+    typeface.GetGlyphMetrics(&glyph, 1, 10.f + k * 0.1f, &metrics);
+  }
+  // the latest sizes are kept, the first ones were dropped
+  EXPECT_CALL(typeface, GetHorizontalAdvances(_, _, _, _)).Times(0);
+  typeface.GetGlyphMetrics(&glyph, 1, 10.f + 99 * 0.1f, &metrics);
+  typeface.GetGlyphMetrics(&glyph, 1, 10.f + 95 * 0.1f, &metrics);
+  Mock::VerifyAndClearExpectations(&typeface);
+  EXPECT_CALL(typeface, GetHorizontalAdvances(_, 1, _, 10.f)).Times(1);
+  typeface.GetGlyphMetrics(&glyph, 1, 10.f, &metrics);
+}
+
+TEST(TypefaceHelperTest, FontInfoIsCreatedOncePerSize) {
+  NiceMock<MockTypefaceHelper> typeface;
+  ON_CALL(typeface, OnCreateFontInfo(_, _))
+      .WillByDefault(Invoke([](FontInfo* info, float font_size) {
+        *info = FontInfo(-0.75f * font_size, 0.25f * font_size, font_size);
+      }));
+  // more sizes than the lock-free table holds
+  constexpr auto kSizeCount = 100u;
+  EXPECT_CALL(typeface, OnCreateFontInfo(_, _)).Times(kSizeCount);
+  std::vector<const FontInfo*> infos;
+  for (auto k = 1u; k <= kSizeCount; k++) {
+    infos.push_back(&typeface.GetFontInfo(static_cast<float>(k)));
+  }
+  for (auto k = 1u; k <= kSizeCount; k++) {
+    const auto& info = typeface.GetFontInfo(static_cast<float>(k));
+    EXPECT_EQ(&info, infos[k - 1]);
+    EXPECT_FLOAT_EQ(info.GetFontSize(), static_cast<float>(k));
+    EXPECT_FLOAT_EQ(info.GetAscent(), -0.75f * k);
+  }
+}